@@ -0,0 +1,679 @@
+#pragma once
+
+#include "domain.hpp"
+#include <atomic>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <hazard_pointer.hpp>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace conc {
+
+// Adaptive radix tree (Leis et al.) synchronized with ROWEX: readers never lock or write
+// shared memory, writers lock only the nodes they modify. Keys are arbitrary byte strings,
+// composite keys should be encoded big-endian so that byte order matches key order.
+template<typename T>
+requires(std::is_copy_constructible_v<T> && std::is_nothrow_destructible_v<T>)
+class adaptive_radix_tree {
+   private:
+    enum class node_type : std::uint8_t { leaf, n4, n16, n48, n256 };
+
+    struct node {
+        explicit node(node_type t) noexcept : type(t) {}
+        virtual ~node() = default;
+
+        const node_type type;
+    };
+
+    struct leaf : node {
+        leaf(std::string_view k, T&& v) : node(node_type::leaf), key(k), value(std::move(v)) {}
+
+        const std::string key;
+        const T value;
+    };
+
+    // prefix is immutable, splitting it replaces the whole node (copy-on-write)
+    struct inner : node {
+        static constexpr std::uint32_t LOCKED = 1;
+        static constexpr std::uint32_t OBSOLETE = 2;
+
+        inner(node_type t, std::string_view p) : node(t), prefix(p) {}
+
+        const std::string prefix;
+        std::atomic<std::uint32_t> state = 0;
+        // leaf of the key that ends exactly at this node
+        std::atomic<node*> terminal = nullptr;
+    };
+
+    // Node4/Node16: slots are appended and never reordered, so a reader that observed
+    // `compact` sees fully written keys; erased slots keep their key and are reused for it
+    template<node_type type, std::size_t N>
+    struct linear_node : inner {
+        static constexpr std::size_t capacity = N;
+
+        explicit linear_node(std::string_view p) : inner(type, p) {}
+
+        std::atomic<node*>* find(std::uint8_t k) noexcept {
+            const std::uint32_t used = compact.load(std::memory_order_acquire);
+#if defined(__SSE2__)
+            if constexpr (N == 16) {
+                // a writer may append a key right behind `used`: copy the published ones out
+                // through atomic loads and compare the copy, never the shared bytes
+                alignas(16) std::array<std::uint8_t, N> copy{};
+                for(std::uint32_t i = 0; i < used; ++i) {
+                    copy[i] = keys[i].load(std::memory_order_relaxed);
+                }
+                auto cmp = _mm_cmpeq_epi8(
+                    _mm_set1_epi8(static_cast<char>(k)),
+                    _mm_load_si128(reinterpret_cast<const __m128i*>(copy.data()))
+                );
+                auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(cmp)) & ((1u << used) - 1);
+                return mask ? &children[std::countr_zero(mask)] : nullptr;
+            }
+#endif
+            for(std::uint32_t i = 0; i < used; ++i) {
+                if(keys[i].load(std::memory_order_relaxed) == k) {
+                    return &children[i];
+                }
+            }
+            return nullptr;
+        }
+
+        bool insert(std::uint8_t k, node* child) noexcept {
+            if(auto slot = find(k)) {
+                slot->store(child, std::memory_order_release);
+                return true;
+            }
+
+            auto used = compact.load(std::memory_order_relaxed);
+            if(used == N) {
+                return false;
+            }
+
+            keys[used].store(k, std::memory_order_relaxed);
+            children[used].store(child, std::memory_order_relaxed);
+            compact.store(used + 1, std::memory_order_release);
+            return true;
+        }
+
+        template<typename F>
+        void for_each(F&& f) const {
+            auto used = compact.load(std::memory_order_relaxed);
+            for(std::uint32_t i = 0; i < used; ++i) {
+                if(auto child = children[i].load(std::memory_order_relaxed)) {
+                    f(keys[i].load(std::memory_order_relaxed), child);
+                }
+            }
+        }
+
+        std::atomic<std::uint32_t> compact = 0;
+        std::array<std::atomic<std::uint8_t>, N> keys{};
+        std::array<std::atomic<node*>, N> children{};
+    };
+
+    using node4 = linear_node<node_type::n4, 4>;
+    using node16 = linear_node<node_type::n16, 16>;
+
+    struct node48 : inner {
+        static constexpr std::size_t capacity = 48;
+        static constexpr std::uint8_t EMPTY = 0xFF;
+
+        explicit node48(std::string_view p) : inner(node_type::n48, p) {
+            for(auto& i : index) {
+                i.store(EMPTY, std::memory_order_relaxed);
+            }
+        }
+
+        std::atomic<node*>* find(std::uint8_t k) noexcept {
+            auto i = index[k].load(std::memory_order_acquire);
+            return i == EMPTY ? nullptr : &children[i];
+        }
+
+        bool insert(std::uint8_t k, node* child) noexcept {
+            if(auto slot = find(k)) {
+                slot->store(child, std::memory_order_release);
+                return true;
+            }
+
+            if(used == capacity) {
+                return false;
+            }
+
+            children[used].store(child, std::memory_order_relaxed);
+            index[k].store(used++, std::memory_order_release);
+            return true;
+        }
+
+        template<typename F>
+        void for_each(F&& f) const {
+            for(std::size_t k = 0; k < 256; ++k) {
+                auto i = index[k].load(std::memory_order_relaxed);
+                if(i == EMPTY) {
+                    continue;
+                }
+
+                if(auto child = children[i].load(std::memory_order_relaxed)) {
+                    f(static_cast<std::uint8_t>(k), child);
+                }
+            }
+        }
+
+        std::array<std::atomic<std::uint8_t>, 256> index;
+        std::array<std::atomic<node*>, capacity> children{};
+        std::uint8_t used = 0;
+    };
+
+    struct node256 : inner {
+        static constexpr std::size_t capacity = 256;
+
+        explicit node256(std::string_view p) : inner(node_type::n256, p) {}
+
+        std::atomic<node*>* find(std::uint8_t k) noexcept {
+            return &children[k];
+        }
+
+        bool insert(std::uint8_t k, node* child) noexcept {
+            children[k].store(child, std::memory_order_release);
+            return true;
+        }
+
+        template<typename F>
+        void for_each(F&& f) const {
+            for(std::size_t k = 0; k < 256; ++k) {
+                if(auto child = children[k].load(std::memory_order_relaxed)) {
+                    f(static_cast<std::uint8_t>(k), child);
+                }
+            }
+        }
+
+        std::array<std::atomic<node*>, capacity> children{};
+    };
+
+   public:
+    // a find holds two cells, an insert or erase HAZARDS_PER_OPERATION, and every tree of one T
+    // draws from the same domain: at most MAX_CONCURRENT_OPERATIONS operations may run at once,
+    // more is undefined behaviour
+    static constexpr std::size_t HAZARDS_PER_OPERATION = 3;
+    static constexpr std::size_t MAX_CONCURRENT_OPERATIONS = 64;
+    using hazard_domain = conc::hazard_domain<node, HAZARDS_PER_OPERATION * MAX_CONCURRENT_OPERATIONS, adaptive_radix_tree<T>>;
+
+   private:
+    using hazard_pointer_t = hazard_pointer<node, hazard_domain>;
+
+   public:
+    adaptive_radix_tree() = default;
+    adaptive_radix_tree(adaptive_radix_tree const&) = delete;
+    adaptive_radix_tree(adaptive_radix_tree&& other) = delete;
+    adaptive_radix_tree& operator=(adaptive_radix_tree const&) = delete;
+    adaptive_radix_tree& operator=(adaptive_radix_tree &&) = delete;
+
+    //not thread-safe
+    ~adaptive_radix_tree() {
+        visit(m_root.get(), [](inner* n) {
+            destroy(n->terminal.load(std::memory_order_relaxed));
+            for_each_child(n, [](std::uint8_t, node* child) { destroy(child); });
+        });
+    }
+
+   public:
+    // returns false and leaves the tree untouched if the key is already present
+    bool insert(std::string_view key, T value) {
+        return emplace<false>(key, std::move(value));
+    }
+
+    // returns true if the key was inserted, false if an existing value was replaced
+    bool insert_or_assign(std::string_view key, T value) {
+        return emplace<true>(key, std::move(value));
+    }
+
+    std::optional<T> find(std::string_view key) const {
+        auto hp_node = hazard_pointer_t::make_hazard_pointer();
+        auto hp_child = hazard_pointer_t::make_hazard_pointer();
+
+    restart:
+        inner* n = m_root.get();
+        std::size_t depth = 0;
+
+        while(true) {
+            if(!key.substr(depth).starts_with(n->prefix)) {
+                return std::nullopt;
+            }
+            depth += n->prefix.size();
+
+            auto slot = depth == key.size() ? &n->terminal : find_child(n, key[depth]);
+            if(slot == nullptr) {
+                return std::nullopt;
+            }
+
+            node* child = hp_child.protect(*slot);
+            [[unlikely]]
+            if(is_obsolete(n)) {
+                goto restart;
+            }
+
+            if(child == nullptr) {
+                return std::nullopt;
+            }
+
+            if(child->type == node_type::leaf) {
+                auto l = static_cast<leaf*>(child);
+                if(l->key != key) {
+                    return std::nullopt;
+                }
+                return l->value;
+            }
+
+            n = static_cast<inner*>(child);
+            ++depth;
+            hp_node.swap(hp_child);
+        }
+    }
+
+    bool contains(std::string_view key) const {
+        return find(key).has_value();
+    }
+
+    bool erase(std::string_view key) {
+        auto hp_parent = hazard_pointer_t::make_hazard_pointer();
+        auto hp_node = hazard_pointer_t::make_hazard_pointer();
+        auto hp_child = hazard_pointer_t::make_hazard_pointer();
+
+    restart:
+        inner* parent = nullptr;
+        std::atomic<node*>* parent_slot = nullptr;
+        inner* n = m_root.get();
+        std::size_t depth = 0;
+
+        while(true) {
+            if(!key.substr(depth).starts_with(n->prefix)) {
+                return false;
+            }
+            depth += n->prefix.size();
+
+            auto slot = depth == key.size() ? &n->terminal : find_child(n, key[depth]);
+            if(slot == nullptr) {
+                return false;
+            }
+
+            node* child = hp_child.protect(*slot);
+            [[unlikely]]
+            if(is_obsolete(n)) {
+                goto restart;
+            }
+
+            if(child == nullptr) {
+                return false;
+            }
+
+            if(child->type == node_type::leaf) {
+                if(static_cast<leaf*>(child)->key != key) {
+                    return false;
+                }
+
+                if(!lock(n)) {
+                    goto restart;
+                }
+
+                if(slot->load(std::memory_order_relaxed) != child) {
+                    unlock(n);
+                    goto restart;
+                }
+
+                slot->store(nullptr, std::memory_order_release);
+                bool prune = parent != nullptr && is_empty(n);
+                unlock(n);
+                hazard_pointer_t::retire(child);
+
+                if(prune) {
+                    prune_empty(parent, parent_slot, n);
+                }
+                return true;
+            }
+
+            parent = n;
+            parent_slot = slot;
+            n = static_cast<inner*>(child);
+            ++depth;
+            hp_parent.swap(hp_node);
+            hp_node.swap(hp_child);
+        }
+    }
+
+   private:
+    template<bool assign>
+    bool emplace(std::string_view key, T&& value) {
+        auto hp_parent = hazard_pointer_t::make_hazard_pointer();
+        auto hp_node = hazard_pointer_t::make_hazard_pointer();
+        auto hp_child = hazard_pointer_t::make_hazard_pointer();
+
+        auto fresh = std::make_unique<leaf>(key, std::move(value));
+
+    restart:
+        inner* parent = nullptr;
+        std::atomic<node*>* parent_slot = nullptr;
+        inner* n = m_root.get();
+        std::size_t depth = 0;
+
+        while(true) {
+            const auto& prefix = n->prefix;
+            auto matched = common_prefix(prefix, key.substr(depth));
+
+            if(matched < prefix.size()) {
+                // key diverges inside the compressed path: new parent with the common part,
+                // n is replaced by a copy holding the remaining prefix
+                if(!lock(parent, n)) {
+                    goto restart;
+                }
+
+                if(parent_slot->load(std::memory_order_relaxed) != n) {
+                    unlock(parent, n);
+                    goto restart;
+                }
+
+                auto split = make_inner(2, prefix.substr(0, matched));
+                insert_child(split, prefix[matched], copy_node(n, prefix.substr(matched + 1), 0));
+                place(split, fresh.release(), depth + matched);
+
+                parent_slot->store(split, std::memory_order_release);
+                make_obsolete(n);
+                unlock(parent);
+                hazard_pointer_t::retire(n);
+                return true;
+            }
+            depth += prefix.size();
+
+            auto slot = depth == key.size() ? &n->terminal : find_child(n, key[depth]);
+            node* child = nullptr;
+            if(slot != nullptr) {
+                child = hp_child.protect(*slot);
+                [[unlikely]]
+                if(is_obsolete(n)) {
+                    goto restart;
+                }
+            }
+
+            if(child == nullptr) {
+                if(!lock(n)) {
+                    goto restart;
+                }
+
+                if(depth == key.size()) {
+                    if(n->terminal.load(std::memory_order_relaxed) != nullptr) {
+                        unlock(n);
+                        goto restart;
+                    }
+
+                    n->terminal.store(fresh.release(), std::memory_order_release);
+                    unlock(n);
+                    return true;
+                }
+
+                if(auto current = find_child(n, key[depth]); current && current->load(std::memory_order_relaxed)) {
+                    unlock(n);
+                    goto restart;
+                }
+
+                if(insert_child(n, key[depth], fresh.get())) {
+                    fresh.release();
+                    unlock(n);
+                    return true;
+                }
+
+                // n is full, replace it with a larger (or compacted) copy; locks are taken top-down
+                unlock(n);
+                if(!lock(parent, n)) {
+                    goto restart;
+                }
+
+                auto current = find_child(n, key[depth]);
+                if(parent_slot->load(std::memory_order_relaxed) != n ||
+                   (current && current->load(std::memory_order_relaxed))) {
+                    unlock(parent, n);
+                    goto restart;
+                }
+
+                auto grown = copy_node(n, n->prefix, 1);
+                insert_child(grown, key[depth], fresh.release());
+
+                parent_slot->store(grown, std::memory_order_release);
+                make_obsolete(n);
+                unlock(parent);
+                hazard_pointer_t::retire(n);
+                return true;
+            }
+
+            if(child->type == node_type::leaf) {
+                auto existing = static_cast<leaf*>(child);
+
+                if(existing->key == key) {
+                    if constexpr (!assign) {
+                        return false;
+                    }
+
+                    if(!lock(n)) {
+                        goto restart;
+                    }
+
+                    if(slot->load(std::memory_order_relaxed) != existing) {
+                        unlock(n);
+                        goto restart;
+                    }
+
+                    slot->store(fresh.release(), std::memory_order_release);
+                    unlock(n);
+                    hazard_pointer_t::retire(existing);
+                    return false;
+                }
+
+                // two keys share this slot: push both leaves one level down under the common part
+                auto tail = std::string_view(existing->key).substr(depth + 1);
+                auto matched_tail = common_prefix(tail, key.substr(depth + 1));
+                auto split = make_inner(2, tail.substr(0, matched_tail));
+                place(split, existing, depth + 1 + matched_tail);
+                place(split, fresh.get(), depth + 1 + matched_tail);
+
+                if(!lock(n)) {
+                    delete split;
+                    goto restart;
+                }
+
+                if(slot->load(std::memory_order_relaxed) != existing) {
+                    unlock(n);
+                    delete split;
+                    goto restart;
+                }
+
+                fresh.release();
+                slot->store(split, std::memory_order_release);
+                unlock(n);
+                return true;
+            }
+
+            parent = n;
+            parent_slot = slot;
+            n = static_cast<inner*>(child);
+            ++depth;
+            hp_parent.swap(hp_node);
+            hp_node.swap(hp_child);
+        }
+    }
+
+    // unlinks an inner node that became empty after an erase
+    void prune_empty(inner* parent, std::atomic<node*>* parent_slot, inner* n) {
+        if(!lock(parent, n)) {
+            return;
+        }
+
+        if(parent_slot->load(std::memory_order_relaxed) != n || !is_empty(n)) {
+            unlock(parent, n);
+            return;
+        }
+
+        parent_slot->store(nullptr, std::memory_order_release);
+        make_obsolete(n);
+        unlock(parent);
+        hazard_pointer_t::retire(n);
+    }
+
+    // links leaf l into split (a fresh, unpublished node) for a key consumed up to depth
+    static void place(inner* split, leaf* l, std::size_t depth) noexcept {
+        if(depth == l->key.size()) {
+            split->terminal.store(l, std::memory_order_relaxed);
+        } else {
+            insert_child(split, l->key[depth], l);
+        }
+    }
+
+    static std::size_t common_prefix(std::string_view a, std::string_view b) noexcept {
+        std::size_t i = 0;
+        auto limit = std::min(a.size(), b.size());
+        while(i < limit && a[i] == b[i]) {
+            ++i;
+        }
+        return i;
+    }
+
+    static inner* make_inner(std::size_t children, std::string_view prefix) {
+        if(children <= node4::capacity) {
+            return new node4(prefix);
+        }
+        if(children <= node16::capacity) {
+            return new node16(prefix);
+        }
+        if(children <= node48::capacity) {
+            return new node48(prefix);
+        }
+        return new node256(prefix);
+    }
+
+    // smallest node fitting the live children of src plus `extra`, children are shared, not cloned
+    static inner* copy_node(inner* src, std::string_view prefix, std::size_t extra) {
+        std::size_t live = 0;
+        for_each_child(src, [&live](std::uint8_t, node*) { ++live; });
+
+        auto dst = make_inner(live + extra, prefix);
+        for_each_child(src, [dst](std::uint8_t k, node* child) { insert_child(dst, k, child); });
+        dst->terminal.store(src->terminal.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return dst;
+    }
+
+    static std::atomic<node*>* find_child(inner* n, char k) noexcept {
+        auto byte = static_cast<std::uint8_t>(k);
+        switch(n->type) {
+            case node_type::n4:   return static_cast<node4*>(n)->find(byte);
+            case node_type::n16:  return static_cast<node16*>(n)->find(byte);
+            case node_type::n48:  return static_cast<node48*>(n)->find(byte);
+            case node_type::n256: return static_cast<node256*>(n)->find(byte);
+            default: std::unreachable();
+        }
+    }
+
+    static bool insert_child(inner* n, char k, node* child) noexcept {
+        auto byte = static_cast<std::uint8_t>(k);
+        switch(n->type) {
+            case node_type::n4:   return static_cast<node4*>(n)->insert(byte, child);
+            case node_type::n16:  return static_cast<node16*>(n)->insert(byte, child);
+            case node_type::n48:  return static_cast<node48*>(n)->insert(byte, child);
+            case node_type::n256: return static_cast<node256*>(n)->insert(byte, child);
+            default: std::unreachable();
+        }
+    }
+
+    template<typename F>
+    static void for_each_child(inner* n, F&& f) {
+        switch(n->type) {
+            case node_type::n4:   static_cast<node4*>(n)->for_each(f); break;
+            case node_type::n16:  static_cast<node16*>(n)->for_each(f); break;
+            case node_type::n48:  static_cast<node48*>(n)->for_each(f); break;
+            case node_type::n256: static_cast<node256*>(n)->for_each(f); break;
+            default: std::unreachable();
+        }
+    }
+
+    static bool is_empty(inner* n) {
+        bool empty = n->terminal.load(std::memory_order_relaxed) == nullptr;
+        for_each_child(n, [&empty](std::uint8_t, node*) { empty = false; });
+        return empty;
+    }
+
+    // post-order walk over inner nodes, used for teardown
+    template<typename F>
+    static void visit(inner* n, F&& f) {
+        for_each_child(n, [&f](std::uint8_t, node* child) {
+            if(child->type != node_type::leaf) {
+                visit(static_cast<inner*>(child), f);
+            }
+        });
+        f(n);
+    }
+
+    static void destroy(node* n) noexcept {
+        delete n;
+    }
+
+    // readers re-check after protecting a child: slots of an obsolete node stop being
+    // maintained, so the child could have been retired before the protection was published
+    static bool is_obsolete(inner* n) noexcept {
+        return n->state.load(std::memory_order_seq_cst) & inner::OBSOLETE;
+    }
+
+    static bool lock(inner* n) noexcept {
+        auto state = n->state.load(std::memory_order_relaxed);
+        while(true) {
+            if(state & inner::OBSOLETE) {
+                return false;
+            }
+
+            if(state & inner::LOCKED) {
+                state = n->state.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if(n->state.compare_exchange_weak(state, state | inner::LOCKED, std::memory_order_acquire)) {
+                return true;
+            }
+        }
+    }
+
+    static bool lock(inner* parent, inner* n) noexcept {
+        if(!lock(parent)) {
+            return false;
+        }
+
+        if(!lock(n)) {
+            unlock(parent);
+            return false;
+        }
+
+        return true;
+    }
+
+    static void unlock(inner* n) noexcept {
+        n->state.fetch_and(~inner::LOCKED, std::memory_order_release);
+    }
+
+    static void unlock(inner* parent, inner* n) noexcept {
+        unlock(n);
+        unlock(parent);
+    }
+
+    // replaces the lock, the node is never unlocked again
+    static void make_obsolete(inner* n) noexcept {
+        n->state.store(inner::OBSOLETE, std::memory_order_seq_cst);
+    }
+
+   private:
+    // the root is never replaced: Node256 does not grow and its prefix is empty
+    std::unique_ptr<node256> m_root = std::make_unique<node256>(std::string_view{});
+};
+
+}
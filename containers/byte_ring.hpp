@@ -0,0 +1,333 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <span>
+#include <spin.hpp>
+#include <string_view>
+#include <utility>
+
+#if __has_include(<sys/uio.h>)
+#include <cerrno>
+#include <sys/uio.h>
+#endif
+
+namespace conc {
+
+// Multi-producer single-consumer ring of variable-length byte records, the layout of Aeron's
+// log buffers and Agrona's many-to-one ring: a producer reserves a record with one fetch_add on
+// the tail, writes it in place and commits it by storing its header word, which the consumer
+// reads as the committed flag. Records never wrap, a reservation that would cross the end is
+// turned into padding and retried. The consumer hands out runs of committed records in batches
+// and zeroes what it consumed before releasing it, so a header of a later lap reads as
+// uncommitted until its producer stores it. Producers wait for space when the ring is full.
+class byte_ring {
+   private:
+    static constexpr std::size_t ALIGNMENT = 8;
+    static constexpr std::size_t HEADER = 8;
+    // in the header word next to the record size, nothing to hand out
+    static constexpr std::uint32_t PADDING = 1u << 31;
+
+    // record layout: [size | flags : 4][payload length : 4][payload][padding to ALIGNMENT]
+    static constexpr std::size_t record_size(std::size_t length) noexcept {
+        return (HEADER + length + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    // records handed to one writev
+    static constexpr std::size_t DRAIN_BATCH = 256;
+
+   public:
+    // a reserved record, committed by commit() and turned into padding when dropped without it
+    class reservation {
+       public:
+        reservation() noexcept = default;
+        reservation(reservation const&) = delete;
+        reservation(reservation&& other) noexcept
+            : m_ring(std::exchange(other.m_ring, nullptr)), m_offset(other.m_offset), m_length(other.m_length) {}
+        reservation& operator=(reservation const&) = delete;
+        reservation& operator=(reservation&& other) noexcept {
+            if(this != &other) {
+                reset();
+                m_ring = std::exchange(other.m_ring, nullptr);
+                m_offset = other.m_offset;
+                m_length = other.m_length;
+            }
+            return *this;
+        }
+
+        ~reservation() {
+            reset();
+        }
+
+       public:
+        [[nodiscard]]
+        explicit operator bool() const noexcept {
+            return m_ring != nullptr;
+        }
+
+        [[nodiscard]]
+        std::span<std::byte> data() const noexcept {
+            return {m_ring->m_buffer.get() + m_offset + HEADER, m_length};
+        }
+
+        void commit() noexcept {
+            std::exchange(m_ring, nullptr)->publish(m_offset, m_length, 0);
+        }
+
+       private:
+        friend class byte_ring;
+        reservation(byte_ring* ring, std::size_t offset, std::size_t length) noexcept
+            : m_ring(ring), m_offset(offset), m_length(length) {}
+
+        void reset() noexcept {
+            if(m_ring != nullptr) {
+                std::exchange(m_ring, nullptr)->publish(m_offset, m_length, PADDING);
+            }
+        }
+
+       private:
+        byte_ring* m_ring = nullptr;
+        std::size_t m_offset = 0;
+        std::size_t m_length = 0;
+    };
+
+   public:
+    // capacity in bytes, rounded up to a power of two
+    explicit byte_ring(std::size_t capacity)
+        : m_mask(std::bit_ceil(std::max<std::size_t>(capacity, 64)) - 1),
+          m_buffer(new(std::align_val_t(std::hardware_destructive_interference_size)) std::byte[m_mask + 1]()) {}
+
+    byte_ring(byte_ring const&) = delete;
+    byte_ring(byte_ring&& other) = delete;
+    byte_ring& operator=(byte_ring const&) = delete;
+    byte_ring& operator=(byte_ring &&) = delete;
+
+   public:
+    [[nodiscard]]
+    std::size_t capacity() const noexcept {
+        return m_mask + 1;
+    }
+
+    // longest payload a record can carry, half the ring less the header so that a reservation
+    // turned into padding at the end always leaves room for the retry
+    [[nodiscard]]
+    std::size_t max_length() const noexcept {
+        return capacity() / 2 - HEADER;
+    }
+
+    // any thread: one fetch_add, then waits while the ring is full; empty when length exceeds
+    // max_length()
+    [[nodiscard]]
+    reservation reserve(std::size_t length) noexcept {
+        if(length > max_length()) [[unlikely]] {
+            return {};
+        }
+        const std::size_t size = record_size(length);
+        while(true) {
+            const std::uint64_t position = m_tail.fetch_add(size, std::memory_order_relaxed);
+            wait_for_space(position + size);
+            const std::size_t offset = position & m_mask;
+            if(offset + size <= capacity()) [[likely]] {
+                return reservation(this, offset, length);
+            }
+            // crosses the end: pad out both halves, the consumer skips them
+            const std::size_t first = capacity() - offset;
+            publish(offset, first - HEADER, PADDING);
+            publish(0, size - first - HEADER, PADDING);
+        }
+    }
+
+    // any thread: like reserve but fails instead of waiting when the ring is full
+    [[nodiscard]]
+    reservation try_reserve(std::size_t length) noexcept {
+        if(length > max_length()) [[unlikely]] {
+            return {};
+        }
+        const std::size_t size = record_size(length);
+        std::uint64_t position = m_tail.load(std::memory_order_relaxed);
+        while(true) {
+            const std::size_t offset = position & m_mask;
+            // a record that would cross the end takes the rest of the lap as padding along
+            const std::size_t needed = offset + size <= capacity() ? size : capacity() - offset + size;
+            if(position + needed - m_head.load(std::memory_order_acquire) > capacity()) {
+                return {};
+            }
+            if(m_tail.compare_exchange_weak(position, position + needed, std::memory_order_relaxed)) {
+                if(needed == size) {
+                    return reservation(this, offset, length);
+                }
+                publish(offset, capacity() - offset - HEADER, PADDING);
+                return reservation(this, 0, length);
+            }
+        }
+    }
+
+    // any thread: reserve, copy, commit
+    bool write(std::span<const std::byte> bytes) noexcept {
+        reservation r = reserve(bytes.size());
+        if(!r) {
+            return false;
+        }
+        if(!bytes.empty()) {
+            std::memcpy(r.data().data(), bytes.data(), bytes.size());
+        }
+        r.commit();
+        return true;
+    }
+
+    bool write(std::string_view text) noexcept {
+        return write(std::as_bytes(std::span(text.data(), text.size())));
+    }
+
+    // consumer only: hands the payloads of up to max_records committed records, in reservation
+    // order, to f(std::span<const std::byte>), then releases their space; returns how many
+    template<typename F>
+    std::size_t consume(F&& f, std::size_t max_records = SIZE_MAX) {
+        std::size_t records = 0;
+        const std::size_t bytes = scan(max_records, [&](std::span<const std::byte> payload) {
+            f(payload);
+            ++records;
+        });
+        release(bytes);
+        return records;
+    }
+
+#if __has_include(<sys/uio.h>)
+    // consumer only: writes the committed records back to back to fd with writev, in batches,
+    // until none is left; returns the bytes written, or -1 with errno set, in which case the
+    // batch that failed is dropped
+    std::ptrdiff_t drain_to(int fd) noexcept {
+        std::ptrdiff_t total = 0;
+        while(true) {
+            std::size_t count = 0;
+            const std::size_t bytes = scan(DRAIN_BATCH, [&](std::span<const std::byte> payload) {
+                if(!payload.empty()) {
+                    m_iov[count++] = {const_cast<std::byte*>(payload.data()), payload.size()};
+                }
+            });
+            if(bytes == 0) {
+                return total;
+            }
+            const std::ptrdiff_t written = write_all(fd, count);
+            release(bytes);
+            if(written < 0) {
+                return -1;
+            }
+            total += written;
+        }
+    }
+#endif
+
+   private:
+    void wait_for_space(std::uint64_t end) const noexcept {
+        spin_wait wait;
+        while(end - m_head.load(std::memory_order_acquire) > capacity()) {
+            wait();
+        }
+    }
+
+    std::atomic_ref<std::uint32_t> header(std::size_t offset) const noexcept {
+        return std::atomic_ref<std::uint32_t>(*reinterpret_cast<std::uint32_t*>(m_buffer.get() + offset));
+    }
+
+    void publish(std::size_t offset, std::size_t length, std::uint32_t flags) noexcept {
+        const auto l = static_cast<std::uint32_t>(length);
+        std::memcpy(m_buffer.get() + offset + 4, &l, sizeof(l));
+        header(offset).store(static_cast<std::uint32_t>(record_size(length)) | flags, std::memory_order_release);
+    }
+
+    // walks committed records from the head without releasing them, returns their total size
+    template<typename F>
+    std::size_t scan(std::size_t max_records, F&& each) {
+        const std::uint64_t head = m_head.load(std::memory_order_relaxed);
+        std::uint64_t position = head;
+        std::size_t records = 0;
+        // a full ring of committed records would otherwise lead the walk back to its start
+        while(records < max_records && position - head < capacity()) {
+            const std::size_t offset = position & m_mask;
+            const std::uint32_t word = header(offset).load(std::memory_order_acquire);
+            if(word == 0) {
+                break;
+            }
+            if((word & PADDING) == 0) {
+                std::uint32_t length;
+                std::memcpy(&length, m_buffer.get() + offset + 4, sizeof(length));
+                each(std::span<const std::byte>(m_buffer.get() + offset + HEADER, length));
+                ++records;
+            }
+            position += word & ~PADDING;
+        }
+        return static_cast<std::size_t>(position - head);
+    }
+
+    // zeroes consumed records so their bytes read as uncommitted in the next lap, then frees them
+    void release(std::size_t bytes) noexcept {
+        if(bytes == 0) {
+            return;
+        }
+        const std::uint64_t head = m_head.load(std::memory_order_relaxed);
+        const std::size_t offset = head & m_mask;
+        const std::size_t first = std::min(bytes, capacity() - offset);
+        std::memset(m_buffer.get() + offset, 0, first);
+        std::memset(m_buffer.get(), 0, bytes - first);
+        m_head.store(head + bytes, std::memory_order_release);
+    }
+
+#if __has_include(<sys/uio.h>)
+    std::ptrdiff_t write_all(int fd, std::size_t count) noexcept {
+        std::ptrdiff_t total = 0;
+        iovec* iov = m_iov.data();
+        while(count != 0) {
+            const ssize_t n = ::writev(fd, iov, static_cast<int>(count));
+            if(n < 0) {
+                if(errno == EINTR) {
+                    continue;
+                }
+                return -1;
+            }
+            total += n;
+            // skip what was written, a partially written record continues where it stopped
+            auto left = static_cast<std::size_t>(n);
+            while(count != 0 && left >= iov->iov_len) {
+                left -= iov->iov_len;
+                ++iov;
+                --count;
+            }
+            if(count != 0) {
+                iov->iov_base = static_cast<std::byte*>(iov->iov_base) + left;
+                iov->iov_len -= left;
+            }
+        }
+        return total;
+    }
+#endif
+
+   private:
+    struct aligned_delete {
+        void operator()(std::byte* p) const noexcept {
+            ::operator delete[](p, std::align_val_t(std::hardware_destructive_interference_size));
+        }
+    };
+
+    const std::size_t m_mask;
+    const std::unique_ptr<std::byte[], aligned_delete> m_buffer;
+
+    alignas(std::hardware_destructive_interference_size)
+    std::atomic<std::uint64_t> m_tail = 0;
+
+    // consumer side
+    alignas(std::hardware_destructive_interference_size)
+    std::atomic<std::uint64_t> m_head = 0;
+#if __has_include(<sys/uio.h>)
+    std::array<iovec, DRAIN_BATCH> m_iov{};
+#endif
+};
+
+}
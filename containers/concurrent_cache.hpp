@@ -0,0 +1,392 @@
+#pragma once
+
+#include "domain.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <hazard_pointer.hpp>
+#include <sharded_counter.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace conc {
+
+// Sharded cache with SIEVE eviction (Zhang et al.): a hit only sets the entry's visited bit,
+// lookups are lock-free over an open-addressing table of immutable entries, writers take the
+// shard mutex, keep the FIFO queue and evict by sweeping a hand over it. Capacity is accounted
+// in caller-provided charges (bytes by default), split evenly between shards.
+template<typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+requires(std::is_copy_constructible_v<V> &&
+         std::is_nothrow_destructible_v<K> && std::is_nothrow_destructible_v<V>)
+class concurrent_cache {
+   private:
+    struct entry {
+        entry(std::size_t h, K&& k, V&& v, std::size_t c) :
+            hash(h), key(std::move(k)), value(std::move(v)), charge(c) {}
+
+        const std::size_t hash;
+        const K key;
+        const V value;
+        const std::size_t charge;
+        std::atomic<bool> visited = false;
+
+        // FIFO queue links, guarded by the shard mutex
+        entry* prev = nullptr;
+        entry* next = nullptr;
+    };
+
+    struct table {
+        explicit table(std::size_t capacity) :
+            slots(std::make_unique<std::atomic<entry*>[]>(capacity)), mask(capacity - 1) {}
+
+        std::unique_ptr<std::atomic<entry*>[]> slots;
+        const std::size_t mask;
+        // live entries plus tombstones, guarded by the shard mutex
+        std::size_t used = 0;
+    };
+
+   public:
+    using entry_domain = conc::hazard_domain<entry, 128, concurrent_cache<K, V, Hash, KeyEqual>>;
+    using table_domain = conc::hazard_domain<table, 128, concurrent_cache<K, V, Hash, KeyEqual>>;
+
+    struct statistics {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t evictions = 0;
+    };
+
+   private:
+    using entry_hazard_pointer = hazard_pointer<entry, entry_domain>;
+    using table_hazard_pointer = hazard_pointer<table, table_domain>;
+
+    static constexpr std::size_t MIN_TABLE = 16;
+
+    struct alignas(std::hardware_destructive_interference_size) shard {
+        std::atomic<table*> table_ptr = nullptr;
+        std::mutex writer;
+        entry* head = nullptr;
+        entry* tail = nullptr;
+        entry* hand = nullptr;
+        std::size_t charge = 0;
+        std::size_t count = 0;
+        std::uint64_t evictions = 0;
+    };
+
+   public:
+    // fewer shards than asked for when capacity could not give each one at least a unit
+    explicit concurrent_cache(std::size_t capacity, std::size_t shards = 16) :
+        m_shard_count(std::min(std::bit_ceil(std::max<std::size_t>(shards, 1)), std::bit_floor(std::max<std::size_t>(capacity, 1)))),
+        m_shard_capacity(capacity / m_shard_count),
+        m_shards(std::make_unique<shard[]>(m_shard_count)) {
+        for(std::size_t i = 0; i < m_shard_count; ++i) {
+            m_shards[i].table_ptr.store(new table(MIN_TABLE), std::memory_order_relaxed);
+        }
+    }
+
+    concurrent_cache(concurrent_cache const&) = delete;
+    concurrent_cache(concurrent_cache&& other) = delete;
+    concurrent_cache& operator=(concurrent_cache const&) = delete;
+    concurrent_cache& operator=(concurrent_cache &&) = delete;
+
+    //not thread-safe
+    ~concurrent_cache() {
+        for(std::size_t i = 0; i < m_shard_count; ++i) {
+            auto& s = m_shards[i];
+            for(entry* e = s.head; e != nullptr;) {
+                delete std::exchange(e, e->next);
+            }
+            delete s.table_ptr.load(std::memory_order_relaxed);
+        }
+        entry_domain().delete_hazards();
+        table_domain().delete_hazards();
+    }
+
+   public:
+    std::optional<V> find(const K& key) {
+        const std::size_t h = hash(key);
+        auto& s = shard_for(h);
+
+        auto thp = table_hazard_pointer::make_hazard_pointer();
+        auto ehp = entry_hazard_pointer::make_hazard_pointer();
+
+        while(true) {
+            table* t = thp.protect(s.table_ptr);
+            entry* e = nullptr;
+            bool stale = false;
+
+            for(std::size_t i = h & t->mask, probes = 0; probes <= t->mask; i = (i + 1) & t->mask, ++probes) {
+                e = ehp.protect(t->slots[i]);
+                // a replaced table is no longer updated and may still point to retired entries,
+                // seq_cst pairs with the publication in rebuild
+                [[unlikely]]
+                if(s.table_ptr.load() != t) {
+                    stale = true;
+                    break;
+                }
+                if(e == nullptr) {
+                    break;
+                }
+                if(e != tombstone() && e->hash == h && m_equal(e->key, key)) {
+                    break;
+                }
+                e = nullptr;
+            }
+
+            [[unlikely]]
+            if(stale) {
+                continue;
+            }
+
+            if(e == nullptr) {
+                m_misses.increment();
+                return std::nullopt;
+            }
+
+            // read before write, a hot entry keeps its cache line shared
+            if(!e->visited.load(std::memory_order_relaxed)) {
+                e->visited.store(true, std::memory_order_relaxed);
+            }
+            m_hits.increment();
+            return e->value;
+        }
+    }
+
+    bool contains(const K& key) {
+        return find(key).has_value();
+    }
+
+    // returns false when the charge does not fit into a shard, the cache is left unchanged then
+    bool insert_or_assign(K key, V value, std::size_t charge = sizeof(K) + sizeof(V)) {
+        if(charge > m_shard_capacity) {
+            return false;
+        }
+
+        const std::size_t h = hash(key);
+        auto& s = shard_for(h);
+        std::lock_guard lock(s.writer);
+
+        table* t = s.table_ptr.load(std::memory_order_relaxed);
+        const std::size_t slot = locate(t, h, key);
+        entry* old = slot != npos ? t->slots[slot].load(std::memory_order_relaxed) : nullptr;
+
+        if(old != nullptr) {
+            unlink(s, old);
+            retire_slot(t, slot);
+            retire_entry(old);
+        }
+
+        while(s.charge + charge > m_shard_capacity) {
+            evict(s);
+        }
+
+        auto fresh = new entry(h, std::move(key), std::move(value), charge);
+        // an overwritten entry keeps its recency
+        fresh->visited.store(old != nullptr, std::memory_order_relaxed);
+        link(s, fresh);
+        place(s, fresh);
+        return true;
+    }
+
+    bool erase(const K& key) {
+        const std::size_t h = hash(key);
+        auto& s = shard_for(h);
+        std::lock_guard lock(s.writer);
+
+        table* t = s.table_ptr.load(std::memory_order_relaxed);
+        const std::size_t slot = locate(t, h, key);
+        if(slot == npos) {
+            return false;
+        }
+
+        entry* e = t->slots[slot].load(std::memory_order_relaxed);
+        unlink(s, e);
+        retire_slot(t, slot);
+        retire_entry(e);
+        return true;
+    }
+
+    void clear() {
+        for(std::size_t i = 0; i < m_shard_count; ++i) {
+            auto& s = m_shards[i];
+            std::lock_guard lock(s.writer);
+            while(s.head != nullptr) {
+                entry* e = s.head;
+                table* t = s.table_ptr.load(std::memory_order_relaxed);
+                retire_slot(t, locate(t, e->hash, e->key));
+                unlink(s, e);
+                retire_entry(e);
+            }
+        }
+    }
+
+    std::size_t size() {
+        std::size_t total = 0;
+        for(std::size_t i = 0; i < m_shard_count; ++i) {
+            std::lock_guard lock(m_shards[i].writer);
+            total += m_shards[i].count;
+        }
+        return total;
+    }
+
+    std::size_t charge() {
+        std::size_t total = 0;
+        for(std::size_t i = 0; i < m_shard_count; ++i) {
+            std::lock_guard lock(m_shards[i].writer);
+            total += m_shards[i].charge;
+        }
+        return total;
+    }
+
+    std::size_t capacity() const noexcept {
+        return m_shard_capacity * m_shard_count;
+    }
+
+    statistics stats() {
+        statistics result;
+        result.hits = static_cast<std::uint64_t>(m_hits.load());
+        result.misses = static_cast<std::uint64_t>(m_misses.load());
+        for(std::size_t i = 0; i < m_shard_count; ++i) {
+            std::lock_guard lock(m_shards[i].writer);
+            result.evictions += m_shards[i].evictions;
+        }
+        return result;
+    }
+
+   private:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    static entry* tombstone() noexcept {
+        return reinterpret_cast<entry*>(&s_tombstone_storage);
+    }
+
+    static void retire_entry(entry* e) {
+        entry_hazard_pointer::retire(e);
+    }
+
+    std::size_t hash(const K& key) const {
+        // std::hash is the identity for integers, spread it before taking shard and slot bits
+        return static_cast<std::size_t>(m_hash(key)) * 0x9E3779B97F4A7C15ull;
+    }
+
+    shard& shard_for(std::size_t h) noexcept {
+        return m_shards[(h >> 48) & (m_shard_count - 1)];
+    }
+
+    // writer side, entries of the current table cannot be retired while the mutex is held
+    std::size_t locate(table* t, std::size_t h, const K& key) const {
+        for(std::size_t i = h & t->mask, probes = 0; probes <= t->mask; i = (i + 1) & t->mask, ++probes) {
+            entry* e = t->slots[i].load(std::memory_order_relaxed);
+            if(e == nullptr) {
+                return npos;
+            }
+            if(e != tombstone() && e->hash == h && m_equal(e->key, key)) {
+                return i;
+            }
+        }
+        return npos;
+    }
+
+    static void retire_slot(table* t, std::size_t slot) noexcept {
+        // seq_cst: the unlink must not be reordered after the hazard scan of a later retire
+        t->slots[slot].store(tombstone(), std::memory_order_seq_cst);
+    }
+
+    void place(shard& s, entry* e) {
+        table* t = s.table_ptr.load(std::memory_order_relaxed);
+
+        // keep at least half of the slots empty so that probe sequences stay short and terminate,
+        // the rebuilt table already holds the freshly linked entry
+        if((t->used + 1) * 2 > t->mask + 1) {
+            rebuild(s, t);
+            return;
+        }
+
+        for(std::size_t i = e->hash & t->mask;; i = (i + 1) & t->mask) {
+            if(t->slots[i].load(std::memory_order_relaxed) == nullptr) {
+                t->slots[i].store(e, std::memory_order_release);
+                ++t->used;
+                return;
+            }
+        }
+    }
+
+    void rebuild(shard& s, table* old) {
+        const std::size_t capacity = std::max(MIN_TABLE, std::bit_ceil((s.count + 1) * 4));
+        auto fresh = new table(capacity);
+
+        for(entry* e = s.head; e != nullptr; e = e->next) {
+            for(std::size_t i = e->hash & fresh->mask;; i = (i + 1) & fresh->mask) {
+                if(fresh->slots[i].load(std::memory_order_relaxed) == nullptr) {
+                    fresh->slots[i].store(e, std::memory_order_relaxed);
+                    break;
+                }
+            }
+        }
+        fresh->used = s.count;
+
+        // seq_cst: a reader that still sees the old table after protecting an entry published
+        // its hazard before any later retirement scans for it
+        s.table_ptr.store(fresh, std::memory_order_seq_cst);
+        table_hazard_pointer::retire(old);
+    }
+
+    // new entries go to the head, the hand sweeps from the tail towards it
+    static void link(shard& s, entry* e) noexcept {
+        e->next = s.head;
+        if(s.head != nullptr) {
+            s.head->prev = e;
+        }
+        s.head = e;
+        if(s.tail == nullptr) {
+            s.tail = e;
+        }
+        s.charge += e->charge;
+        ++s.count;
+    }
+
+    static void unlink(shard& s, entry* e) noexcept {
+        if(s.hand == e) {
+            s.hand = e->prev;
+        }
+        (e->prev != nullptr ? e->prev->next : s.head) = e->next;
+        (e->next != nullptr ? e->next->prev : s.tail) = e->prev;
+        s.charge -= e->charge;
+        --s.count;
+    }
+
+    void evict(shard& s) {
+        entry* victim = s.hand != nullptr ? s.hand : s.tail;
+        while(victim->visited.load(std::memory_order_relaxed)) {
+            victim->visited.store(false, std::memory_order_relaxed);
+            victim = victim->prev != nullptr ? victim->prev : s.tail;
+        }
+
+        s.hand = victim->prev;
+        table* t = s.table_ptr.load(std::memory_order_relaxed);
+        retire_slot(t, locate(t, victim->hash, victim->key));
+        unlink(s, victim);
+        retire_entry(victim);
+        ++s.evictions;
+    }
+
+   private:
+    alignas(entry) inline static
+     char s_tombstone_storage[sizeof(entry)];
+
+    const std::size_t m_shard_count;
+    const std::size_t m_shard_capacity;
+    std::unique_ptr<shard[]> m_shards;
+    // per-thread cells, a hot key does not turn its shard's counter into a shared write
+    sharded_counter m_hits;
+    sharded_counter m_misses;
+    [[no_unique_address]] Hash m_hash;
+    [[no_unique_address]] KeyEqual m_equal;
+};
+
+}
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <allocator.hpp>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace conc {
+
+// Grow-only concurrent vector over a two-level bucket array (Dechev, Pirkelbauer, Stroustrup,
+// "Lock-free Dynamically Resizable Arrays", OPODIS 2006): segment k holds FIRST << k elements,
+// so an index maps to its segment and offset with one bit scan and elements never move.
+// push_back reserves its index with one fetch_add, installs a missing segment with a CAS and
+// constructs in place; a per-element ready flag lets whichever pusher finishes a gap advance the
+// published size, so size() only covers constructed elements and no pusher waits for another.
+template<typename T>
+requires(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_destructible_v<T>)
+class concurrent_vector {
+   private:
+    static constexpr std::size_t FIRST_BITS = 3;
+    static constexpr std::size_t FIRST = std::size_t(1) << FIRST_BITS;
+    static constexpr std::size_t SEGMENTS = 64 - FIRST_BITS;
+
+    using flag = std::atomic<std::uint8_t>;
+
+    struct location {
+        std::size_t segment;
+        std::size_t offset;
+    };
+
+    static location locate(std::size_t index) noexcept {
+        const std::size_t position = index + FIRST;
+        const std::size_t high = std::bit_width(position) - 1;
+        return {high - FIRST_BITS, position - (std::size_t(1) << high)};
+    }
+
+    static constexpr std::size_t segment_size(std::size_t segment) noexcept {
+        return FIRST << segment;
+    }
+
+   public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    concurrent_vector() noexcept = default;
+    concurrent_vector(concurrent_vector const&) = delete;
+    concurrent_vector(concurrent_vector&& other) = delete;
+    concurrent_vector& operator=(concurrent_vector const&) = delete;
+    concurrent_vector& operator=(concurrent_vector &&) = delete;
+
+    //not thread-safe
+    ~concurrent_vector() {
+        const std::size_t reserved = m_reserved.load(std::memory_order_relaxed);
+        for(std::size_t i = 0; i < reserved; ++i) {
+            const location l = locate(i);
+            std::destroy_at(m_elements[l.segment].load(std::memory_order_relaxed) + l.offset);
+        }
+        for(std::size_t s = 0; s < SEGMENTS; ++s) {
+            free_segment(s, m_elements[s].load(std::memory_order_relaxed), m_ready[s].load(std::memory_order_relaxed));
+        }
+    }
+
+   public:
+    // any thread, returns the element's index; value is built by the caller, so an exception
+    // from its construction leaves the vector untouched
+    std::size_t push_back(T value) noexcept {
+        const std::size_t index = m_reserved.fetch_add(1, std::memory_order_relaxed);
+        const location l = locate(index);
+        std::construct_at(elements(l.segment) + l.offset, std::move(value));
+        // seq_cst with the loads in publish: of two pushers finishing neighbours one sees the other
+        m_ready[l.segment].load(std::memory_order_acquire)[l.offset].store(1, std::memory_order_seq_cst);
+        publish();
+        return index;
+    }
+
+    template<typename... Args>
+    requires(std::is_constructible_v<T, Args...>)
+    std::size_t emplace_back(Args&&... args) {
+        return push_back(T(std::forward<Args>(args)...));
+    }
+
+    // any thread: allocates the segments that indices below n fall into
+    void reserve(std::size_t n) noexcept {
+        if(n == 0) {
+            return;
+        }
+        for(std::size_t s = 0; s <= locate(n - 1).segment; ++s) {
+            elements(s);
+        }
+    }
+
+    // index below size(), or one whose push_back happened before
+    [[nodiscard]]
+    T& operator[](std::size_t index) noexcept {
+        const location l = locate(index);
+        return m_elements[l.segment].load(std::memory_order_acquire)[l.offset];
+    }
+
+    [[nodiscard]]
+    const T& operator[](std::size_t index) const noexcept {
+        const location l = locate(index);
+        return m_elements[l.segment].load(std::memory_order_acquire)[l.offset];
+    }
+
+    // every index below it is constructed and visible to the caller
+    [[nodiscard]]
+    std::size_t size() const noexcept {
+        return m_size.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]]
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+   private:
+    // the segment's elements, installed first by whoever needs it; a failed allocation
+    // terminates since the index that needed it cannot be given back
+    T* elements(std::size_t segment) noexcept {
+        T* current = m_elements[segment].load(std::memory_order_acquire);
+        if(current != nullptr) [[likely]] {
+            return current;
+        }
+
+        T* fresh = nullptr;
+        flag* ready = nullptr;
+        try {
+            fresh = cache_aligned_alloc<T>().allocate(segment_size(segment));
+            ready = cache_aligned_alloc<flag>().allocate(segment_size(segment));
+        } catch(...) {
+            std::terminate();
+        }
+        for(std::size_t i = 0; i < segment_size(segment); ++i) {
+            std::construct_at(ready + i, 0);
+        }
+
+        // flags go first, a thread that sees the elements also finds them
+        flag* no_ready = nullptr;
+        if(!m_ready[segment].compare_exchange_strong(no_ready, ready, std::memory_order_acq_rel)) {
+            free_segment(segment, nullptr, ready);
+        }
+        if(!m_elements[segment].compare_exchange_strong(current, fresh, std::memory_order_acq_rel)) {
+            free_segment(segment, fresh, nullptr);
+            return current;
+        }
+        return fresh;
+    }
+
+    // moves the published size over every ready element following it
+    void publish() noexcept {
+        // flags of unreserved slots stay zero, so no bound on the reserved count is needed
+        std::size_t size = m_size.load(std::memory_order_seq_cst);
+        while(true) {
+            const location l = locate(size);
+            flag* ready = m_ready[l.segment].load(std::memory_order_acquire);
+            if(ready == nullptr || ready[l.offset].load(std::memory_order_seq_cst) == 0) {
+                return;
+            }
+            // a failed CAS reloads size, somebody else advanced it
+            m_size.compare_exchange_weak(size, size + 1, std::memory_order_seq_cst);
+        }
+    }
+
+    static void free_segment(std::size_t segment, T* elements, flag* ready) noexcept {
+        if(elements != nullptr) {
+            cache_aligned_alloc<T>().deallocate(elements, segment_size(segment));
+        }
+        if(ready != nullptr) {
+            std::destroy_n(ready, segment_size(segment));
+            cache_aligned_alloc<flag>().deallocate(ready, segment_size(segment));
+        }
+    }
+
+   private:
+    std::array<std::atomic<T*>, SEGMENTS> m_elements{};
+    std::array<std::atomic<flag*>, SEGMENTS> m_ready{};
+
+    alignas(std::hardware_destructive_interference_size)
+    std::atomic<std::size_t> m_reserved = 0;
+    alignas(std::hardware_destructive_interference_size)
+    std::atomic<std::size_t> m_size = 0;
+};
+
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "domain.hpp"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+#include <hazard_pointer.hpp>
+
+namespace conc {
+
+// Read-mostly map: readers protect the current immutable snapshot (a sorted vector) and
+// binary-search it without further synchronization, writers are serialized, rebuild the
+// snapshot with a batch of updates applied and retire the previous one.
+// Every reader holds one hazard cell for the duration of its call, and all cow_maps of one type
+// share max_readers of them: that many reads may run at once, more is undefined behaviour.
+template<typename K, typename V, typename Compare = std::less<K>, std::size_t max_readers = 256>
+requires(std::is_copy_constructible_v<K> && std::is_copy_constructible_v<V> &&
+         std::is_nothrow_destructible_v<K> && std::is_nothrow_destructible_v<V>)
+class cow_map {
+   public:
+    using value_type = std::pair<K, V>;
+
+   private:
+    struct snapshot {
+        std::vector<value_type> entries;
+    };
+
+   public:
+    // find and size read too; a read nested in another's f holds two cells. Only commits
+    // retire and scan the cells, so their number costs readers nothing
+    static constexpr std::size_t MAX_CONCURRENT_READERS = max_readers;
+    using hazard_domain = conc::hazard_domain<snapshot, max_readers, cow_map<K, V, Compare, max_readers>>;
+
+   private:
+    using hazard_pointer_t = hazard_pointer<snapshot, hazard_domain>;
+
+   public:
+    // updates collected on the writer side and applied by commit() in one snapshot swap,
+    // when a key appears several times the last operation wins
+    class batch {
+       public:
+        void insert_or_assign(K key, V value) {
+            m_ops.emplace_back(std::move(key), std::move(value));
+        }
+
+        void erase(K key) {
+            m_ops.emplace_back(std::move(key), std::nullopt);
+        }
+
+        [[nodiscard]]
+        bool empty() const noexcept {
+            return m_ops.empty();
+        }
+
+       private:
+        friend class cow_map;
+        std::vector<std::pair<K, std::optional<V>>> m_ops;
+    };
+
+   public:
+    cow_map() : m_snapshot(new snapshot{}) {}
+    cow_map(cow_map const&) = delete;
+    cow_map(cow_map&& other) = delete;
+    cow_map& operator=(cow_map const&) = delete;
+    cow_map& operator=(cow_map &&) = delete;
+
+    //not thread-safe
+    ~cow_map() {
+        delete m_snapshot.load(std::memory_order_relaxed);
+    }
+
+   public:
+    std::optional<V> find(const K& key) const {
+        return read([this, &key](std::span<const value_type> entries) -> std::optional<V> {
+            auto it = lower_bound(entries, key);
+            if(it == entries.end() || m_compare(key, it->first)) {
+                return std::nullopt;
+            }
+            return it->second;
+        });
+    }
+
+    bool contains(const K& key) const {
+        return find(key).has_value();
+    }
+
+    std::size_t size() const {
+        return read([](std::span<const value_type> entries) { return entries.size(); });
+    }
+
+    // runs f over one consistent snapshot, sorted by key; the span must not escape f
+    template<typename F>
+    decltype(auto) read(F&& f) const {
+        auto hp = hazard_pointer_t::make_hazard_pointer();
+        const snapshot* current = hp.protect(m_snapshot);
+        return std::invoke(std::forward<F>(f), std::span<const value_type>(current->entries));
+    }
+
+    void commit(batch&& updates) {
+        if(updates.empty()) {
+            return;
+        }
+
+        auto& ops = updates.m_ops;
+        std::stable_sort(ops.begin(), ops.end(), [this](const auto& a, const auto& b) {
+            return m_compare(a.first, b.first);
+        });
+
+        std::lock_guard lock(m_writer);
+        snapshot* old = m_snapshot.load(std::memory_order_relaxed);
+        auto fresh = new snapshot{};
+        fresh->entries.reserve(old->entries.size() + ops.size());
+
+        auto it = old->entries.begin();
+        for(auto op = ops.begin(); op != ops.end(); ++op) {
+            if(auto next = std::next(op); next != ops.end() && !m_compare(op->first, next->first)) {
+                continue;
+            }
+
+            while(it != old->entries.end() && m_compare(it->first, op->first)) {
+                fresh->entries.push_back(*it++);
+            }
+
+            if(it != old->entries.end() && !m_compare(op->first, it->first)) {
+                ++it;
+            }
+
+            if(op->second.has_value()) {
+                fresh->entries.emplace_back(std::move(op->first), std::move(*op->second));
+            }
+        }
+        fresh->entries.insert(fresh->entries.end(), it, old->entries.end());
+
+        m_snapshot.store(fresh, std::memory_order_release);
+        hazard_pointer_t::retire(old);
+        // writes are rare, reclaim right away instead of waiting for the domain threshold
+        hazard_domain().delete_hazards();
+    }
+
+    void insert_or_assign(K key, V value) {
+        batch updates;
+        updates.insert_or_assign(std::move(key), std::move(value));
+        commit(std::move(updates));
+    }
+
+    void erase(K key) {
+        batch updates;
+        updates.erase(std::move(key));
+        commit(std::move(updates));
+    }
+
+   private:
+    auto lower_bound(std::span<const value_type> entries, const K& key) const {
+        return std::lower_bound(entries.begin(), entries.end(), key, [this](const value_type& e, const K& k) {
+            return m_compare(e.first, k);
+        });
+    }
+
+   private:
+    std::atomic<snapshot*> m_snapshot;
+    std::mutex m_writer;
+    [[no_unique_address]] Compare m_compare;
+};
+
+}
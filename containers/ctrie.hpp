@@ -0,0 +1,846 @@
+#pragma once
+
+#include "domain.hpp"
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <hazard_pointer.hpp>
+
+namespace conc {
+
+// Concurrent hash trie with O(1) snapshots (Prokopec, Bronson, Bagwell, Odersky 2012).
+// Mutations are lock-free GCAS proposals on indirection nodes, snapshots swap the root with
+// RDCSS and lazily copy shared nodes of older generations on first write.
+//
+// Snapshots share structure, so a node may be reachable from several tries: every node is
+// reference counted, a node is retired to the hazard domain when its count drops to zero
+// and releases its children only once it is actually freed. Holding a hazard pointer on a
+// node therefore keeps everything it points to alive, and only the mutable slots (root and
+// indirection nodes) need validated protection.
+template<typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+requires(std::is_copy_constructible_v<K> && std::is_copy_constructible_v<V> &&
+         std::is_nothrow_destructible_v<K> && std::is_nothrow_destructible_v<V>)
+class ctrie {
+   private:
+    static constexpr unsigned LEVEL_BITS = 5;
+    static constexpr unsigned HASH_BITS = 64;
+    static constexpr std::uintptr_t FAILED = 1;
+
+    enum class node_type : std::uint8_t { inode, cnode, snode, tnode, lnode, descriptor };
+
+    struct node {
+        explicit node(node_type t) noexcept : type(t) {}
+        virtual ~node() = default;
+
+        const node_type type;
+        std::atomic<std::uint32_t> refs = 1;
+    };
+
+    struct snode : node {
+        snode(K k, V v, std::uint64_t h) : node(node_type::snode), key(std::move(k)), value(std::move(v)), hash(h) {}
+
+        const K key;
+        const V value;
+        const std::uint64_t hash;
+    };
+
+    // prev holds the GCAS proposal: the main node being replaced, tagged FAILED once rejected;
+    // it never owns a reference by the time the node is freed
+    struct main_node : node {
+        using node::node;
+
+        std::atomic<std::uintptr_t> prev = 0;
+    };
+
+    struct inode : node {
+        inode(std::uint64_t g, node* m) : node(node_type::inode), gen(g), main(m) {}
+        ~inode() override {
+            release_deferred(main.load(std::memory_order_relaxed));
+        }
+
+        const std::uint64_t gen;
+        std::atomic<node*> main;
+    };
+
+    struct cnode : main_node {
+        cnode(std::uint32_t b, std::vector<node*>&& a, std::uint64_t g) :
+            main_node(node_type::cnode), bitmap(b), array(std::move(a)), gen(g) {}
+        ~cnode() override {
+            for(auto branch : array) {
+                release_deferred(branch);
+            }
+        }
+
+        const std::uint32_t bitmap;
+        const std::vector<node*> array;   // inode or snode branches
+        const std::uint64_t gen;
+    };
+
+    // entombed single key, left behind by a remove until the parent compresses it away
+    struct tnode : main_node {
+        explicit tnode(snode* s) : main_node(node_type::tnode), sn(s) {}
+        ~tnode() override {
+            release_deferred(sn);
+        }
+
+        snode* const sn;
+    };
+
+    // keys whose full hashes collide
+    struct lnode : main_node {
+        explicit lnode(std::vector<snode*>&& e) : main_node(node_type::lnode), entries(std::move(e)) {}
+        ~lnode() override {
+            for(auto sn : entries) {
+                release_deferred(sn);
+            }
+        }
+
+        const std::vector<snode*> entries;
+    };
+
+    // RDCSS of the root: replace ov by nv if ov's main is still expected. Owns both inodes,
+    // whichever did not end up in the root is released with the descriptor
+    struct descriptor : node {
+        enum : int { PENDING, COMMITTED, ABORTED };
+
+        descriptor(inode* o, main_node* e, inode* n) : node(node_type::descriptor), ov(o), expected(e), nv(n) {}
+        ~descriptor() override {
+            release_deferred(state.load(std::memory_order_relaxed) == COMMITTED ? ov : nv);
+        }
+
+        inode* const ov;
+        main_node* const expected;
+        inode* const nv;
+        std::atomic<int> state = PENDING;
+    };
+
+   public:
+    // every operation holds a context of HAZARDS_PER_OPERATION cells and every ctrie of one type
+    // draws from the same domain: at most MAX_CONCURRENT_OPERATIONS operations may run at once,
+    // a for_each whose callback uses a ctrie of the same type counting twice; more is undefined
+    static constexpr std::size_t HAZARDS_PER_OPERATION = 6;
+    static constexpr std::size_t MAX_CONCURRENT_OPERATIONS = 64;
+    using hazard_domain = conc::hazard_domain<node, HAZARDS_PER_OPERATION * MAX_CONCURRENT_OPERATIONS, ctrie<K, V, Hash, KeyEqual>>;
+
+   private:
+    using hazard_pointer_t = hazard_pointer<node, hazard_domain>;
+
+    struct context {
+        hazard_pointer_t parent = hazard_pointer_t::make_hazard_pointer();
+        hazard_pointer_t current = hazard_pointer_t::make_hazard_pointer();
+        hazard_pointer_t main = hazard_pointer_t::make_hazard_pointer();
+        hazard_pointer_t other = hazard_pointer_t::make_hazard_pointer();
+        hazard_pointer_t root = hazard_pointer_t::make_hazard_pointer();
+        hazard_pointer_t desc = hazard_pointer_t::make_hazard_pointer();
+    };
+
+   public:
+    ctrie() : m_root(new inode(next_generation(), new cnode(0, {}, 0))) {}
+    ctrie(ctrie const&) = delete;
+    ctrie& operator=(ctrie const&) = delete;
+    ctrie& operator=(ctrie &&) = delete;
+
+    ctrie(ctrie&& other) noexcept :
+        m_root(other.m_root.exchange(nullptr, std::memory_order_relaxed)),
+        m_readonly(other.m_readonly) {}
+
+    //not thread-safe
+    ~ctrie() {
+        release(m_root.load(std::memory_order_relaxed));
+        // pull the released structure through the domain now instead of at the next retires:
+        // every pass frees nodes whose destructors defer their children, until a pass frees
+        // no more inner nodes
+        hazard_domain().delete_hazards();
+        while(!tl_pending.empty()) {
+            drain();
+            hazard_domain().delete_hazards();
+        }
+    }
+
+   public:
+    std::optional<V> find(const K& key) const {
+        const auto hash = hash_of(key);
+        context ctx;
+
+    restart:
+        auto i = read_root(ctx, false);
+        const auto start_gen = i->gen;
+        inode* parent = nullptr;
+        unsigned level = 0;
+
+        while(true) {
+            auto m = gcas_read(i, ctx.main, ctx);
+
+            if(m->type == node_type::cnode) {
+                auto cn = static_cast<cnode*>(m);
+                auto [flag, pos] = flag_pos(hash, level, cn->bitmap);
+                if(!(cn->bitmap & flag)) {
+                    return std::nullopt;
+                }
+
+                auto branch = cn->array[pos];
+                if(branch->type == node_type::snode) {
+                    return value_if(static_cast<snode*>(branch), key, hash);
+                }
+
+                auto sub = static_cast<inode*>(branch);
+                if(!m_readonly && sub->gen != start_gen) {
+                    if(!gcas(i, cn, renewed(cn, start_gen, ctx), ctx)) {
+                        goto restart;
+                    }
+                    continue;
+                }
+
+                descend(ctx, sub);
+                parent = std::exchange(i, sub);
+                level += LEVEL_BITS;
+            } else if(m->type == node_type::tnode) {
+                if(m_readonly) {
+                    return value_if(static_cast<tnode*>(m)->sn, key, hash);
+                }
+                clean(parent, level - LEVEL_BITS, ctx);
+                goto restart;
+            } else {
+                for(auto sn : static_cast<lnode*>(m)->entries) {
+                    if(auto value = value_if(sn, key, hash)) {
+                        return value;
+                    }
+                }
+                return std::nullopt;
+            }
+        }
+    }
+
+    bool contains(const K& key) const {
+        return find(key).has_value();
+    }
+
+    // returns false if the key was already present and nothing changed
+    bool insert(K key, V value) {
+        return emplace(std::move(key), std::move(value), true);
+    }
+
+    // returns true if the key was inserted, false if an existing value was replaced
+    bool insert_or_assign(K key, V value) {
+        return emplace(std::move(key), std::move(value), false);
+    }
+
+    bool erase(const K& key) {
+        assert(!m_readonly);
+        const auto hash = hash_of(key);
+        context ctx;
+
+    restart:
+        auto i = read_root(ctx, false);
+        const auto start_gen = i->gen;
+        inode* parent = nullptr;
+        unsigned level = 0;
+
+        while(true) {
+            auto m = gcas_read(i, ctx.main, ctx);
+
+            if(m->type == node_type::cnode) {
+                auto cn = static_cast<cnode*>(m);
+                auto [flag, pos] = flag_pos(hash, level, cn->bitmap);
+                if(!(cn->bitmap & flag)) {
+                    return false;
+                }
+
+                auto branch = cn->array[pos];
+                if(branch->type == node_type::inode) {
+                    auto sub = static_cast<inode*>(branch);
+                    if(sub->gen != start_gen) {
+                        if(!gcas(i, cn, renewed(cn, start_gen, ctx), ctx)) {
+                            goto restart;
+                        }
+                        continue;
+                    }
+
+                    descend(ctx, sub);
+                    parent = std::exchange(i, sub);
+                    level += LEVEL_BITS;
+                    continue;
+                }
+
+                auto sn = static_cast<snode*>(branch);
+                if(sn->hash != hash || !m_equal(sn->key, key)) {
+                    return false;
+                }
+
+                if(!gcas(i, cn, contracted(removed(cn, pos, flag, i->gen), level), ctx)) {
+                    goto restart;
+                }
+            } else if(m->type == node_type::tnode) {
+                clean(parent, level - LEVEL_BITS, ctx);
+                goto restart;
+            } else {
+                auto ln = static_cast<lnode*>(m);
+                std::vector<snode*> rest;
+                for(auto sn : ln->entries) {
+                    if(sn->hash != hash || !m_equal(sn->key, key)) {
+                        rest.push_back(sn);
+                    }
+                }
+
+                if(rest.size() == ln->entries.size()) {
+                    return false;
+                }
+
+                for(auto sn : rest) {
+                    share(sn);
+                }
+                main_node* replacement = rest.size() == 1 ?
+                    static_cast<main_node*>(new tnode(rest.front())) :
+                    static_cast<main_node*>(new lnode(std::move(rest)));
+
+                if(!gcas(i, ln, replacement, ctx)) {
+                    goto restart;
+                }
+            }
+
+            if(parent != nullptr && gcas_read(i, ctx.main, ctx)->type == node_type::tnode) {
+                clean_parent(parent, i, hash, level - LEVEL_BITS, start_gen, ctx);
+            }
+            return true;
+        }
+    }
+
+    // independent, writable copy of the current contents, O(1)
+    ctrie snapshot() {
+        return take_snapshot(false);
+    }
+
+    // like snapshot(), for readers only: lookups never copy nodes of older generations
+    ctrie read_only_snapshot() {
+        return take_snapshot(true);
+    }
+
+    // visits a consistent view of all entries while writers keep going
+    template<typename F>
+    void for_each(F&& f) {
+        if(!m_readonly) {
+            read_only_snapshot().for_each(std::forward<F>(f));
+            return;
+        }
+
+        context ctx;
+        walk(read_root(ctx, false), f, ctx);
+    }
+
+    std::size_t size() {
+        std::size_t count = 0;
+        for_each([&count](const K&, const V&) { ++count; });
+        return count;
+    }
+
+    [[nodiscard]]
+    bool is_read_only() const noexcept {
+        return m_readonly;
+    }
+
+   private:
+    ctrie(inode* root, bool readonly) : m_root(root), m_readonly(readonly) {}
+
+    bool emplace(K&& key, V&& value, bool only_if_absent) {
+        assert(!m_readonly);
+        const auto hash = hash_of(key);
+        context ctx;
+
+    restart:
+        auto i = read_root(ctx, false);
+        const auto start_gen = i->gen;
+        inode* parent = nullptr;
+        unsigned level = 0;
+
+        while(true) {
+            auto m = gcas_read(i, ctx.main, ctx);
+
+            if(m->type == node_type::cnode) {
+                auto cn = static_cast<cnode*>(m);
+                auto [flag, pos] = flag_pos(hash, level, cn->bitmap);
+
+                if(!(cn->bitmap & flag)) {
+                    auto base = cn->gen == i->gen ? cn : renewed(cn, i->gen, ctx);
+                    auto fresh = new snode(key, value, hash);
+                    auto next = inserted(base, pos, flag, fresh, i->gen);
+                    if(base != cn) {
+                        release(base);
+                    }
+
+                    if(!gcas(i, cn, next, ctx)) {
+                        goto restart;
+                    }
+                    return true;
+                }
+
+                auto branch = cn->array[pos];
+                if(branch->type == node_type::inode) {
+                    auto sub = static_cast<inode*>(branch);
+                    if(sub->gen != start_gen) {
+                        if(!gcas(i, cn, renewed(cn, start_gen, ctx), ctx)) {
+                            goto restart;
+                        }
+                        continue;
+                    }
+
+                    descend(ctx, sub);
+                    parent = std::exchange(i, sub);
+                    level += LEVEL_BITS;
+                    continue;
+                }
+
+                auto sn = static_cast<snode*>(branch);
+                if(sn->hash == hash && m_equal(sn->key, key)) {
+                    if(only_if_absent) {
+                        return false;
+                    }
+
+                    if(!gcas(i, cn, updated(cn, pos, new snode(key, value, hash), i->gen), ctx)) {
+                        goto restart;
+                    }
+                    return false;
+                }
+
+                auto base = cn->gen == i->gen ? cn : renewed(cn, i->gen, ctx);
+                auto sub = new inode(i->gen, dual(share(sn), new snode(key, value, hash), level + LEVEL_BITS, i->gen));
+                auto next = updated(base, pos, sub, i->gen);
+                if(base != cn) {
+                    release(base);
+                }
+
+                if(!gcas(i, cn, next, ctx)) {
+                    goto restart;
+                }
+                return true;
+            }
+
+            if(m->type == node_type::tnode) {
+                clean(parent, level - LEVEL_BITS, ctx);
+                goto restart;
+            }
+
+            auto ln = static_cast<lnode*>(m);
+            std::vector<snode*> entries;
+            bool found = false;
+            for(auto sn : ln->entries) {
+                if(sn->hash == hash && m_equal(sn->key, key)) {
+                    found = true;
+                } else {
+                    entries.push_back(share(sn));
+                }
+            }
+
+            if(found && only_if_absent) {
+                for(auto sn : entries) {
+                    release(sn);
+                }
+                return false;
+            }
+
+            entries.push_back(new snode(key, value, hash));
+            if(!gcas(i, ln, new lnode(std::move(entries)), ctx)) {
+                goto restart;
+            }
+            return !found;
+        }
+    }
+
+    ctrie take_snapshot(bool readonly) {
+        assert(!m_readonly);
+        context ctx;
+
+        while(true) {
+            auto root = read_root(ctx, false);
+            auto expected = gcas_read(root, ctx.main, ctx);
+            if(!try_share(expected)) {
+                continue;
+            }
+            share(expected);
+
+            auto snapshot_root = new inode(next_generation(), expected);
+            auto desc = new descriptor(root, expected, new inode(next_generation(), expected));
+
+            node* current = root;
+            if(!m_root.compare_exchange_strong(current, desc)) {
+                desc->state.store(descriptor::ABORTED, std::memory_order_relaxed);
+                delete desc;
+                release(snapshot_root);
+                drain();
+                continue;
+            }
+
+            complete(false, ctx.desc, ctx.other, ctx.root, ctx.parent);
+            bool committed = desc->state.load(std::memory_order_acquire) == descriptor::COMMITTED;
+            hazard_pointer_t::retire(desc);
+            drain();
+
+            if(committed) {
+                return ctrie(snapshot_root, readonly);
+            }
+            release(snapshot_root);
+        }
+    }
+
+    template<typename F>
+    void walk(inode* in, F& f, context& ctx) {
+        // committed main nodes of a read-only snapshot never change, so the snapshot's own
+        // references keep them alive once the read has settled pending proposals
+        auto m = gcas_read(in, ctx.main, ctx);
+
+        if(m->type == node_type::cnode) {
+            for(auto branch : static_cast<cnode*>(m)->array) {
+                if(branch->type == node_type::snode) {
+                    auto sn = static_cast<snode*>(branch);
+                    f(sn->key, sn->value);
+                } else {
+                    walk(static_cast<inode*>(branch), f, ctx);
+                }
+            }
+        } else if(m->type == node_type::tnode) {
+            auto sn = static_cast<tnode*>(m)->sn;
+            f(sn->key, sn->value);
+        } else {
+            for(auto sn : static_cast<lnode*>(m)->entries) {
+                f(sn->key, sn->value);
+            }
+        }
+    }
+
+    // GCAS
+
+    bool gcas(inode* in, main_node* old, main_node* proposal, context& ctx) const {
+        proposal->prev.store(reinterpret_cast<std::uintptr_t>(old), std::memory_order_relaxed);
+        ctx.other.reset_protection(proposal);
+
+        node* expected = old;
+        if(!in->main.compare_exchange_strong(expected, proposal)) {
+            release(proposal);
+            return false;
+        }
+
+        // the inode's reference to old moved into proposal->prev
+        return gcas_commit(in, proposal, ctx.other, ctx.root, ctx.desc) == proposal;
+    }
+
+    main_node* gcas_read(inode* in, hazard_pointer_t& hp, context& ctx) const {
+        return gcas_read(in, hp, ctx.root, ctx.desc);
+    }
+
+    main_node* gcas_read(inode* in, hazard_pointer_t& hp, hazard_pointer_t& hp_root, hazard_pointer_t& hp_desc) const {
+        auto m = static_cast<main_node*>(hp.protect(in->main));
+        if(m->prev.load(std::memory_order_acquire) == 0) {
+            return m;
+        }
+        return gcas_commit(in, m, hp, hp_root, hp_desc);
+    }
+
+    // settles the proposal m (protected by hp), returns the committed main node, protected by hp
+    main_node* gcas_commit(inode* in, main_node* m, hazard_pointer_t& hp,
+                           hazard_pointer_t& hp_root, hazard_pointer_t& hp_desc) const {
+        while(true) {
+            auto prev = m->prev.load(std::memory_order_acquire);
+            if(prev == 0) {
+                return m;
+            }
+
+            if(prev & FAILED) {
+                node* expected = m;
+                if(in->main.compare_exchange_strong(expected, reinterpret_cast<node*>(prev & ~FAILED))) {
+                    release(m);
+                }
+                m = static_cast<main_node*>(hp.protect(in->main));
+                continue;
+            }
+
+            auto root = read_root(hp_root, hp_desc, true);
+            if(root->gen == in->gen && !m_readonly) {
+                if(m->prev.compare_exchange_strong(prev, 0)) {
+                    release(reinterpret_cast<node*>(prev));
+                    return m;
+                }
+            } else {
+                m->prev.compare_exchange_strong(prev, prev | FAILED);
+            }
+        }
+    }
+
+    // RDCSS root
+
+    inode* read_root(context& ctx, bool abort) const {
+        return read_root(ctx.current, ctx.desc, abort, &ctx);
+    }
+
+    inode* read_root(hazard_pointer_t& hp, hazard_pointer_t& hp_desc, bool abort, context* ctx = nullptr) const {
+        while(true) {
+            auto r = hp.protect(m_root);
+            if(r->type == node_type::inode) {
+                return static_cast<inode*>(r);
+            }
+
+            if(abort) {
+                complete_aborting(hp_desc);
+            } else {
+                complete(false, hp_desc, ctx->main, ctx->root, ctx->other);
+            }
+        }
+    }
+
+    void complete_aborting(hazard_pointer_t& hp_desc) const {
+        hazard_pointer_t unused;
+        complete(true, hp_desc, unused, unused, unused);
+    }
+
+    void complete(bool abort, hazard_pointer_t& hp_desc, hazard_pointer_t& hp_main,
+                  hazard_pointer_t& hp_root, hazard_pointer_t& hp_inner_desc) const {
+        while(true) {
+            auto v = hp_desc.protect(m_root);
+            if(v->type == node_type::inode) {
+                return;
+            }
+
+            auto desc = static_cast<descriptor*>(v);
+            int state = desc->state.load(std::memory_order_acquire);
+            if(state == descriptor::PENDING) {
+                int decision = descriptor::ABORTED;
+                if(!abort && gcas_read(desc->ov, hp_main, hp_root, hp_inner_desc) == desc->expected) {
+                    decision = descriptor::COMMITTED;
+                }
+                desc->state.compare_exchange_strong(state, decision);
+                state = desc->state.load(std::memory_order_acquire);
+            }
+
+            node* expected = desc;
+            m_root.compare_exchange_strong(expected, state == descriptor::COMMITTED ? desc->nv : desc->ov);
+        }
+    }
+
+    // node construction, all results own one reference
+
+    cnode* renewed(cnode* cn, std::uint64_t gen, context& ctx) const {
+        std::vector<node*> array;
+        array.reserve(cn->array.size());
+        for(auto branch : cn->array) {
+            if(branch->type == node_type::snode) {
+                array.push_back(share(branch));
+                continue;
+            }
+
+            auto sub = static_cast<inode*>(branch);
+            main_node* m;
+            do {
+                m = gcas_read(sub, ctx.other, ctx);
+            } while(!try_share(m));
+            array.push_back(new inode(gen, m));
+        }
+        return new cnode(cn->bitmap, std::move(array), gen);
+    }
+
+    static cnode* inserted(cnode* cn, std::size_t pos, std::uint32_t flag, node* branch, std::uint64_t gen) {
+        std::vector<node*> array;
+        array.reserve(cn->array.size() + 1);
+        for(std::size_t i = 0; i < cn->array.size(); ++i) {
+            if(i == pos) {
+                array.push_back(branch);
+            }
+            array.push_back(share(cn->array[i]));
+        }
+        if(pos == cn->array.size()) {
+            array.push_back(branch);
+        }
+        return new cnode(cn->bitmap | flag, std::move(array), gen);
+    }
+
+    static cnode* updated(cnode* cn, std::size_t pos, node* branch, std::uint64_t gen) {
+        std::vector<node*> array;
+        array.reserve(cn->array.size());
+        for(std::size_t i = 0; i < cn->array.size(); ++i) {
+            array.push_back(i == pos ? branch : share(cn->array[i]));
+        }
+        return new cnode(cn->bitmap, std::move(array), gen);
+    }
+
+    static cnode* removed(cnode* cn, std::size_t pos, std::uint32_t flag, std::uint64_t gen) {
+        std::vector<node*> array;
+        array.reserve(cn->array.size() - 1);
+        for(std::size_t i = 0; i < cn->array.size(); ++i) {
+            if(i != pos) {
+                array.push_back(share(cn->array[i]));
+            }
+        }
+        return new cnode(cn->bitmap & ~flag, std::move(array), gen);
+    }
+
+    // a lone key below the root is entombed so that the parent can pull it up
+    static main_node* contracted(cnode* cn, unsigned level) {
+        if(level > 0 && cn->array.size() == 1 && cn->array[0]->type == node_type::snode) {
+            auto tn = new tnode(share(static_cast<snode*>(cn->array[0])));
+            release(cn);
+            return tn;
+        }
+        return cn;
+    }
+
+    main_node* compressed(cnode* cn, unsigned level, std::uint64_t gen, context& ctx) const {
+        std::vector<node*> array;
+        array.reserve(cn->array.size());
+        for(auto branch : cn->array) {
+            if(branch->type == node_type::inode) {
+                auto m = gcas_read(static_cast<inode*>(branch), ctx.other, ctx);
+                if(m->type == node_type::tnode) {
+                    array.push_back(share(static_cast<tnode*>(m)->sn));
+                    continue;
+                }
+            }
+            array.push_back(share(branch));
+        }
+        return contracted(new cnode(cn->bitmap, std::move(array), gen), level);
+    }
+
+    static main_node* dual(snode* x, snode* y, unsigned level, std::uint64_t gen) {
+        if(level >= HASH_BITS) {
+            return new lnode(std::vector<snode*>{x, y});
+        }
+
+        auto xi = index_of(x->hash, level);
+        auto yi = index_of(y->hash, level);
+        std::uint32_t bitmap = (1u << xi) | (1u << yi);
+
+        if(xi == yi) {
+            auto sub = new inode(gen, dual(x, y, level + LEVEL_BITS, gen));
+            return new cnode(bitmap, std::vector<node*>{sub}, gen);
+        }
+
+        return new cnode(bitmap, xi < yi ? std::vector<node*>{x, y} : std::vector<node*>{y, x}, gen);
+    }
+
+    // tomb cleanup
+
+    void clean(inode* in, unsigned level, context& ctx) const {
+        if(in == nullptr) {
+            return;
+        }
+
+        auto m = gcas_read(in, ctx.main, ctx);
+        if(m->type == node_type::cnode) {
+            gcas(in, m, compressed(static_cast<cnode*>(m), level, in->gen, ctx), ctx);
+        }
+    }
+
+    void clean_parent(inode* parent, inode* in, std::uint64_t hash, unsigned level,
+                      std::uint64_t start_gen, context& ctx) const {
+        while(true) {
+            auto m = gcas_read(in, ctx.main, ctx);
+            if(m->type != node_type::tnode) {
+                return;
+            }
+            auto resurrected = share(static_cast<tnode*>(m)->sn);
+
+            auto pm = gcas_read(parent, ctx.main, ctx);
+            if(pm->type != node_type::cnode) {
+                release(resurrected);
+                return;
+            }
+
+            auto cn = static_cast<cnode*>(pm);
+            auto [flag, pos] = flag_pos(hash, level, cn->bitmap);
+            if(!(cn->bitmap & flag) || cn->array[pos] != in) {
+                release(resurrected);
+                return;
+            }
+
+            auto next = contracted(updated(cn, pos, resurrected, parent->gen), level);
+            if(gcas(parent, cn, next, ctx) || read_root(ctx.root, ctx.desc, false, &ctx)->gen != start_gen) {
+                return;
+            }
+        }
+    }
+
+    // helpers
+
+    static void descend(context& ctx, inode* sub) noexcept {
+        // sub is kept alive by the protected main node it was read from
+        ctx.parent.reset_protection(sub);
+        ctx.parent.swap(ctx.current);
+    }
+
+    std::uint64_t hash_of(const K& key) const {
+        return static_cast<std::uint64_t>(m_hash(key));
+    }
+
+    static unsigned index_of(std::uint64_t hash, unsigned level) noexcept {
+        return static_cast<unsigned>(hash >> level) & ((1u << LEVEL_BITS) - 1);
+    }
+
+    static std::pair<std::uint32_t, std::size_t> flag_pos(std::uint64_t hash, unsigned level, std::uint32_t bitmap) noexcept {
+        std::uint32_t flag = 1u << index_of(hash, level);
+        return {flag, static_cast<std::size_t>(std::popcount(bitmap & (flag - 1)))};
+    }
+
+    std::optional<V> value_if(snode* sn, const K& key, std::uint64_t hash) const {
+        if(sn->hash == hash && m_equal(sn->key, key)) {
+            return sn->value;
+        }
+        return std::nullopt;
+    }
+
+    static std::uint64_t next_generation() noexcept {
+        return s_generation.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    // reference counting
+
+    // only for nodes kept alive by a protected owner, whose count cannot be zero
+    template<typename N>
+    static N* share(N* n) noexcept {
+        n->refs.fetch_add(1, std::memory_order_relaxed);
+        return n;
+    }
+
+    // for main nodes read from an inode, which may have just dropped them
+    static bool try_share(node* n) noexcept {
+        auto refs = n->refs.load(std::memory_order_relaxed);
+        while(refs != 0) {
+            if(n->refs.compare_exchange_weak(refs, refs + 1, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static void release(node* n) {
+        if(n != nullptr && n->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            hazard_pointer_t::retire(n);
+            drain();
+        }
+    }
+
+    // called from destructors, which run inside the domain's reclamation loop
+    static void release_deferred(node* n) noexcept {
+        if(n != nullptr && n->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            tl_pending.push_back(n);
+        }
+    }
+
+    static void drain() {
+        while(!tl_pending.empty()) {
+            auto n = tl_pending.back();
+            tl_pending.pop_back();
+            hazard_pointer_t::retire(n);
+        }
+    }
+
+   private:
+    mutable std::atomic<node*> m_root;
+    const bool m_readonly = false;
+    [[no_unique_address]] Hash m_hash;
+    [[no_unique_address]] KeyEqual m_equal;
+
+    inline static std::atomic<std::uint64_t> s_generation = 0;
+    inline static thread_local std::vector<node*> tl_pending;
+};
+
+}
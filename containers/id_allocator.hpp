@@ -0,0 +1,184 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <functional>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace conc {
+
+// Lock-free allocator of ids in [0, capacity): leaf bitmaps mark taken ids, every summary level
+// marks children that are full, so acquire descends O(log64 capacity) words picking a zero bit
+// with tzcnt. Summary bits are hints: a full bit is re-checked after it is set and cleared by
+// every release, so capacity is never lost; a stale "not full" bit only costs a retry.
+class id_allocator {
+   private:
+    using word = std::uint64_t;
+    static constexpr std::size_t BITS = 64;
+    static constexpr word FULL = ~word(0);
+
+   public:
+    explicit id_allocator(std::size_t capacity) : m_capacity(capacity) {
+        std::size_t bits = capacity;
+        do {
+            const std::size_t words = std::max<std::size_t>((bits + BITS - 1) / BITS, 1);
+            auto level = std::make_unique<std::atomic<word>[]>(words);
+            // bits past the end are permanently taken
+            if(bits % BITS != 0) {
+                level[words - 1].store(FULL << (bits % BITS), std::memory_order_relaxed);
+            }
+            m_levels.push_back(std::move(level));
+            m_sizes.push_back(words);
+            bits = words;
+        } while(bits > 1);
+
+        if(capacity == 0) {
+            m_levels.front()[0].store(FULL, std::memory_order_relaxed);
+        }
+    }
+
+    id_allocator(id_allocator const&) = delete;
+    id_allocator(id_allocator&& other) = delete;
+    id_allocator& operator=(id_allocator const&) = delete;
+    id_allocator& operator=(id_allocator &&) = delete;
+
+   public:
+    // nullopt when every id is taken
+    [[nodiscard]]
+    std::optional<std::size_t> acquire() noexcept {
+        const std::size_t top = m_levels.size() - 1;
+        const std::size_t hint = tl_hint % std::max<std::size_t>(m_capacity, 1);
+
+        while(true) {
+            if(m_levels[top][0].load(std::memory_order_seq_cst) == FULL) [[unlikely]] {
+                return std::nullopt;
+            }
+
+            // walk down towards the hinted leaf, deviating only where its subtree is full
+            std::size_t index = 0;
+            bool restart = false;
+            for(std::size_t level = top; level > 0; --level) {
+                const word free = ~m_levels[level][index].load(std::memory_order_seq_cst);
+                if(free == 0) {
+                    mark_full(level + 1, index);
+                    restart = true;
+                    break;
+                }
+                index = index * BITS + pick(free, path_bit(hint, level));
+            }
+            if(restart) {
+                continue;
+            }
+
+            auto& leaf = m_levels[0][index];
+            word w = leaf.load(std::memory_order_relaxed);
+            while(w != FULL) {
+                const std::size_t bit = pick(~w, path_bit(hint, 0));
+                if(leaf.compare_exchange_weak(w, w | (word(1) << bit), std::memory_order_acq_rel)) {
+                    if((w | (word(1) << bit)) == FULL) {
+                        mark_full(1, index);
+                    }
+                    // stay on this leaf word until it is full, other threads start on theirs
+                    tl_hint = index * BITS + (bit + 1) % BITS;
+                    return index * BITS + bit;
+                }
+            }
+
+            // a stale summary led to a full leaf, repair it before retrying
+            mark_full(1, index);
+        }
+    }
+
+    void release(std::size_t id) noexcept {
+        const word previous = m_levels[0][id / BITS].fetch_and(~(word(1) << (id % BITS)), std::memory_order_seq_cst);
+        if(previous == FULL) {
+            clear_full(1, id / BITS);
+        }
+    }
+
+    [[nodiscard]]
+    bool is_taken(std::size_t id) const noexcept {
+        return m_levels[0][id / BITS].load(std::memory_order_acquire) & (word(1) << (id % BITS));
+    }
+
+    [[nodiscard]]
+    std::size_t capacity() const noexcept {
+        return m_capacity;
+    }
+
+    // exact when no acquire or release is in flight
+    [[nodiscard]]
+    std::size_t size() const noexcept {
+        std::size_t taken = 0;
+        for(std::size_t i = 0; i < m_sizes[0]; ++i) {
+            taken += std::popcount(m_levels[0][i].load(std::memory_order_relaxed));
+        }
+        // minus the padding bits of the last leaf word
+        return taken - (m_sizes[0] * BITS - m_capacity);
+    }
+
+   private:
+    // the bit of the hinted leaf's path at the given level
+    static std::size_t path_bit(std::size_t hint, std::size_t level) noexcept {
+        for(std::size_t i = 0; i < level; ++i) {
+            hint /= BITS;
+        }
+        return hint % BITS;
+    }
+
+    // lowest free bit at or after preferred, wrapping around
+    static std::size_t pick(word free, std::size_t preferred) noexcept {
+        const word ahead = free & (FULL << preferred);
+        return std::countr_zero(ahead != 0 ? ahead : free);
+    }
+
+    // child `index` of `level` became full
+    void mark_full(std::size_t level, std::size_t index) noexcept {
+        for(; level < m_levels.size(); ++level, index /= BITS) {
+            auto& summary = m_levels[level][index / BITS];
+            const word bit = word(1) << (index % BITS);
+            const word previous = summary.fetch_or(bit, std::memory_order_seq_cst);
+
+            // a release may have slipped in before the bit was set, it cleared nothing then
+            if(m_levels[level - 1][index].load(std::memory_order_seq_cst) != FULL) {
+                summary.fetch_and(~bit, std::memory_order_seq_cst);
+                return;
+            }
+            if((previous | bit) != FULL || (previous & bit)) {
+                return;
+            }
+        }
+    }
+
+    // child `index` of `level` has a free id again
+    void clear_full(std::size_t level, std::size_t index) noexcept {
+        for(; level < m_levels.size(); ++level, index /= BITS) {
+            const word previous = m_levels[level][index / BITS].fetch_and(~(word(1) << (index % BITS)), std::memory_order_seq_cst);
+            if(previous != FULL) {
+                return;
+            }
+        }
+    }
+
+   private:
+    // a leaf word to start on per thread, spread by hashing the thread id
+    static std::size_t initial_hint() noexcept {
+        const std::uint64_t h = std::hash<std::thread::id>{}(std::this_thread::get_id()) * 0x9E3779B97F4A7C15ull;
+        return static_cast<std::size_t>(h >> 32) * BITS;
+    }
+
+    // one hint per thread shared by all allocators, it only steers where the search starts
+    inline static thread_local std::size_t tl_hint = initial_hint();
+
+    const std::size_t m_capacity;
+    // m_levels[0] holds the leaves, the last level a single word
+    std::vector<std::unique_ptr<std::atomic<word>[]>> m_levels;
+    std::vector<std::size_t> m_sizes;
+};
+
+}
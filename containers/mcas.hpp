@@ -0,0 +1,314 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <hazard_pointer.hpp>
+#include <optional>
+#include <span>
+
+namespace conc {
+
+// words one mcas can update together
+inline constexpr std::size_t MCAS_MAX_WORDS = 16;
+
+class mcas_word;
+
+// one word of an mcas: replaced by desired if every word of the operation holds its expected
+struct mcas_entry {
+    mcas_word* word;
+    std::uint64_t expected;
+    std::uint64_t desired;
+};
+
+namespace detail {
+
+// a word holds its value shifted left by two, the low bits mark a reference to an operation in
+// progress: MCAS_TAG while it owns the word, RDCSS_TAG while one of its entries is being installed;
+// both descriptors are aligned so their addresses keep the tag bits clear
+inline constexpr std::uint64_t MCAS_TAG = 1;
+inline constexpr std::uint64_t RDCSS_TAG = 2;
+inline constexpr std::uint64_t TAGS = MCAS_TAG | RDCSS_TAG;
+
+struct alignas(std::hardware_destructive_interference_size) mcas_descriptor {
+    static constexpr std::uint32_t UNDECIDED = 0;
+    static constexpr std::uint32_t SUCCEEDED = 1;
+    static constexpr std::uint32_t FAILED = 2;
+
+    struct entry {
+        std::atomic<std::uint64_t>* word;
+        std::uint64_t expected;
+        std::uint64_t desired;
+    };
+
+    std::atomic<std::uint32_t> status = UNDECIDED;
+    std::uint32_t count = 0;
+    std::array<entry, MCAS_MAX_WORDS> entries;
+};
+
+// one attempt to install an entry, allocated per attempt so that a word never holds the same
+// reference twice while somebody may still act on the first
+struct rdcss_descriptor {
+    mcas_descriptor* operation;
+    std::uint32_t index;
+};
+
+static_assert(alignof(mcas_descriptor) > TAGS && alignof(rdcss_descriptor) > TAGS, "descriptor addresses have to leave the tag bits clear");
+
+}
+
+// Word that can take part in an mcas. Values are limited to 62 bits, the remaining two tell a
+// value from a reference to an operation in progress; reading such a word helps that operation
+// finish first, so every read returns a value some linearization point gave the word.
+class mcas_word {
+   public:
+    static constexpr std::uint64_t MAX_VALUE = (std::uint64_t(1) << 62) - 1;
+
+    explicit mcas_word(std::uint64_t value = 0) noexcept : m_bits(value << 2) {}
+
+    mcas_word(mcas_word const&) = delete;
+    mcas_word(mcas_word&& other) = delete;
+    mcas_word& operator=(mcas_word const&) = delete;
+    mcas_word& operator=(mcas_word &&) = delete;
+
+   public:
+    std::uint64_t load() noexcept;
+
+    // single-word CAS that agrees with concurrent mcas operations; on failure expected gets
+    // the current value
+    bool compare_exchange(std::uint64_t& expected, std::uint64_t desired) noexcept;
+
+   private:
+    friend bool mcas(std::span<const mcas_entry> entries);
+    std::atomic<std::uint64_t> m_bits;
+};
+
+namespace detail {
+
+// Multi-word CAS of Harris, Fraser and Pratt ("A Practical Multi-Word Compare-and-Swap
+// Operation", DISC 2002). An operation is a descriptor holding every (word, expected, desired);
+// it installs a reference to itself in each word, in address order, through RDCSS, a CAS that
+// only sticks while the operation is still undecided. Once every word is installed, or one
+// held an unexpected value, a single CAS on the status decides it, and the words are then
+// released to their desired or expected values. Any thread that meets a reference helps the
+// operation to the end instead of waiting, so the whole is lock-free. Helpers protect a
+// descriptor with a hazard pointer before touching it and validate it is still referenced;
+// the owner retires it once it released its words, an installer its RDCSS descriptor once the
+// install completed. A helper hands the operation blocking the one it helps back instead of
+// helping it from inside, so a thread holds at most one cell of each domain at any time.
+class mcas_engine {
+   private:
+    using descriptor = mcas_descriptor;
+
+    // a reference met in a word
+    struct reference {
+        const std::atomic<std::uint64_t>* word;
+        std::uint64_t bits;
+    };
+
+   public:
+    // every thread holds at most one cell of each: 128 threads may use mcas words at once
+    using hazard_domain = conc::hazard_domain<descriptor, 128, mcas_engine>;
+    using hazard_pointer_t = hazard_pointer<descriptor, hazard_domain>;
+    using rdcss_hazard_domain = conc::hazard_domain<rdcss_descriptor, 128, mcas_engine>;
+    using rdcss_hazard_pointer_t = hazard_pointer<rdcss_descriptor, rdcss_hazard_domain>;
+
+    static bool is_value(std::uint64_t bits) noexcept {
+        return (bits & TAGS) == 0;
+    }
+
+    static std::uint64_t mcas_ref(descriptor* d) noexcept {
+        return reinterpret_cast<std::uintptr_t>(d) | MCAS_TAG;
+    }
+
+    static std::uint64_t rdcss_ref(rdcss_descriptor* r) noexcept {
+        return reinterpret_cast<std::uintptr_t>(r) | RDCSS_TAG;
+    }
+
+    static descriptor* descriptor_of(std::uint64_t bits) noexcept {
+        return reinterpret_cast<descriptor*>(static_cast<std::uintptr_t>(bits & ~TAGS));
+    }
+
+    static rdcss_descriptor* rdcss_of(std::uint64_t bits) noexcept {
+        return reinterpret_cast<rdcss_descriptor*>(static_cast<std::uintptr_t>(bits & ~TAGS));
+    }
+
+    // word holds the reference bits: protects the operation behind it and helps it along, then
+    // whatever operation turned out to block that one; the caller reloads the word afterwards
+    static void help_reference(const std::atomic<std::uint64_t>& word, std::uint64_t bits) noexcept {
+        auto hp = hazard_pointer_t::make_hazard_pointer();
+        reference next{&word, bits};
+        while(true) {
+            if(next.bits & RDCSS_TAG) {
+                auto hp_rdcss = rdcss_hazard_pointer_t::make_hazard_pointer();
+                rdcss_descriptor* r = rdcss_of(next.bits);
+                hp_rdcss.reset_protection(r);
+                // no longer referenced: the descriptor may be gone already, and the word has moved on
+                if(next.word->load(std::memory_order_seq_cst) != next.bits) {
+                    return;
+                }
+                // the installer keeps the operation alive for as long as the word references r
+                hp.reset_protection(r->operation);
+                if(next.word->load(std::memory_order_seq_cst) != next.bits) {
+                    return;
+                }
+                complete_install(r);
+                return;
+            }
+
+            descriptor* d = descriptor_of(next.bits);
+            hp.reset_protection(d);
+            if(next.word->load(std::memory_order_seq_cst) != next.bits) {
+                return;
+            }
+            auto blocker = run(d, false);
+            if(!blocker) {
+                return;
+            }
+            next = *blocker;
+        }
+    }
+
+    // the owner runs d to the end and releases its words, true when it succeeded
+    static bool help(descriptor* d) noexcept {
+        run(d, true);
+        return d->status.load(std::memory_order_acquire) == descriptor::SUCCEEDED;
+    }
+
+   private:
+    // drives d to a decision and releases its words; a helper other than the owner stops at the
+    // first word another install or operation holds and returns it, the owner helps it and retries
+    static std::optional<reference> run(descriptor* d, bool owner) noexcept {
+        if(d->status.load(std::memory_order_acquire) == descriptor::UNDECIDED) {
+            std::uint32_t outcome = descriptor::SUCCEEDED;
+            for(std::uint32_t i = 0; i < d->count && outcome == descriptor::SUCCEEDED; ++i) {
+                const auto& e = d->entries[i];
+                while(true) {
+                    const std::uint64_t bits = install(d, i);
+                    if(bits == e.expected || bits == mcas_ref(d)) {
+                        break;
+                    }
+                    if(is_value(bits)) {
+                        outcome = descriptor::FAILED;
+                        break;
+                    }
+                    if(!owner) {
+                        return reference{e.word, bits};
+                    }
+                    help_reference(*e.word, bits);
+                }
+            }
+            std::uint32_t undecided = descriptor::UNDECIDED;
+            d->status.compare_exchange_strong(undecided, outcome, std::memory_order_seq_cst, std::memory_order_acquire);
+        }
+
+        for(std::uint32_t i = 0; i < d->count; ++i) {
+            release(d, d->entries[i]);
+        }
+        return std::nullopt;
+    }
+
+    // RDCSS of entry i: swings the word from its expected value to a fresh install of d while d
+    // is undecided, returns what the word held; the expected value means installed, or d decided
+    static std::uint64_t install(descriptor* d, std::uint32_t i) noexcept {
+        auto& e = d->entries[i];
+        std::uint64_t bits = e.word->load(std::memory_order_acquire);
+        if(bits != e.expected) {
+            return bits;
+        }
+        auto* r = new rdcss_descriptor{d, i};
+        if(!e.word->compare_exchange_strong(bits, rdcss_ref(r), std::memory_order_seq_cst, std::memory_order_acquire)) {
+            delete r;
+            return bits;
+        }
+        complete_install(r);
+        rdcss_hazard_pointer_t::retire(r);
+        return e.expected;
+    }
+
+    static void complete_install(rdcss_descriptor* r) noexcept {
+        descriptor* d = r->operation;
+        const auto& e = d->entries[r->index];
+        const bool undecided = d->status.load(std::memory_order_seq_cst) == descriptor::UNDECIDED;
+        std::uint64_t bits = rdcss_ref(r);
+        if(e.word->compare_exchange_strong(bits, undecided ? mcas_ref(d) : e.expected, std::memory_order_seq_cst, std::memory_order_relaxed) && undecided) {
+            // d may have been decided and its words released in between, then nobody else
+            // would take this reference out again
+            release(d, e);
+        }
+    }
+
+    // no-op while d is undecided or once the word moved on
+    static void release(descriptor* d, const descriptor::entry& e) noexcept {
+        const std::uint32_t status = d->status.load(std::memory_order_seq_cst);
+        if(status == descriptor::UNDECIDED) {
+            return;
+        }
+        std::uint64_t bits = mcas_ref(d);
+        e.word->compare_exchange_strong(bits, status == descriptor::SUCCEEDED ? e.desired : e.expected, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+};
+
+}
+
+inline std::uint64_t mcas_word::load() noexcept {
+    while(true) {
+        const std::uint64_t bits = m_bits.load(std::memory_order_acquire);
+        if(detail::mcas_engine::is_value(bits)) [[likely]] {
+            return bits >> 2;
+        }
+        detail::mcas_engine::help_reference(m_bits, bits);
+    }
+}
+
+inline bool mcas_word::compare_exchange(std::uint64_t& expected, std::uint64_t desired) noexcept {
+    while(true) {
+        std::uint64_t bits = expected << 2;
+        if(m_bits.compare_exchange_strong(bits, desired << 2, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return true;
+        }
+        if(detail::mcas_engine::is_value(bits)) {
+            expected = bits >> 2;
+            return false;
+        }
+        detail::mcas_engine::help_reference(m_bits, bits);
+    }
+}
+
+// any thread: atomically replaces every word's expected value by its desired one, or changes
+// nothing and returns false when one of them differs. Values are at most mcas_word::MAX_VALUE,
+// a word may appear once, and at most MCAS_MAX_WORDS words take part; a call breaking one of
+// those returns false as well.
+inline bool mcas(std::span<const mcas_entry> entries) {
+    using engine = detail::mcas_engine;
+    if(entries.size() > MCAS_MAX_WORDS) [[unlikely]] {
+        return false;
+    }
+
+    auto* d = new detail::mcas_descriptor();
+    d->count = static_cast<std::uint32_t>(entries.size());
+    for(std::size_t i = 0; i < entries.size(); ++i) {
+        const auto& e = entries[i];
+        if(e.expected > mcas_word::MAX_VALUE || e.desired > mcas_word::MAX_VALUE) [[unlikely]] {
+            delete d;
+            return false;
+        }
+        d->entries[i] = {&e.word->m_bits, e.expected << 2, e.desired << 2};
+    }
+    // one global order of installation: two operations on common words cannot keep each other out
+    auto installed = std::span(d->entries.data(), d->count);
+    std::ranges::sort(installed, std::less<>{}, &detail::mcas_descriptor::entry::word);
+    if(std::ranges::adjacent_find(installed, {}, &detail::mcas_descriptor::entry::word) != installed.end()) [[unlikely]] {
+        delete d;
+        return false;
+    }
+
+    const bool succeeded = engine::help(d);
+    engine::hazard_pointer_t::retire(d);
+    return succeeded;
+}
+
+}
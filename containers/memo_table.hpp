@@ -0,0 +1,290 @@
+#pragma once
+
+#include "domain.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <hazard_pointer.hpp>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+namespace conc {
+
+// Compute-once table: the first caller that misses on a key publishes a pending entry and runs
+// the computation, concurrent callers for the same key park on the entry state (atomic::wait)
+// and receive the same result or exception. Buckets hold immutable chains replaced by CAS, so
+// completed entries are found without locks; chains and entries are reclaimed with hazard pointers.
+template<typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+requires(std::is_copy_constructible_v<V> &&
+         std::is_nothrow_destructible_v<K> && std::is_nothrow_destructible_v<V>)
+class memo_table {
+   private:
+    static constexpr std::uint32_t PENDING = 0;
+    static constexpr std::uint32_t READY = 1;
+    static constexpr std::uint32_t FAILED = 2;
+
+    struct entry {
+        entry(std::size_t h, const K& k) : hash(h), key(k) {}
+
+        const std::size_t hash;
+        const K key;
+        std::atomic<std::uint32_t> state = PENDING;
+        // written once by the computing thread before state leaves PENDING
+        std::optional<V> value;
+        std::exception_ptr error;
+    };
+
+    // hashes are kept next to the pointers so that probing a chain touches no foreign entry
+    struct slot {
+        std::size_t hash;
+        entry* e;
+    };
+
+    struct chain {
+        std::vector<slot> entries;
+    };
+
+   public:
+    // waiters keep their entry protected while parked, size the domains for the expected herd
+    using entry_domain = conc::hazard_domain<entry, 256, memo_table<K, V, Hash, KeyEqual>>;
+    using chain_domain = conc::hazard_domain<chain, 256, memo_table<K, V, Hash, KeyEqual>>;
+
+   private:
+    using entry_hazard_pointer = hazard_pointer<entry, entry_domain>;
+    using chain_hazard_pointer = hazard_pointer<chain, chain_domain>;
+
+   public:
+    explicit memo_table(std::size_t buckets = 1024) :
+        m_mask(std::bit_ceil(std::max<std::size_t>(buckets, 1)) - 1),
+        m_buckets(std::make_unique<std::atomic<chain*>[]>(m_mask + 1)) {}
+
+    memo_table(memo_table const&) = delete;
+    memo_table(memo_table&& other) = delete;
+    memo_table& operator=(memo_table const&) = delete;
+    memo_table& operator=(memo_table &&) = delete;
+
+    //not thread-safe
+    ~memo_table() {
+        for(std::size_t i = 0; i <= m_mask; ++i) {
+            if(chain* c = m_buckets[i].load(std::memory_order_relaxed)) {
+                for(const slot& s : c->entries) {
+                    delete s.e;
+                }
+                delete c;
+            }
+        }
+        entry_domain().delete_hazards();
+        chain_domain().delete_hazards();
+    }
+
+   public:
+    // returns the memoized value of key, computing it with fn() on the first call;
+    // if fn throws, every caller waiting for that computation rethrows and the key is forgotten
+    template<typename F>
+    requires(std::is_invocable_r_v<V, F&>)
+    V get_or_compute(const K& key, F&& fn) {
+        const std::size_t h = hash(key);
+        auto hp = entry_hazard_pointer::make_hazard_pointer();
+
+        bool owner = false;
+        entry* e = acquire(h, key, hp, owner);
+
+        if(owner) {
+            try {
+                e->value.emplace(std::invoke(fn));
+            } catch(...) {
+                e->error = std::current_exception();
+                publish(e, FAILED);
+                remove(h, e);
+                throw;
+            }
+            publish(e, READY);
+            return *e->value;
+        }
+
+        std::uint32_t state = e->state.load(std::memory_order_acquire);
+        while(state == PENDING) {
+            e->state.wait(PENDING, std::memory_order_acquire);
+            state = e->state.load(std::memory_order_acquire);
+        }
+
+        if(state == FAILED) {
+            std::rethrow_exception(e->error);
+        }
+        return *e->value;
+    }
+
+    // completed values only, never waits for a computation in flight
+    std::optional<V> find(const K& key) const {
+        const std::size_t h = hash(key);
+        auto chp = chain_hazard_pointer::make_hazard_pointer();
+        auto hp = entry_hazard_pointer::make_hazard_pointer();
+
+        bool stale = true;
+        const entry* e = nullptr;
+        while(stale) {
+            e = lookup(chp.protect(m_buckets[h & m_mask]), hp, h, key, stale);
+        }
+
+        if(e == nullptr || e->state.load(std::memory_order_acquire) != READY) {
+            return std::nullopt;
+        }
+        return *e->value;
+    }
+
+    bool contains(const K& key) const {
+        return find(key).has_value();
+    }
+
+    // forgets a completed value so that the next get_or_compute recomputes it
+    bool erase(const K& key) {
+        const std::size_t h = hash(key);
+        auto chp = chain_hazard_pointer::make_hazard_pointer();
+        auto hp = entry_hazard_pointer::make_hazard_pointer();
+        while(true) {
+            bool stale = false;
+            chain* c = chp.protect(m_buckets[h & m_mask]);
+            entry* e = lookup(c, hp, h, key, stale);
+            if(stale) {
+                continue;
+            }
+            if(e == nullptr || e->state.load(std::memory_order_acquire) == PENDING) {
+                return false;
+            }
+            if(replace(h, c, e, nullptr)) {
+                return true;
+            }
+        }
+    }
+
+    std::size_t size() const {
+        std::size_t total = 0;
+        auto hp = chain_hazard_pointer::make_hazard_pointer();
+        for(std::size_t i = 0; i <= m_mask; ++i) {
+            if(const chain* c = hp.protect(m_buckets[i])) {
+                total += c->entries.size();
+            }
+        }
+        return total;
+    }
+
+   private:
+    std::size_t hash(const K& key) const {
+        return static_cast<std::size_t>(m_hash(key)) * 0x9E3779B97F4A7C15ull >> 16;
+    }
+
+    // searches the protected chain c and protects the entry of key with hp; stale is set when
+    // the chain was replaced before the entry could be protected and the lookup has to be retried
+    entry* lookup(const chain* c, entry_hazard_pointer& hp, std::size_t h, const K& key, bool& stale) const {
+        stale = false;
+        if(c == nullptr) {
+            return nullptr;
+        }
+
+        for(const slot& s : c->entries) {
+            if(s.hash != h) {
+                continue;
+            }
+            hp.reset_protection(s.e);
+            // a removed entry is retired right after its chain is replaced, so the chain
+            // protection alone does not keep it alive
+            [[unlikely]]
+            if(m_buckets[h & m_mask].load() != c) {
+                stale = true;
+                return nullptr;
+            }
+            if(m_equal(s.e->key, key)) {
+                return s.e;
+            }
+        }
+        return nullptr;
+    }
+
+    // finds the entry of key or publishes a pending one, which the caller then has to complete;
+    // on return the entry is protected by hp
+    entry* acquire(std::size_t h, const K& key, entry_hazard_pointer& hp, bool& owner) {
+        auto chp = chain_hazard_pointer::make_hazard_pointer();
+        std::unique_ptr<entry> fresh;
+
+        while(true) {
+            bool stale = false;
+            chain* c = chp.protect(m_buckets[h & m_mask]);
+            if(entry* e = lookup(c, hp, h, key, stale)) {
+                return e;
+            }
+            if(stale) {
+                continue;
+            }
+
+            if(!fresh) {
+                fresh = std::make_unique<entry>(h, key);
+            }
+            hp.reset_protection(fresh.get());
+            if(replace(h, c, nullptr, fresh.get())) {
+                owner = true;
+                return fresh.release();
+            }
+        }
+    }
+
+    // swaps the bucket chain for a copy without `removed` and with `added`, fails if the chain changed
+    bool replace(std::size_t h, chain* c, entry* removed, entry* added) {
+        auto next = std::make_unique<chain>();
+        if(c != nullptr) {
+            next->entries.reserve(c->entries.size() + 1);
+            std::copy_if(c->entries.begin(), c->entries.end(), std::back_inserter(next->entries),
+                [removed](const slot& s) { return s.e != removed; });
+        }
+        if(added != nullptr) {
+            next->entries.push_back(slot{h, added});
+        }
+
+        chain* desired = next->entries.empty() ? nullptr : next.get();
+        if(!m_buckets[h & m_mask].compare_exchange_strong(c, desired, std::memory_order_seq_cst)) {
+            return false;
+        }
+
+        if(desired != nullptr) {
+            next.release();
+        }
+        if(c != nullptr) {
+            chain_hazard_pointer::retire(c);
+        }
+        if(removed != nullptr) {
+            entry_hazard_pointer::retire(removed);
+        }
+        return true;
+    }
+
+    void remove(std::size_t h, entry* e) {
+        auto chp = chain_hazard_pointer::make_hazard_pointer();
+        while(true) {
+            chain* c = chp.protect(m_buckets[h & m_mask]);
+            if(c == nullptr || std::none_of(c->entries.begin(), c->entries.end(), [e](const slot& s) { return s.e == e; })) {
+                return;
+            }
+            if(replace(h, c, e, nullptr)) {
+                return;
+            }
+        }
+    }
+
+    static void publish(entry* e, std::uint32_t state) noexcept {
+        e->state.store(state, std::memory_order_release);
+        e->state.notify_all();
+    }
+
+   private:
+    const std::size_t m_mask;
+    std::unique_ptr<std::atomic<chain*>[]> m_buckets;
+    [[no_unique_address]] Hash m_hash;
+    [[no_unique_address]] KeyEqual m_equal;
+};
+
+}
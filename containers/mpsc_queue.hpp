@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <concepts>
+
+namespace conc {
+
+// link embedded in the elements of an intrusive_mpsc_queue
+struct mpsc_node {
+    std::atomic<mpsc_node*> next = nullptr;
+};
+
+// Vyukov's intrusive non-blocking MPSC queue: a push is one exchange on the tail and a store, a
+// pop touches no shared cache line while elements are available. The queue never allocates, the
+// elements carry their link. A producer stalled between its exchange and its store hides the
+// elements behind it until it resumes, pop then returns nullptr although empty() is false.
+template<typename T>
+requires(std::derived_from<T, mpsc_node>)
+class intrusive_mpsc_queue {
+   public:
+    intrusive_mpsc_queue() noexcept = default;
+    intrusive_mpsc_queue(intrusive_mpsc_queue const&) = delete;
+    intrusive_mpsc_queue(intrusive_mpsc_queue&& other) = delete;
+    intrusive_mpsc_queue& operator=(intrusive_mpsc_queue const&) = delete;
+    intrusive_mpsc_queue& operator=(intrusive_mpsc_queue &&) = delete;
+
+   public:
+    // any thread; seq_cst so callers can pair the push with a flag check
+    void push(T* element) noexcept {
+        insert(element);
+    }
+
+    // consumer only, ownership of the element goes back to the caller
+    T* pop() noexcept {
+        mpsc_node* head = m_head;
+        mpsc_node* next = head->next.load(std::memory_order_acquire);
+        if(head == &m_stub) {
+            if(next == nullptr) {
+                return nullptr;
+            }
+            m_head = next;
+            head = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if(next != nullptr) {
+            m_head = next;
+            return static_cast<T*>(head);
+        }
+
+        // head is the last element linked so far, a producer may be in the middle of a push
+        if(head != m_tail.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        // park the stub behind the last element so that it can be handed out
+        insert(&m_stub);
+        next = head->next.load(std::memory_order_acquire);
+        if(next != nullptr) {
+            m_head = next;
+            return static_cast<T*>(head);
+        }
+        return nullptr;
+    }
+
+    // consumer only; seq_cst, true while a push is in progress too
+    [[nodiscard]]
+    bool empty() const noexcept {
+        return m_head == &m_stub && m_tail.load(std::memory_order_seq_cst) == &m_stub;
+    }
+
+    // any thread: the stub is the last node. Checked after the consumer saw its head at the stub
+    // this means nothing was pushed since, without touching consumer state, which lets an owner
+    // decide whether a consumer that just went idle needs to be resumed
+    [[nodiscard]]
+    bool drained() const noexcept {
+        return m_tail.load(std::memory_order_seq_cst) == &m_stub;
+    }
+
+    // consumer only
+    [[nodiscard]]
+    bool head_is_stub() const noexcept {
+        return m_head == &m_stub;
+    }
+
+   private:
+    void insert(mpsc_node* node) noexcept {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        mpsc_node* previous = m_tail.exchange(node, std::memory_order_seq_cst);
+        // from here until the store, elements behind node are invisible to pop
+        previous->next.store(node, std::memory_order_release);
+    }
+
+   private:
+    std::atomic<mpsc_node*> m_tail = &m_stub;
+    // consumer-owned
+    mpsc_node* m_head = &m_stub;
+    mpsc_node m_stub;
+};
+
+}
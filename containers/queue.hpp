@@ -4,6 +4,7 @@
 #include <atomic>
 #include <optional>
 #include <hazard_pointer.hpp>
+#include <parking_lot.hpp>
 #include <chrono>
 #include <thread>
 
@@ -19,7 +20,12 @@ class queue {
     };
 
    public:
-    using hazard_domain = conc::hazard_domain<node, 32, node>;
+    // an enqueue holds one cell and a dequeue two, and every queue<T> draws from the same cells:
+    // at most MAX_CONCURRENT_OPERATIONS threads may be inside enqueue or dequeue of some queue<T>
+    // at once, running out of cells is undefined behaviour
+    static constexpr std::size_t HAZARD_CELLS = 128;
+    static constexpr std::size_t MAX_CONCURRENT_OPERATIONS = HAZARD_CELLS / 2;
+    using hazard_domain = conc::hazard_domain<node, HAZARD_CELLS, node>;
 
    private:
     using hazard_pointer_t = hazard_pointer<node, hazard_domain>;
@@ -70,6 +76,15 @@ class queue {
         }
 
         m_tail.compare_exchange_strong(curr_tail, new_node);
+
+        // the linking CAS is seq_cst: either a parking consumer sees the node or we see its flag
+        if(m_has_waiters.load(std::memory_order_seq_cst)) [[unlikely]] {
+            parking_lot::unpark_one(&m_head, [this](unpark_result result) noexcept {
+                if(!result.have_more) {
+                    m_has_waiters.store(false, std::memory_order_relaxed);
+                }
+            });
+        }
         return;
     }
 
@@ -93,9 +108,24 @@ class queue {
         }
     }
 
+    // blocks on the parking lot while the queue is empty
+    T dequeue_wait() {
+        while(true) {
+            if(auto result = dequeue()) {
+                return std::move(*result);
+            }
+            parking_lot::park(&m_head, [this]() {
+                m_has_waiters.store(true, std::memory_order_seq_cst);
+                auto hp = hazard_pointer_t::make_hazard_pointer();
+                return hp.protect(m_head)->next.load(std::memory_order_seq_cst) == nullptr;
+            });
+        }
+    }
+
    private:
     std::atomic<node*> m_tail;
     std::atomic<node*> m_head;
+    std::atomic<bool> m_has_waiters = false;
 };
 
 }
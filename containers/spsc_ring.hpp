@@ -0,0 +1,177 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <optional>
+#include <parking_lot.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace conc {
+
+// Bounded single-producer single-consumer ring (Lamport, with the index caching of Rigtorp's
+// SPSCQueue): head and tail live on their own cache lines and each side keeps a private copy of
+// the other side's index, so the shared lines are only read when the cached view says the ring
+// is full or empty. Batch operations publish the index once per batch. The consumer can block in
+// pop_wait on the parking lot.
+template<typename T>
+requires(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_destructible_v<T>)
+class spsc_ring {
+   private:
+    struct slot {
+        alignas(T) std::byte storage[sizeof(T)];
+
+        T* get() noexcept {
+            return std::launder(reinterpret_cast<T*>(storage));
+        }
+    };
+
+   public:
+    // capacity is rounded up to a power of two
+    explicit spsc_ring(std::size_t capacity)
+        : m_mask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1),
+          m_slots(std::make_unique<slot[]>(m_mask + 1)) {}
+
+    spsc_ring(spsc_ring const&) = delete;
+    spsc_ring(spsc_ring&& other) = delete;
+    spsc_ring& operator=(spsc_ring const&) = delete;
+    spsc_ring& operator=(spsc_ring &&) = delete;
+
+    //not thread-safe
+    ~spsc_ring() {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        for(std::size_t i = m_head.load(std::memory_order_relaxed); i != tail; ++i) {
+            std::destroy_at(m_slots[i & m_mask].get());
+        }
+    }
+
+   public:
+    // producer only
+    [[nodiscard]]
+    bool try_push(T&& element) noexcept {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if(tail - m_cached_head == capacity()) {
+            m_cached_head = m_head.load(std::memory_order_acquire);
+            if(tail - m_cached_head == capacity()) {
+                return false;
+            }
+        }
+        std::construct_at(m_slots[tail & m_mask].get(), std::move(element));
+        publish(tail + 1);
+        return true;
+    }
+
+    // producer only: moves elements from [first, last) until the ring is full, publishing them
+    // at once; returns how many were taken
+    template<typename It>
+    std::size_t push_batch(It first, It last) noexcept {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        const std::size_t wanted = static_cast<std::size_t>(std::distance(first, last));
+        if(capacity() - (tail - m_cached_head) < wanted) {
+            m_cached_head = m_head.load(std::memory_order_acquire);
+        }
+        const std::size_t count = std::min(wanted, capacity() - (tail - m_cached_head));
+        for(std::size_t i = 0; i < count; ++i, ++first) {
+            std::construct_at(m_slots[(tail + i) & m_mask].get(), std::move(*first));
+        }
+        if(count != 0) {
+            publish(tail + count);
+        }
+        return count;
+    }
+
+    // consumer only
+    std::optional<T> try_pop() noexcept {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if(head == m_cached_tail) {
+            m_cached_tail = m_tail.load(std::memory_order_acquire);
+            if(head == m_cached_tail) {
+                return std::nullopt;
+            }
+        }
+        T* element = m_slots[head & m_mask].get();
+        std::optional<T> result(std::move(*element));
+        std::destroy_at(element);
+        m_head.store(head + 1, std::memory_order_release);
+        return result;
+    }
+
+    // consumer only: hands up to `max` elements to consume(T&&), freeing their slots at once;
+    // returns how many were consumed
+    template<typename F>
+    requires(std::is_nothrow_invocable_v<F&, T&&>)
+    std::size_t pop_batch(std::size_t max, F&& consume) noexcept {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if(m_cached_tail - head < max) {
+            m_cached_tail = m_tail.load(std::memory_order_acquire);
+        }
+        const std::size_t count = std::min(max, m_cached_tail - head);
+        for(std::size_t i = 0; i < count; ++i) {
+            T* element = m_slots[(head + i) & m_mask].get();
+            consume(std::move(*element));
+            std::destroy_at(element);
+        }
+        if(count != 0) {
+            m_head.store(head + count, std::memory_order_release);
+        }
+        return count;
+    }
+
+    // consumer only: blocks until an element arrives
+    T pop_wait() noexcept {
+        while(true) {
+            if(auto result = try_pop()) {
+                return std::move(*result);
+            }
+            parking_lot::park(&m_tail, [this]() noexcept {
+                m_has_waiters.store(true, std::memory_order_seq_cst);
+                return m_tail.load(std::memory_order_seq_cst) == m_head.load(std::memory_order_relaxed);
+            });
+        }
+    }
+
+    [[nodiscard]]
+    std::size_t capacity() const noexcept {
+        return m_mask + 1;
+    }
+
+    // exact from either side when the other one is idle, approximate otherwise
+    [[nodiscard]]
+    std::size_t size() const noexcept {
+        const std::size_t head = m_head.load(std::memory_order_acquire);
+        return m_tail.load(std::memory_order_acquire) - head;
+    }
+
+   private:
+    void publish(std::size_t tail) noexcept {
+        // seq_cst: either a parking consumer sees the new tail or we see its waiter flag
+        m_tail.store(tail, std::memory_order_seq_cst);
+        if(m_has_waiters.load(std::memory_order_seq_cst)) [[unlikely]] {
+            parking_lot::unpark_one(&m_tail, [this](unpark_result) noexcept {
+                m_has_waiters.store(false, std::memory_order_relaxed);
+            });
+        }
+    }
+
+   private:
+    const std::size_t m_mask;
+    const std::unique_ptr<slot[]> m_slots;
+
+    // consumer side
+    alignas(std::hardware_destructive_interference_size)
+    std::atomic<std::size_t> m_head = 0;
+    std::size_t m_cached_tail = 0;
+
+    // producer side
+    alignas(std::hardware_destructive_interference_size)
+    std::atomic<std::size_t> m_tail = 0;
+    std::size_t m_cached_head = 0;
+    std::atomic<bool> m_has_waiters = false;
+};
+
+}
@@ -4,6 +4,7 @@
 #include <atomic>
 #include <optional>
 #include <hazard_pointer.hpp>
+#include <parking_lot.hpp>
 #include <type_traits>
 
 namespace conc {
@@ -18,7 +19,10 @@ class stack {
     };
 
    public:
-    using hazard_domain = conc::hazard_domain<node, 32, stack<T>>;
+    // a pop holds one cell and every stack<T> draws from the same cells: at most HAZARD_CELLS
+    // threads may be inside pop of some stack<T> at once
+    static constexpr std::size_t HAZARD_CELLS = 32;
+    using hazard_domain = conc::hazard_domain<node, HAZARD_CELLS, stack<T>>;
 
     stack() = default;
     stack(stack const&) = delete;
@@ -44,8 +48,16 @@ class stack {
         };
 
         to_push->previous = m_head.load(std::memory_order_acquire);
-        while(!m_head.compare_exchange_weak(to_push->previous, to_push, std::memory_order_release));
-
+        // seq_cst: either a parking popper sees the new head or we see its waiter flag
+        while(!m_head.compare_exchange_weak(to_push->previous, to_push, std::memory_order_seq_cst, std::memory_order_acquire));
+
+        if(m_has_waiters.load(std::memory_order_seq_cst)) [[unlikely]] {
+            parking_lot::unpark_one(&m_head, [this](unpark_result result) noexcept {
+                if(!result.have_more) {
+                    m_has_waiters.store(false, std::memory_order_relaxed);
+                }
+            });
+        }
         return;
     }
 
@@ -71,8 +83,22 @@ class stack {
         return result;
     }
 
+    // blocks on the parking lot while the stack is empty
+    T pop_wait() {
+        while(true) {
+            if(auto result = pop()) {
+                return std::move(*result);
+            }
+            parking_lot::park(&m_head, [this]() noexcept {
+                m_has_waiters.store(true, std::memory_order_seq_cst);
+                return m_head.load(std::memory_order_seq_cst) == nullptr;
+            });
+        }
+    }
+
    private:
     std::atomic<node*> m_head = nullptr;
+    std::atomic<bool> m_has_waiters = false;
 };
 
 }
@@ -0,0 +1,118 @@
+#include <benchmark/benchmark.h>
+#include "queue.hpp"
+#include "stack.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+// stack push/pop and queue enqueue/dequeue under a sweep of thread counts, element sizes and
+// operation mixes: the argument is the share of pushes in percent, the rest are pops on a
+// structure prefilled so that pops rarely find it empty. ops/s is the total over all threads,
+// ops/s/thr the average of one thread. Thread counts go up to twice the hardware threads but stop
+// at what the hazard domain serves: a pop holds one of the stack's 32 cells, an enqueue one and a
+// dequeue two of the queue's 128, so the stack sweep stops at 32 threads and the queue's at 64.
+
+namespace {
+
+constexpr std::size_t PREFILL = 1 << 12;
+
+template<std::size_t N>
+struct payload {
+    std::array<std::uint64_t, N / 8> words{};
+};
+
+template<std::size_t MAX_THREADS>
+void sweep(benchmark::internal::Benchmark* b) {
+    const int hardware = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    for (int mix : {10, 50, 90}) {
+        b->Arg(mix);
+    }
+    const int limit = std::min(hardware * 2, static_cast<int>(MAX_THREADS));
+    for (int n = 1; n < hardware && n < limit; n *= 2) {
+        b->Threads(n);
+    }
+    b->Threads(std::min(hardware, limit));
+    if (hardware * 2 <= limit) {
+        b->Threads(hardware * 2);
+    }
+    b->UseRealTime();
+}
+
+// xorshift: the mix must not cost more than the operations it picks
+struct mix_picker {
+    explicit mix_picker(int thread, int percent) noexcept : m_state(0x9E3779B97F4A7C15ull * (thread + 1)), m_threshold(static_cast<std::uint64_t>(percent) * 0x10000 / 100) {}
+
+    bool push() noexcept {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 7;
+        m_state ^= m_state << 17;
+        return (m_state & 0xFFFF) < m_threshold;
+    }
+
+    std::uint64_t m_state;
+    const std::uint64_t m_threshold;
+};
+
+void report(benchmark::State& state) {
+    const auto ops = static_cast<double>(state.iterations());
+    state.counters["ops/s"] = benchmark::Counter(ops, benchmark::Counter::kIsRate);
+    state.counters["ops/s/thr"] = benchmark::Counter(ops, benchmark::Counter::kAvgThreadsRate);
+}
+
+template<typename T>
+void bm_stack(benchmark::State& state) {
+    static std::unique_ptr<conc::stack<T>> s;
+    if (state.thread_index() == 0) {
+        s = std::make_unique<conc::stack<T>>();
+        for (std::size_t i = 0; i < PREFILL; ++i) {
+            s->push(T{});
+        }
+    }
+    mix_picker mix(state.thread_index(), static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        if (mix.push()) {
+            s->push(T{});
+        } else {
+            benchmark::DoNotOptimize(s->pop());
+        }
+    }
+    report(state);
+    if (state.thread_index() == 0) {
+        s.reset();
+    }
+}
+
+template<typename T>
+void bm_queue(benchmark::State& state) {
+    static std::unique_ptr<conc::queue<T>> q;
+    if (state.thread_index() == 0) {
+        q = std::make_unique<conc::queue<T>>();
+        for (std::size_t i = 0; i < PREFILL; ++i) {
+            q->enqueue(T{});
+        }
+    }
+    mix_picker mix(state.thread_index(), static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        if (mix.push()) {
+            q->enqueue(T{});
+        } else {
+            benchmark::DoNotOptimize(q->dequeue());
+        }
+    }
+    report(state);
+    if (state.thread_index() == 0) {
+        q.reset();
+    }
+}
+
+}
+
+BENCHMARK_TEMPLATE(bm_stack, payload<8>)->Apply(sweep<conc::stack<payload<8>>::HAZARD_CELLS>);
+BENCHMARK_TEMPLATE(bm_stack, payload<64>)->Apply(sweep<conc::stack<payload<64>>::HAZARD_CELLS>);
+BENCHMARK_TEMPLATE(bm_stack, payload<256>)->Apply(sweep<conc::stack<payload<256>>::HAZARD_CELLS>);
+BENCHMARK_TEMPLATE(bm_queue, payload<8>)->Apply(sweep<conc::queue<payload<8>>::MAX_CONCURRENT_OPERATIONS>);
+BENCHMARK_TEMPLATE(bm_queue, payload<64>)->Apply(sweep<conc::queue<payload<64>>::MAX_CONCURRENT_OPERATIONS>);
+BENCHMARK_TEMPLATE(bm_queue, payload<256>)->Apply(sweep<conc::queue<payload<256>>::MAX_CONCURRENT_OPERATIONS>);
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include "mcas.hpp"
+#include <spin_lock.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Throughput of k-word atomic updates over a shared array of words: every thread increments k
+// distinct random words at once, either with one mcas or by taking a ttas lock per word in
+// address order; the table reports million updates per second.
+
+namespace {
+
+constexpr auto DURATION = std::chrono::milliseconds(200);
+constexpr std::size_t WORDS = 64;
+
+std::vector<unsigned> thread_counts() {
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> counts;
+    for (unsigned n = 1; n < hardware; n *= 2) {
+        counts.push_back(n);
+    }
+    counts.push_back(hardware);
+    counts.push_back(hardware * 2);
+    return counts;
+}
+
+// k distinct indices in increasing order
+void pick(std::mt19937& rng, std::size_t k, std::array<std::size_t, WORDS>& order) {
+    for (std::size_t i = 0; i < k; ++i) {
+        std::swap(order[i], order[i + rng() % (WORDS - i)]);
+    }
+    std::sort(order.begin(), order.begin() + k);
+}
+
+template<typename Update>
+double run(unsigned num_threads, std::size_t k, Update&& update) {
+    std::atomic<bool> start{false};
+    std::atomic<bool> stop{false};
+    std::atomic<std::uint64_t> total{0};
+    std::vector<std::thread> threads;
+
+    for (unsigned t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            std::mt19937 rng(t);
+            std::array<std::size_t, WORDS> order;
+            std::iota(order.begin(), order.end(), 0);
+            while (!start.load(std::memory_order_acquire)) {}
+            std::uint64_t ops = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                pick(rng, k, order);
+                update(std::span(order.data(), k));
+                ++ops;
+            }
+            total.fetch_add(ops);
+        });
+    }
+
+    start.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(DURATION);
+    stop.store(true);
+    for (auto& t : threads) {
+        t.join();
+    }
+    return static_cast<double>(total.load()) / std::chrono::duration<double>(DURATION).count() / 1e6;
+}
+
+double mcas_throughput(unsigned num_threads, std::size_t k) {
+    std::array<conc::mcas_word, WORDS> words;
+    const double mops = run(num_threads, k, [&](std::span<const std::size_t> indices) {
+        std::array<conc::mcas_entry, conc::MCAS_MAX_WORDS> entries;
+        do {
+            for (std::size_t i = 0; i < indices.size(); ++i) {
+                const std::uint64_t v = words[indices[i]].load();
+                entries[i] = {&words[indices[i]], v, v + 1};
+            }
+        } while (!conc::mcas(std::span(entries.data(), indices.size())));
+    });
+    std::uint64_t sum = 0;
+    for (auto& w : words) {
+        sum += w.load();
+    }
+    EXPECT_EQ(sum % k, 0u);
+    return mops;
+}
+
+double lock_throughput(unsigned num_threads, std::size_t k) {
+    struct alignas(std::hardware_destructive_interference_size) slot {
+        conc::ttas_lock lock;
+        std::uint64_t value = 0;
+    };
+    std::array<slot, WORDS> words;
+    const double mops = run(num_threads, k, [&](std::span<const std::size_t> indices) {
+        for (std::size_t i : indices) {
+            words[i].lock.lock();
+        }
+        for (std::size_t i : indices) {
+            ++words[i].value;
+        }
+        for (std::size_t i : indices) {
+            words[i].lock.unlock();
+        }
+    });
+    std::uint64_t sum = 0;
+    for (auto& w : words) {
+        sum += w.value;
+    }
+    EXPECT_EQ(sum % k, 0u);
+    return mops;
+}
+
+}
+
+TEST(McasBench, ThroughputMatrix) {
+    const auto counts = thread_counts();
+    std::printf("%-12s%-6s", "Mops/s", "words");
+    for (unsigned n : counts) {
+        std::printf("%7u thr", n);
+    }
+    std::printf("\n");
+
+    for (std::size_t k : {2u, 4u, 8u}) {
+        std::printf("%-12s%-6zu", "mcas", k);
+        for (unsigned n : counts) {
+            std::printf("%10.2f", mcas_throughput(n, k));
+        }
+        std::printf("\n%-12s%-6zu", "ttas/word", k);
+        for (unsigned n : counts) {
+            std::printf("%10.2f", lock_throughput(n, k));
+        }
+        std::printf("\n");
+    }
+}
@@ -0,0 +1,271 @@
+#include <gtest/gtest.h>
+#include "adaptive_radix_tree.hpp"
+
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <string>
+#include <random>
+
+using namespace conc;
+
+class AdaptiveRadixTreeTest : public ::testing::Test {
+protected:
+    static std::string key_of(int i) {
+        // big-endian so that neighbouring keys share long prefixes
+        std::string key(4, '\0');
+        for (int b = 3; b >= 0; --b) {
+            key[b] = static_cast<char>(i & 0xFF);
+            i >>= 8;
+        }
+        return key;
+    }
+};
+
+TEST_F(AdaptiveRadixTreeTest, EmptyTreeFind) {
+    adaptive_radix_tree<int> tree;
+    EXPECT_FALSE(tree.find("missing").has_value());
+    EXPECT_FALSE(tree.erase("missing"));
+}
+
+TEST_F(AdaptiveRadixTreeTest, InsertFindErase) {
+    adaptive_radix_tree<int> tree;
+    EXPECT_TRUE(tree.insert("hello", 1));
+    EXPECT_TRUE(tree.insert("world", 2));
+    EXPECT_FALSE(tree.insert("hello", 3));
+
+    EXPECT_EQ(tree.find("hello"), 1);
+    EXPECT_EQ(tree.find("world"), 2);
+    EXPECT_FALSE(tree.find("hell").has_value());
+    EXPECT_FALSE(tree.find("helloo").has_value());
+
+    EXPECT_TRUE(tree.erase("hello"));
+    EXPECT_FALSE(tree.erase("hello"));
+    EXPECT_FALSE(tree.contains("hello"));
+    EXPECT_TRUE(tree.contains("world"));
+}
+
+TEST_F(AdaptiveRadixTreeTest, InsertOrAssign) {
+    adaptive_radix_tree<std::string> tree;
+    EXPECT_TRUE(tree.insert_or_assign("key", "first"));
+    EXPECT_FALSE(tree.insert_or_assign("key", "second"));
+    EXPECT_EQ(tree.find("key"), "second");
+}
+
+TEST_F(AdaptiveRadixTreeTest, KeysThatArePrefixesOfEachOther) {
+    adaptive_radix_tree<int> tree;
+    std::vector<std::string> keys = {"", "a", "ab", "abc", "abcd", "abd", "b"};
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        EXPECT_TRUE(tree.insert(keys[i], static_cast<int>(i)));
+    }
+
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        EXPECT_EQ(tree.find(keys[i]), static_cast<int>(i)) << "key '" << keys[i] << "'";
+    }
+
+    EXPECT_TRUE(tree.erase("ab"));
+    EXPECT_FALSE(tree.contains("ab"));
+    EXPECT_EQ(tree.find("abc"), 3);
+    EXPECT_EQ(tree.find("a"), 1);
+}
+
+TEST_F(AdaptiveRadixTreeTest, PathCompressionSplit) {
+    adaptive_radix_tree<int> tree;
+    EXPECT_TRUE(tree.insert("compression_long_prefix_1", 1));
+    EXPECT_TRUE(tree.insert("compression_long_prefix_2", 2));
+    EXPECT_TRUE(tree.insert("compression_short", 3));
+    EXPECT_TRUE(tree.insert("comp", 4));
+    EXPECT_TRUE(tree.insert("c", 5));
+
+    EXPECT_EQ(tree.find("compression_long_prefix_1"), 1);
+    EXPECT_EQ(tree.find("compression_long_prefix_2"), 2);
+    EXPECT_EQ(tree.find("compression_short"), 3);
+    EXPECT_EQ(tree.find("comp"), 4);
+    EXPECT_EQ(tree.find("c"), 5);
+    EXPECT_FALSE(tree.contains("compression_long"));
+}
+
+TEST_F(AdaptiveRadixTreeTest, BinaryKeysWithZeroBytes) {
+    adaptive_radix_tree<int> tree;
+    std::string a("\0\0\1", 3), b("\0\0", 2), c("\0\1\0", 3);
+    EXPECT_TRUE(tree.insert(a, 1));
+    EXPECT_TRUE(tree.insert(b, 2));
+    EXPECT_TRUE(tree.insert(c, 3));
+    EXPECT_EQ(tree.find(a), 1);
+    EXPECT_EQ(tree.find(b), 2);
+    EXPECT_EQ(tree.find(c), 3);
+}
+
+TEST_F(AdaptiveRadixTreeTest, NodeGrowthThroughAllSizes) {
+    adaptive_radix_tree<int> tree;
+    // a single inner node gains children one by one: Node4 -> 16 -> 48 -> 256
+    for (int i = 0; i < 256; ++i) {
+        std::string key = "p" + std::string(1, static_cast<char>(i)) + "x";
+        EXPECT_TRUE(tree.insert(key, i));
+        for (int j = 0; j <= i; j += 17) {
+            std::string probe = "p" + std::string(1, static_cast<char>(j)) + "x";
+            ASSERT_EQ(tree.find(probe), j) << "after inserting " << i;
+        }
+    }
+}
+
+TEST_F(AdaptiveRadixTreeTest, EraseAndReinsertReusesSlots) {
+    adaptive_radix_tree<int> tree;
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < 40; ++i) {
+            EXPECT_TRUE(tree.insert(key_of(i), i + round));
+        }
+        for (int i = 0; i < 40; ++i) {
+            EXPECT_EQ(tree.find(key_of(i)), i + round);
+            EXPECT_TRUE(tree.erase(key_of(i)));
+        }
+        for (int i = 0; i < 40; ++i) {
+            EXPECT_FALSE(tree.contains(key_of(i)));
+        }
+    }
+}
+
+TEST_F(AdaptiveRadixTreeTest, LargeSequentialOperations) {
+    adaptive_radix_tree<int> tree;
+    const int count = 100000;
+    for (int i = 0; i < count; ++i) {
+        ASSERT_TRUE(tree.insert(key_of(i * 7919), i));
+    }
+    for (int i = 0; i < count; ++i) {
+        ASSERT_EQ(tree.find(key_of(i * 7919)), i);
+    }
+    for (int i = 0; i < count; i += 2) {
+        ASSERT_TRUE(tree.erase(key_of(i * 7919)));
+    }
+    for (int i = 0; i < count; ++i) {
+        ASSERT_EQ(tree.contains(key_of(i * 7919)), i % 2 == 1);
+    }
+}
+
+TEST_F(AdaptiveRadixTreeTest, ConcurrentInsertDisjointKeys) {
+    adaptive_radix_tree<int> tree;
+    const int num_threads = 8;
+    const int per_thread = 5000;
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&tree, t]() {
+            // interleaved keys so that threads fight over the same inner nodes
+            for (int i = 0; i < per_thread; ++i) {
+                int k = i * num_threads + t;
+                EXPECT_TRUE(tree.insert(key_of(k), k));
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    for (int k = 0; k < num_threads * per_thread; ++k) {
+        ASSERT_EQ(tree.find(key_of(k)), k);
+    }
+}
+
+TEST_F(AdaptiveRadixTreeTest, ConcurrentInsertSameKeysOneWinner) {
+    adaptive_radix_tree<int> tree;
+    const int num_threads = 4;
+    const int count = 2000;
+    std::atomic<int> inserted{0};
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < count; ++i) {
+                if (tree.insert(key_of(i), i)) {
+                    inserted.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(inserted.load(), count);
+}
+
+TEST_F(AdaptiveRadixTreeTest, ReadersDuringWriterChurn) {
+    adaptive_radix_tree<int> tree;
+    const int stable = 1000;
+    for (int i = 0; i < stable; ++i) {
+        tree.insert(key_of(i * 2), i * 2);
+    }
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> errors{0};
+    std::vector<std::thread> threads;
+
+    // writers churn odd keys next to the stable even ones, forcing grow / split / prune
+    for (int w = 0; w < 2; ++w) {
+        threads.emplace_back([&, w]() {
+            std::mt19937 rng(w);
+            while (!stop.load()) {
+                int k = static_cast<int>(rng() % stable) * 2 + 1;
+                if (rng() % 2) {
+                    tree.insert_or_assign(key_of(k), k);
+                } else {
+                    tree.erase(key_of(k));
+                }
+            }
+        });
+    }
+
+    for (int r = 0; r < 4; ++r) {
+        threads.emplace_back([&]() {
+            for (int round = 0; round < 20; ++round) {
+                for (int i = 0; i < stable; ++i) {
+                    auto v = tree.find(key_of(i * 2));
+                    if (!v || *v != i * 2) {
+                        errors.fetch_add(1);
+                    }
+                    auto odd = tree.find(key_of(i * 2 + 1));
+                    if (odd && *odd != i * 2 + 1) {
+                        errors.fetch_add(1);
+                    }
+                }
+            }
+        });
+    }
+
+    for (std::size_t i = 2; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+    stop.store(true);
+    threads[0].join();
+    threads[1].join();
+
+    EXPECT_EQ(errors.load(), 0);
+}
+
+TEST_F(AdaptiveRadixTreeTest, MaxConcurrentOperationsMixedWorkload) {
+    // as many threads as the hazard domain serves, each inserting, finding and erasing its keys
+    const int num_threads = static_cast<int>(adaptive_radix_tree<int>::MAX_CONCURRENT_OPERATIONS);
+    const int per_thread = 300;
+    adaptive_radix_tree<int> tree;
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&tree, t, num_threads]() {
+            for (int i = 0; i < per_thread; ++i) {
+                int k = i * num_threads + t;
+                EXPECT_TRUE(tree.insert(key_of(k), k));
+                EXPECT_EQ(tree.find(key_of(k)), k);
+                if (i % 2 == 1) {
+                    EXPECT_TRUE(tree.erase(key_of(k)));
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    for (int k = 0; k < num_threads * per_thread; ++k) {
+        ASSERT_EQ(tree.contains(key_of(k)), (k / num_threads) % 2 == 0);
+    }
+}
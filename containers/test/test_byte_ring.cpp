@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include "byte_ring.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace conc;
+
+namespace {
+
+std::vector<std::string> consume_all(byte_ring& ring) {
+    std::vector<std::string> out;
+    ring.consume([&](std::span<const std::byte> payload) {
+        out.emplace_back(reinterpret_cast<const char*>(payload.data()), payload.size());
+    });
+    return out;
+}
+
+}
+
+TEST(ByteRingTest, CapacityAndLimits) {
+    byte_ring ring(1000);
+    EXPECT_EQ(ring.capacity(), 1024u);
+    EXPECT_EQ(ring.max_length(), 504u);
+    EXPECT_FALSE(ring.reserve(505));
+    EXPECT_FALSE(ring.try_reserve(505));
+    EXPECT_TRUE(ring.reserve(504));
+}
+
+TEST(ByteRingTest, RecordsComeOutInOrder) {
+    byte_ring ring(1024);
+    EXPECT_TRUE(ring.write("alpha"));
+    EXPECT_TRUE(ring.write(""));
+    EXPECT_TRUE(ring.write("gamma gamma"));
+    EXPECT_EQ(consume_all(ring), (std::vector<std::string>{"alpha", "", "gamma gamma"}));
+    EXPECT_TRUE(consume_all(ring).empty());
+}
+
+TEST(ByteRingTest, UncommittedRecordBlocksLaterOnes) {
+    byte_ring ring(1024);
+    auto first = ring.reserve(3);
+    ASSERT_TRUE(first);
+    EXPECT_TRUE(ring.write("second"));
+    EXPECT_TRUE(consume_all(ring).empty());
+
+    std::memcpy(first.data().data(), "one", 3);
+    first.commit();
+    EXPECT_EQ(consume_all(ring), (std::vector<std::string>{"one", "second"}));
+}
+
+TEST(ByteRingTest, DroppedReservationIsSkipped) {
+    byte_ring ring(1024);
+    {
+        auto r = ring.reserve(10);
+        ASSERT_TRUE(r);
+    }
+    EXPECT_TRUE(ring.write("kept"));
+    EXPECT_EQ(consume_all(ring), (std::vector<std::string>{"kept"}));
+}
+
+TEST(ByteRingTest, WrapsWithPaddingAcrossManyLaps) {
+    byte_ring ring(256);
+    std::vector<std::string> expected;
+    std::vector<std::string> got;
+    for(int i = 0; i < 2000; ++i) {
+        std::string s(static_cast<std::size_t>(i * 7 % 61), static_cast<char>('a' + i % 26));
+        s += std::to_string(i);
+        if(i % 3 == 0) {
+            // dropped, turns into padding
+            auto r = ring.try_reserve(s.size());
+            EXPECT_TRUE(r);
+        } else {
+            EXPECT_TRUE(ring.write(s));
+            expected.push_back(s);
+        }
+        auto batch = consume_all(ring);
+        got.insert(got.end(), batch.begin(), batch.end());
+    }
+    EXPECT_EQ(got, expected);
+}
+
+TEST(ByteRingTest, TryReserveFailsWhenFull) {
+    byte_ring ring(128);
+    std::size_t written = 0;
+    while(auto r = ring.try_reserve(16)) {
+        r.commit();
+        ++written;
+    }
+    EXPECT_EQ(written, 128u / 24u);
+    EXPECT_EQ(consume_all(ring).size(), written);
+    EXPECT_TRUE(ring.try_reserve(16));
+}
+
+TEST(ByteRingTest, ProducersWaitForTheConsumer) {
+    constexpr int PRODUCERS = 4;
+    constexpr int PER_PRODUCER = 20000;
+    byte_ring ring(512);
+
+    std::vector<std::thread> producers;
+    for(int p = 0; p < PRODUCERS; ++p) {
+        producers.emplace_back([&ring, p]() {
+            for(int i = 0; i < PER_PRODUCER; ++i) {
+                ring.write(std::to_string(p) + ":" + std::to_string(i));
+            }
+        });
+    }
+
+    std::vector<int> next(PRODUCERS, 0);
+    bool ordered = true;
+    int received = 0;
+    while(received < PRODUCERS * PER_PRODUCER) {
+        received += static_cast<int>(ring.consume([&](std::span<const std::byte> payload) {
+            std::string s(reinterpret_cast<const char*>(payload.data()), payload.size());
+            const auto colon = s.find(':');
+            const int p = std::stoi(s.substr(0, colon));
+            ordered = ordered && std::stoi(s.substr(colon + 1)) == next[p]++;
+        }));
+        std::this_thread::yield();
+    }
+    for(auto& t : producers) {
+        t.join();
+    }
+    EXPECT_TRUE(ordered);
+}
+
+TEST(ByteRingTest, DrainToWritesRecordsBackToBack) {
+    byte_ring ring(4096);
+    std::FILE* file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+    const int fd = fileno(file);
+
+    std::string expected;
+    for(int round = 0; round < 50; ++round) {
+        for(int i = 0; i < 20; ++i) {
+            std::string line = "line " + std::to_string(round * 20 + i) + "\n";
+            ring.write(line);
+            expected += line;
+        }
+        EXPECT_GT(ring.drain_to(fd), 0);
+    }
+    EXPECT_EQ(ring.drain_to(fd), 0);
+
+    std::string contents(expected.size() + 16, '\0');
+    const auto n = ::pread(fd, contents.data(), contents.size(), 0);
+    contents.resize(static_cast<std::size_t>(n));
+    EXPECT_EQ(contents, expected);
+    std::fclose(file);
+}
+
+TEST(ByteRingTest, DrainToReportsErrors) {
+    byte_ring ring(1024);
+    ring.write("lost");
+    EXPECT_EQ(ring.drain_to(-1), -1);
+    EXPECT_EQ(errno, EBADF);
+    EXPECT_TRUE(consume_all(ring).empty());
+}
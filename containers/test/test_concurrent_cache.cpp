@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+#include "concurrent_cache.hpp"
+
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <string>
+#include <random>
+
+using namespace conc;
+
+class ConcurrentCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {}
+    void TearDown() override {}
+};
+
+TEST_F(ConcurrentCacheTest, InsertFindErase) {
+    concurrent_cache<std::string, int> cache(1024, 1);
+    EXPECT_FALSE(cache.find("a").has_value());
+
+    EXPECT_TRUE(cache.insert_or_assign("a", 1, 1));
+    EXPECT_TRUE(cache.insert_or_assign("b", 2, 1));
+    EXPECT_EQ(cache.find("a"), 1);
+    EXPECT_EQ(cache.find("b"), 2);
+
+    EXPECT_TRUE(cache.insert_or_assign("a", 10, 1));
+    EXPECT_EQ(cache.find("a"), 10);
+    EXPECT_EQ(cache.size(), 2);
+
+    EXPECT_TRUE(cache.erase("a"));
+    EXPECT_FALSE(cache.erase("a"));
+    EXPECT_FALSE(cache.contains("a"));
+    EXPECT_EQ(cache.size(), 1);
+}
+
+TEST_F(ConcurrentCacheTest, ChargeIsBounded) {
+    concurrent_cache<int, int> cache(100, 1);
+    for (int i = 0; i < 1000; ++i) {
+        cache.insert_or_assign(i, i, 7);
+        ASSERT_LE(cache.charge(), cache.capacity());
+    }
+    EXPECT_EQ(cache.size(), 100 / 7);
+    EXPECT_GT(cache.stats().evictions, 0);
+}
+
+TEST_F(ConcurrentCacheTest, OversizedEntryIsRejected) {
+    concurrent_cache<int, std::string> cache(64, 1);
+    EXPECT_TRUE(cache.insert_or_assign(1, "small", 8));
+    EXPECT_FALSE(cache.insert_or_assign(2, "huge", 65));
+    EXPECT_FALSE(cache.contains(2));
+    EXPECT_TRUE(cache.contains(1));
+
+    // a rejected replacement leaves the cached value alone
+    EXPECT_FALSE(cache.insert_or_assign(1, "huge", 65));
+    EXPECT_EQ(cache.find(1), "small");
+}
+
+TEST_F(ConcurrentCacheTest, SmallCapacityClampsShards) {
+    // 16 shards of one unit each would cache 16 units
+    concurrent_cache<int, int> cache(5, 16);
+    EXPECT_LE(cache.capacity(), 5u);
+    for (int i = 0; i < 100; ++i) {
+        cache.insert_or_assign(i, i, 1);
+        ASSERT_LE(cache.charge(), 5u);
+    }
+}
+
+TEST_F(ConcurrentCacheTest, VisitedEntriesSurviveEviction) {
+    concurrent_cache<int, int> cache(10, 1);
+    for (int i = 0; i < 10; ++i) {
+        cache.insert_or_assign(i, i, 1);
+    }
+
+    // keep the first half hot, the cold half is evicted first
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_EQ(cache.find(i), i);
+    }
+    for (int i = 10; i < 15; ++i) {
+        cache.insert_or_assign(i, i, 1);
+    }
+
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_TRUE(cache.contains(i)) << i;
+    }
+    for (int i = 5; i < 10; ++i) {
+        EXPECT_FALSE(cache.contains(i)) << i;
+    }
+}
+
+TEST_F(ConcurrentCacheTest, Statistics) {
+    concurrent_cache<int, int> cache(1024);
+    cache.insert_or_assign(1, 1);
+    cache.find(1);
+    cache.find(1);
+    cache.find(2);
+
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.hits, 2);
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.evictions, 0);
+}
+
+TEST_F(ConcurrentCacheTest, ClearAndReuse) {
+    concurrent_cache<int, int> cache(4096, 4);
+    for (int i = 0; i < 1000; ++i) {
+        cache.insert_or_assign(i, i, 1);
+    }
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_EQ(cache.charge(), 0);
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_FALSE(cache.contains(i));
+    }
+    for (int i = 0; i < 1000; ++i) {
+        cache.insert_or_assign(i, -i, 1);
+    }
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQ(cache.find(i), -i);
+    }
+}
+
+TEST_F(ConcurrentCacheTest, ConcurrentReadersAndWriters) {
+    concurrent_cache<int, std::string> cache(512, 8);
+    const int keys = 2048;
+    std::atomic<bool> stop{false};
+    std::atomic<int> errors{0};
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < 2; ++t) {
+        threads.emplace_back([&, t]() {
+            std::mt19937 rng(t);
+            while (!stop.load()) {
+                int k = static_cast<int>(rng() % keys);
+                if (rng() % 8 == 0) {
+                    cache.erase(k);
+                } else {
+                    cache.insert_or_assign(k, std::to_string(k), 1);
+                }
+            }
+        });
+    }
+
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t]() {
+            std::mt19937 rng(100 + t);
+            for (int i = 0; i < 200000; ++i) {
+                int k = static_cast<int>(rng() % keys);
+                auto v = cache.find(k);
+                if (v && *v != std::to_string(k)) {
+                    errors.fetch_add(1);
+                }
+            }
+        });
+    }
+
+    for (std::size_t t = 2; t < threads.size(); ++t) {
+        threads[t].join();
+    }
+    stop.store(true);
+    threads[0].join();
+    threads[1].join();
+
+    EXPECT_EQ(errors.load(), 0);
+    EXPECT_LE(cache.charge(), cache.capacity());
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.hits + stats.misses, 4u * 200000u);
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include "concurrent_vector.hpp"
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace conc;
+
+TEST(ConcurrentVectorTest, PushBackReturnsConsecutiveIndices) {
+    concurrent_vector<int> v;
+    EXPECT_TRUE(v.empty());
+    for(int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(v.push_back(i * 2), static_cast<std::size_t>(i));
+    }
+    EXPECT_EQ(v.size(), 1000u);
+    for(int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(v[i], i * 2);
+    }
+}
+
+TEST(ConcurrentVectorTest, ReferencesStayValidWhileGrowing) {
+    concurrent_vector<std::string> v;
+    v.emplace_back("first");
+    v.emplace_back(5, 'x');
+    std::string* first = &v[0];
+    std::string* second = &v[1];
+    for(int i = 0; i < 100000; ++i) {
+        v.push_back(std::to_string(i));
+    }
+    EXPECT_EQ(first, &v[0]);
+    EXPECT_EQ(second, &v[1]);
+    EXPECT_EQ(*first, "first");
+    EXPECT_EQ(*second, "xxxxx");
+    EXPECT_EQ(v[100001], "99999");
+}
+
+TEST(ConcurrentVectorTest, DestroysElements) {
+    auto tracker = std::make_shared<int>(0);
+    {
+        concurrent_vector<std::shared_ptr<int>> v;
+        v.reserve(100);
+        for(int i = 0; i < 300; ++i) {
+            v.push_back(tracker);
+        }
+        EXPECT_EQ(tracker.use_count(), 301);
+    }
+    EXPECT_EQ(tracker.use_count(), 1);
+}
+
+TEST(ConcurrentVectorTest, ThrowingConstructionLeavesNoHole) {
+    struct picky {
+        explicit picky(int v) : value(v) {
+            if(v < 0) {
+                throw std::invalid_argument("negative");
+            }
+        }
+        int value;
+    };
+    concurrent_vector<picky> v;
+    v.emplace_back(1);
+    EXPECT_THROW(v.emplace_back(-1), std::invalid_argument);
+    EXPECT_EQ(v.emplace_back(2), 1u);
+    EXPECT_EQ(v.size(), 2u);
+    EXPECT_EQ(v[1].value, 2);
+}
+
+TEST(ConcurrentVectorTest, ConcurrentPushersAndReaders) {
+    constexpr int PUSHERS = 4;
+    constexpr int PER_PUSHER = 50000;
+    concurrent_vector<std::pair<int, int>> v;
+    std::atomic<bool> done{false};
+    std::atomic<bool> consistent{true};
+
+    std::thread reader([&]() {
+        std::size_t checked = 0;
+        while(!done.load() || checked < v.size()) {
+            const std::size_t size = v.size();
+            for(; checked < size; ++checked) {
+                const auto& [pusher, value] = v[checked];
+                if(pusher < 0 || pusher >= PUSHERS || value < 0 || value >= PER_PUSHER) {
+                    consistent.store(false);
+                }
+            }
+        }
+    });
+
+    std::vector<std::vector<std::size_t>> indices(PUSHERS);
+    std::vector<std::thread> pushers;
+    for(int p = 0; p < PUSHERS; ++p) {
+        pushers.emplace_back([&, p]() {
+            for(int i = 0; i < PER_PUSHER; ++i) {
+                indices[p].push_back(v.push_back({p, i}));
+            }
+        });
+    }
+    for(auto& t : pushers) {
+        t.join();
+    }
+    done.store(true);
+    reader.join();
+
+    EXPECT_TRUE(consistent.load());
+    ASSERT_EQ(v.size(), static_cast<std::size_t>(PUSHERS * PER_PUSHER));
+    std::vector<bool> seen(v.size());
+    for(int p = 0; p < PUSHERS; ++p) {
+        for(int i = 0; i < PER_PUSHER; ++i) {
+            const std::size_t index = indices[p][i];
+            ASSERT_FALSE(seen[index]);
+            seen[index] = true;
+            EXPECT_EQ(v[index], std::make_pair(p, i));
+        }
+    }
+}
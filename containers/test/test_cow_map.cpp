@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include "cow_map.hpp"
+
+#include <barrier>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <string>
+
+using namespace conc;
+
+class CowMapTest : public ::testing::Test {};
+
+TEST_F(CowMapTest, EmptyMap) {
+    cow_map<int, int> map;
+    EXPECT_FALSE(map.find(1).has_value());
+    EXPECT_EQ(map.size(), 0);
+}
+
+TEST_F(CowMapTest, InsertFindErase) {
+    cow_map<std::string, int> map;
+    map.insert_or_assign("b", 2);
+    map.insert_or_assign("a", 1);
+    map.insert_or_assign("c", 3);
+    map.insert_or_assign("b", 20);
+
+    EXPECT_EQ(map.size(), 3);
+    EXPECT_EQ(map.find("a"), 1);
+    EXPECT_EQ(map.find("b"), 20);
+    EXPECT_EQ(map.find("c"), 3);
+    EXPECT_FALSE(map.contains("d"));
+
+    map.erase("b");
+    map.erase("missing");
+    EXPECT_EQ(map.size(), 2);
+    EXPECT_FALSE(map.contains("b"));
+}
+
+TEST_F(CowMapTest, BatchLastOperationWins) {
+    cow_map<int, int> map;
+    map.insert_or_assign(5, 50);
+
+    cow_map<int, int>::batch updates;
+    updates.insert_or_assign(3, 30);
+    updates.erase(3);
+    updates.insert_or_assign(1, 10);
+    updates.erase(5);
+    updates.insert_or_assign(5, 55);
+    updates.insert_or_assign(9, 90);
+    updates.erase(9);
+    map.commit(std::move(updates));
+
+    EXPECT_EQ(map.size(), 2);
+    EXPECT_FALSE(map.contains(3));
+    EXPECT_EQ(map.find(1), 10);
+    EXPECT_EQ(map.find(5), 55);
+    EXPECT_FALSE(map.contains(9));
+}
+
+TEST_F(CowMapTest, SnapshotIsSorted) {
+    cow_map<int, int> map;
+    cow_map<int, int>::batch updates;
+    for (int i = 100; i > 0; --i) {
+        updates.insert_or_assign(i * 37 % 101, i);
+    }
+    map.commit(std::move(updates));
+
+    map.read([](auto entries) {
+        EXPECT_EQ(entries.size(), 100);
+        for (std::size_t i = 1; i < entries.size(); ++i) {
+            EXPECT_LT(entries[i - 1].first, entries[i].first);
+        }
+    });
+}
+
+TEST_F(CowMapTest, ReadersSeeConsistentSnapshots) {
+    cow_map<int, int> map;
+    const int keys = 256;
+    {
+        cow_map<int, int>::batch updates;
+        for (int k = 0; k < keys; ++k) {
+            updates.insert_or_assign(k, 0);
+        }
+        map.commit(std::move(updates));
+    }
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> errors{0};
+    std::vector<std::thread> readers;
+
+    // every commit rewrites all values to the same version, so a torn view is detectable
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&]() {
+            while (!stop.load()) {
+                map.read([&](auto entries) {
+                    if (entries.size() != keys) {
+                        errors.fetch_add(1);
+                        return;
+                    }
+                    for (const auto& e : entries) {
+                        if (e.second != entries[0].second) {
+                            errors.fetch_add(1);
+                            return;
+                        }
+                    }
+                });
+                auto v = map.find(keys / 2);
+                if (!v.has_value()) {
+                    errors.fetch_add(1);
+                }
+            }
+        });
+    }
+
+    for (int version = 1; version <= 500; ++version) {
+        cow_map<int, int>::batch updates;
+        for (int k = 0; k < keys; ++k) {
+            updates.insert_or_assign(k, version);
+        }
+        map.commit(std::move(updates));
+    }
+
+    stop.store(true);
+    for (auto& t : readers) {
+        t.join();
+    }
+
+    EXPECT_EQ(errors.load(), 0);
+    EXPECT_EQ(map.find(0), 500);
+}
+
+TEST_F(CowMapTest, ConcurrentWriters) {
+    cow_map<int, int> map;
+    const int num_threads = 4;
+    const int per_thread = 200;
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&map, t]() {
+            for (int i = 0; i < per_thread; ++i) {
+                map.insert_or_assign(t * per_thread + i, i);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(map.size(), num_threads * per_thread);
+}
+
+TEST_F(CowMapTest, MaxConcurrentReadersWithCommits) {
+    // every reader parks inside read, holding its cell, until all of them are there
+    using map_t = cow_map<int, int, std::less<int>, 8>;
+    constexpr std::size_t READERS = map_t::MAX_CONCURRENT_READERS;
+    map_t map;
+    map.insert_or_assign(1, 1);
+
+    std::barrier all_inside(static_cast<std::ptrdiff_t>(READERS + 1));
+    std::vector<std::thread> readers;
+    for (std::size_t i = 0; i < READERS; ++i) {
+        readers.emplace_back([&]() {
+            map.read([&](std::span<const map_t::value_type> entries) {
+                all_inside.arrive_and_wait();
+                // the snapshot stays valid while commits replace it
+                all_inside.arrive_and_wait();
+                EXPECT_EQ(entries.size(), 1u);
+            });
+        });
+    }
+    all_inside.arrive_and_wait();
+    for (int k = 2; k < 100; ++k) {
+        map.insert_or_assign(k, k);
+    }
+    all_inside.arrive_and_wait();
+    for (auto& t : readers) {
+        t.join();
+    }
+    EXPECT_EQ(map.size(), 99u);
+}
@@ -0,0 +1,292 @@
+#include <gtest/gtest.h>
+#include "ctrie.hpp"
+
+#include <barrier>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <set>
+#include <string>
+#include <random>
+
+using namespace conc;
+
+class CtrieTest : public ::testing::Test {
+protected:
+    // every key lands in the same collision list
+    struct constant_hash {
+        std::size_t operator()(int) const noexcept { return 42; }
+    };
+
+    // keys share the low 60 bits and only differ in the last level
+    struct shallow_hash {
+        std::size_t operator()(int k) const noexcept {
+            return (static_cast<std::size_t>(k) << 60) | 0x0FFFFFFFFFFFFFFFull;
+        }
+    };
+};
+
+TEST_F(CtrieTest, EmptyTrie) {
+    ctrie<int, int> trie;
+    EXPECT_FALSE(trie.find(1).has_value());
+    EXPECT_FALSE(trie.erase(1));
+    EXPECT_EQ(trie.size(), 0);
+}
+
+TEST_F(CtrieTest, InsertFindErase) {
+    ctrie<std::string, int> trie;
+    EXPECT_TRUE(trie.insert("one", 1));
+    EXPECT_TRUE(trie.insert("two", 2));
+    EXPECT_FALSE(trie.insert("one", 10));
+    EXPECT_EQ(trie.find("one"), 1);
+
+    EXPECT_FALSE(trie.insert_or_assign("one", 11));
+    EXPECT_EQ(trie.find("one"), 11);
+
+    EXPECT_TRUE(trie.erase("one"));
+    EXPECT_FALSE(trie.erase("one"));
+    EXPECT_FALSE(trie.contains("one"));
+    EXPECT_EQ(trie.find("two"), 2);
+}
+
+TEST_F(CtrieTest, LargeSequentialOperations) {
+    ctrie<int, int> trie;
+    const int count = 50000;
+    for (int i = 0; i < count; ++i) {
+        ASSERT_TRUE(trie.insert(i, i * 2));
+    }
+    EXPECT_EQ(trie.size(), count);
+    for (int i = 0; i < count; ++i) {
+        ASSERT_EQ(trie.find(i), i * 2);
+    }
+    for (int i = 0; i < count; i += 2) {
+        ASSERT_TRUE(trie.erase(i));
+    }
+    EXPECT_EQ(trie.size(), count / 2);
+    for (int i = 0; i < count; ++i) {
+        ASSERT_EQ(trie.contains(i), i % 2 == 1);
+    }
+}
+
+TEST_F(CtrieTest, FullHashCollisions) {
+    ctrie<int, int, constant_hash> trie;
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(trie.insert(i, i));
+    }
+    EXPECT_FALSE(trie.insert(3, 30));
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(trie.find(i), i);
+    }
+    for (int i = 0; i < 9; ++i) {
+        EXPECT_TRUE(trie.erase(i));
+    }
+    EXPECT_EQ(trie.find(9), 9);
+    EXPECT_EQ(trie.size(), 1);
+}
+
+TEST_F(CtrieTest, DeepTrieContractsAfterErase) {
+    ctrie<int, int, shallow_hash> trie;
+    for (int i = 0; i < 16; ++i) {
+        EXPECT_TRUE(trie.insert(i, i));
+    }
+    for (int i = 0; i < 16; ++i) {
+        EXPECT_EQ(trie.find(i), i);
+    }
+    for (int i = 0; i < 15; ++i) {
+        EXPECT_TRUE(trie.erase(i));
+        EXPECT_EQ(trie.find(15), 15);
+    }
+    EXPECT_TRUE(trie.insert(3, 3));
+    EXPECT_EQ(trie.size(), 2);
+}
+
+TEST_F(CtrieTest, SnapshotIsIndependent) {
+    ctrie<int, int> trie;
+    for (int i = 0; i < 1000; ++i) {
+        trie.insert(i, i);
+    }
+
+    auto snap = trie.snapshot();
+    for (int i = 0; i < 1000; i += 2) {
+        trie.erase(i);
+    }
+    trie.insert_or_assign(1, -1);
+    snap.insert(5000, 5000);
+    snap.erase(999);
+
+    EXPECT_EQ(snap.size(), 1000);
+    EXPECT_EQ(trie.size(), 500);
+    EXPECT_EQ(snap.find(1), 1);
+    EXPECT_EQ(trie.find(1), -1);
+    EXPECT_EQ(snap.find(0), 0);
+    EXPECT_FALSE(trie.contains(0));
+    EXPECT_FALSE(trie.contains(5000));
+    EXPECT_TRUE(trie.contains(999));
+    EXPECT_FALSE(snap.contains(999));
+}
+
+TEST_F(CtrieTest, ReadOnlySnapshot) {
+    ctrie<int, int> trie;
+    for (int i = 0; i < 100; ++i) {
+        trie.insert(i, i);
+    }
+
+    auto snap = trie.read_only_snapshot();
+    EXPECT_TRUE(snap.is_read_only());
+    trie.erase(10);
+    trie.insert(200, 200);
+
+    EXPECT_EQ(snap.find(10), 10);
+    EXPECT_FALSE(snap.contains(200));
+
+    std::set<int> seen;
+    snap.for_each([&seen](int k, int v) {
+        EXPECT_EQ(k, v);
+        seen.insert(k);
+    });
+    EXPECT_EQ(seen.size(), 100);
+}
+
+TEST_F(CtrieTest, ChainedSnapshots) {
+    ctrie<int, int> trie;
+    std::vector<ctrie<int, int>> snapshots;
+    for (int round = 0; round < 10; ++round) {
+        trie.insert(round, round);
+        snapshots.push_back(trie.snapshot());
+    }
+    for (int round = 0; round < 10; ++round) {
+        EXPECT_EQ(snapshots[round].size(), static_cast<std::size_t>(round + 1));
+    }
+    snapshots.clear();
+    EXPECT_EQ(trie.size(), 10);
+}
+
+TEST_F(CtrieTest, ConcurrentInsertErase) {
+    ctrie<int, int> trie;
+    const int num_threads = 4;
+    const int per_thread = 5000;
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&trie, t]() {
+            for (int i = 0; i < per_thread; ++i) {
+                EXPECT_TRUE(trie.insert(t * per_thread + i, i));
+            }
+            for (int i = 0; i < per_thread; i += 2) {
+                EXPECT_TRUE(trie.erase(t * per_thread + i));
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(trie.size(), num_threads * per_thread / 2);
+    for (int k = 0; k < num_threads * per_thread; ++k) {
+        ASSERT_EQ(trie.contains(k), k % 2 == 1);
+    }
+}
+
+TEST_F(CtrieTest, SnapshotsAreConsistentUnderWriters) {
+    ctrie<int, int> trie;
+    std::atomic<bool> stop{false};
+    std::atomic<int> errors{0};
+
+    // keys are inserted in ascending order and then erased in ascending order,
+    // so every consistent view holds one contiguous range
+    std::thread writer([&]() {
+        for (int round = 0; round < 20; ++round) {
+            for (int i = 0; i < 500; ++i) {
+                trie.insert(round * 500 + i, i);
+            }
+            for (int i = 0; i < 500; ++i) {
+                trie.erase(round * 500 + i);
+            }
+        }
+        stop.store(true);
+    });
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; ++r) {
+        readers.emplace_back([&]() {
+            while (!stop.load()) {
+                std::set<int> seen;
+                trie.for_each([&seen](int k, int) { seen.insert(k); });
+                if (!seen.empty() && *seen.rbegin() - *seen.begin() + 1 != static_cast<int>(seen.size())) {
+                    errors.fetch_add(1);
+                }
+            }
+        });
+    }
+
+    writer.join();
+    for (auto& t : readers) {
+        t.join();
+    }
+
+    EXPECT_EQ(errors.load(), 0);
+    EXPECT_EQ(trie.size(), 0);
+}
+
+TEST_F(CtrieTest, MixedWorkloadWithSnapshots) {
+    ctrie<int, int> trie;
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < 3; ++t) {
+        threads.emplace_back([&, t]() {
+            std::mt19937 rng(t);
+            while (!stop.load()) {
+                int k = static_cast<int>(rng() % 512);
+                switch (rng() % 3) {
+                    case 0: trie.insert_or_assign(k, k); break;
+                    case 1: trie.erase(k); break;
+                    default: {
+                        auto v = trie.find(k);
+                        if (v) {
+                            EXPECT_EQ(*v, k);
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < 50; ++i) {
+        auto snap = trie.snapshot();
+        snap.for_each([](int k, int v) { EXPECT_EQ(k, v); });
+        snap.insert_or_assign(1000, 1000);
+        EXPECT_TRUE(snap.contains(1000));
+    }
+
+    stop.store(true);
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_FALSE(trie.contains(1000));
+}
+
+TEST_F(CtrieTest, MaxConcurrentOperationsHoldContextsAtOnce) {
+    // every thread parks inside for_each, holding its context, until all of them are there
+    using trie = ctrie<int, int>;
+    constexpr std::size_t THREADS = trie::MAX_CONCURRENT_OPERATIONS;
+    trie t;
+    t.insert(1, 1);
+
+    std::barrier all_inside(static_cast<std::ptrdiff_t>(THREADS));
+    std::atomic<std::size_t> seen{0};
+    std::vector<std::thread> threads;
+    for(std::size_t i = 0; i < THREADS; ++i) {
+        threads.emplace_back([&]() {
+            t.for_each([&](const int&, const int& v) {
+                all_inside.arrive_and_wait();
+                seen.fetch_add(static_cast<std::size_t>(v));
+            });
+        });
+    }
+    for(auto& th : threads) {
+        th.join();
+    }
+    EXPECT_EQ(seen.load(), THREADS);
+    EXPECT_EQ(t.find(1), 1);
+}
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include "id_allocator.hpp"
+
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <set>
+#include <random>
+#include <algorithm>
+
+using namespace conc;
+
+class IdAllocatorTest : public ::testing::Test {
+protected:
+    void SetUp() override {}
+    void TearDown() override {}
+};
+
+TEST_F(IdAllocatorTest, ZeroCapacity) {
+    id_allocator ids(0);
+    EXPECT_FALSE(ids.acquire().has_value());
+    EXPECT_EQ(ids.size(), 0);
+}
+
+TEST_F(IdAllocatorTest, ExhaustAndRelease) {
+    for (std::size_t capacity : {1ul, 63ul, 64ul, 65ul, 4096ul, 4097ul, 300000ul}) {
+        id_allocator ids(capacity);
+        std::vector<bool> seen(capacity, false);
+        for (std::size_t i = 0; i < capacity; ++i) {
+            auto id = ids.acquire();
+            ASSERT_TRUE(id.has_value()) << capacity;
+            ASSERT_LT(*id, capacity);
+            ASSERT_FALSE(seen[*id]);
+            seen[*id] = true;
+        }
+        EXPECT_FALSE(ids.acquire().has_value()) << capacity;
+        EXPECT_EQ(ids.size(), capacity);
+
+        ids.release(capacity / 2);
+        EXPECT_FALSE(ids.is_taken(capacity / 2));
+        EXPECT_EQ(ids.acquire(), capacity / 2);
+        EXPECT_FALSE(ids.acquire().has_value());
+    }
+}
+
+TEST_F(IdAllocatorTest, ReleasedIdsAreReused) {
+    id_allocator ids(1000);
+    std::vector<std::size_t> taken;
+    for (int i = 0; i < 1000; ++i) {
+        taken.push_back(*ids.acquire());
+    }
+    std::set<std::size_t> released;
+    for (std::size_t i = 0; i < taken.size(); i += 3) {
+        ids.release(taken[i]);
+        released.insert(taken[i]);
+    }
+    EXPECT_EQ(ids.size(), 1000 - released.size());
+
+    std::set<std::size_t> again;
+    while (auto id = ids.acquire()) {
+        again.insert(*id);
+    }
+    EXPECT_EQ(again, released);
+}
+
+TEST_F(IdAllocatorTest, ConcurrentAcquireIsUnique) {
+    const std::size_t capacity = 100000;
+    id_allocator ids(capacity);
+    const int num_threads = 8;
+    std::vector<std::vector<std::size_t>> results(num_threads);
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            while (auto id = ids.acquire()) {
+                results[t].push_back(*id);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    std::vector<std::size_t> all;
+    for (auto& r : results) {
+        all.insert(all.end(), r.begin(), r.end());
+    }
+    std::sort(all.begin(), all.end());
+    EXPECT_EQ(all.size(), capacity);
+    EXPECT_EQ(std::adjacent_find(all.begin(), all.end()), all.end());
+}
+
+TEST_F(IdAllocatorTest, ConcurrentChurnNeverLosesCapacity) {
+    const std::size_t capacity = 200;
+    id_allocator ids(capacity);
+    const int num_threads = 8;
+    std::atomic<int> errors{0};
+    std::vector<std::atomic<int>> owners(capacity);
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            std::mt19937 rng(t);
+            std::vector<std::size_t> held;
+            for (int i = 0; i < 50000; ++i) {
+                if (held.size() < 25 && rng() % 2 == 0) {
+                    if (auto id = ids.acquire()) {
+                        if (owners[*id].exchange(t + 1) != 0) {
+                            errors.fetch_add(1);
+                        }
+                        held.push_back(*id);
+                    } else {
+                        errors.fetch_add(1);
+                    }
+                } else if (!held.empty()) {
+                    std::size_t id = held.back();
+                    held.pop_back();
+                    owners[id].store(0);
+                    ids.release(id);
+                }
+            }
+            for (auto id : held) {
+                owners[id].store(0);
+                ids.release(id);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    // 8 threads hold at most 200 ids, so acquire never legitimately fails
+    EXPECT_EQ(errors.load(), 0);
+    EXPECT_EQ(ids.size(), 0);
+    for (std::size_t i = 0; i < capacity; ++i) {
+        ASSERT_TRUE(ids.acquire().has_value());
+    }
+    EXPECT_FALSE(ids.acquire().has_value());
+}
+
+TEST_F(IdAllocatorTest, ThreadStaysOnItsLeafWordUntilFull) {
+    id_allocator ids(1 << 16);
+    std::thread([&ids]() {
+        std::set<std::size_t> words;
+        for (int i = 0; i < 64; ++i) {
+            words.insert(*ids.acquire() / 64);
+        }
+        EXPECT_EQ(words.size(), 1u);
+        // the word is full now, the next id comes from another one
+        EXPECT_NE(*ids.acquire() / 64, *words.begin());
+    }).join();
+}
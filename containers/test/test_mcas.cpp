@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+#include "mcas.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace conc;
+
+TEST(McasTest, SucceedsWhenEveryWordMatches) {
+    mcas_word a(1), b(2), c(3);
+    const std::array<mcas_entry, 3> entries{{{&a, 1, 10}, {&b, 2, 20}, {&c, 3, 30}}};
+    EXPECT_TRUE(mcas(entries));
+    EXPECT_EQ(a.load(), 10u);
+    EXPECT_EQ(b.load(), 20u);
+    EXPECT_EQ(c.load(), 30u);
+}
+
+TEST(McasTest, FailsAndChangesNothingOnMismatch) {
+    mcas_word a(1), b(2), c(3);
+    const std::array<mcas_entry, 3> entries{{{&a, 1, 10}, {&b, 5, 20}, {&c, 3, 30}}};
+    EXPECT_FALSE(mcas(entries));
+    EXPECT_EQ(a.load(), 1u);
+    EXPECT_EQ(b.load(), 2u);
+    EXPECT_EQ(c.load(), 3u);
+}
+
+TEST(McasTest, RejectsInvalidOperations) {
+    mcas_word a(1), b(2);
+    const std::array<mcas_entry, 2> duplicate{{{&a, 1, 10}, {&a, 1, 20}}};
+    EXPECT_FALSE(mcas(duplicate));
+    const std::array<mcas_entry, 2> too_wide{{{&a, 1, mcas_word::MAX_VALUE + 1}, {&b, 2, 20}}};
+    EXPECT_FALSE(mcas(too_wide));
+    std::array<mcas_word, MCAS_MAX_WORDS + 1> words;
+    std::array<mcas_entry, MCAS_MAX_WORDS + 1> too_many;
+    for(std::size_t i = 0; i < words.size(); ++i) {
+        too_many[i] = {&words[i], 0, 1};
+    }
+    EXPECT_FALSE(mcas(too_many));
+    EXPECT_TRUE(mcas(std::span(too_many).first(MCAS_MAX_WORDS)));
+    EXPECT_EQ(words[MCAS_MAX_WORDS - 1].load(), 1u);
+    EXPECT_EQ(words[MCAS_MAX_WORDS].load(), 0u);
+    EXPECT_EQ(a.load(), 1u);
+    EXPECT_EQ(b.load(), 2u);
+}
+
+TEST(McasTest, SingleWordCompareExchange) {
+    mcas_word a(mcas_word::MAX_VALUE);
+    std::uint64_t expected = 0;
+    EXPECT_FALSE(a.compare_exchange(expected, 5));
+    EXPECT_EQ(expected, mcas_word::MAX_VALUE);
+    EXPECT_TRUE(a.compare_exchange(expected, 5));
+    EXPECT_EQ(a.load(), 5u);
+}
+
+// transfers between random accounts keep the total, and a snapshot taken by an mcas that
+// writes back what it read always sees it
+TEST(McasTest, ConcurrentTransfersKeepTotal) {
+    constexpr std::size_t ACCOUNTS = 16;
+    constexpr std::uint64_t INITIAL = 1000;
+    constexpr int THREADS = 4;
+    constexpr int TRANSFERS = 20000;
+    std::array<mcas_word, ACCOUNTS> accounts;
+    for(auto& a : accounts) {
+        std::uint64_t zero = 0;
+        a.compare_exchange(zero, INITIAL);
+    }
+    std::atomic<bool> done{false};
+    std::atomic<bool> consistent{true};
+
+    std::thread auditor([&]() {
+        while(!done.load()) {
+            std::array<std::uint64_t, ACCOUNTS> seen;
+            for(std::size_t i = 0; i < ACCOUNTS; ++i) {
+                seen[i] = accounts[i].load();
+            }
+            std::array<mcas_entry, MCAS_MAX_WORDS> all;
+            for(std::size_t i = 0; i < ACCOUNTS; ++i) {
+                all[i] = {&accounts[i], seen[i], seen[i]};
+            }
+            if(mcas(all)) {
+                if(std::accumulate(seen.begin(), seen.end(), std::uint64_t(0)) != INITIAL * ACCOUNTS) {
+                    consistent.store(false);
+                }
+            }
+        }
+    });
+
+    std::vector<std::thread> workers;
+    for(int t = 0; t < THREADS; ++t) {
+        workers.emplace_back([&, t]() {
+            std::mt19937 rng(t);
+            std::uniform_int_distribution<std::size_t> pick(0, ACCOUNTS - 1);
+            for(int n = 0; n < TRANSFERS; ++n) {
+                const std::size_t from = pick(rng);
+                std::size_t to = pick(rng);
+                if(to == from) {
+                    to = (to + 1) % ACCOUNTS;
+                }
+                while(true) {
+                    const std::uint64_t f = accounts[from].load();
+                    const std::uint64_t g = accounts[to].load();
+                    if(f == 0) {
+                        break;
+                    }
+                    const std::array<mcas_entry, 2> transfer{{{&accounts[from], f, f - 1}, {&accounts[to], g, g + 1}}};
+                    if(mcas(transfer)) {
+                        break;
+                    }
+                }
+            }
+        });
+    }
+    for(auto& w : workers) {
+        w.join();
+    }
+    done.store(true);
+    auditor.join();
+
+    EXPECT_TRUE(consistent.load());
+    std::uint64_t total = 0;
+    for(auto& a : accounts) {
+        total += a.load();
+    }
+    EXPECT_EQ(total, INITIAL * ACCOUNTS);
+}
+
+// overlapping increments of up to eight words: every successful mcas adds one to each of its
+// words, so the words add up to the successful operations times their width
+TEST(McasTest, ConcurrentOverlappingIncrements) {
+    constexpr std::size_t WORDS = 12;
+    constexpr std::size_t WIDTH = 8;
+    constexpr int THREADS = 4;
+    constexpr int OPS = 10000;
+    std::array<mcas_word, WORDS> words;
+
+    std::vector<std::thread> workers;
+    for(int t = 0; t < THREADS; ++t) {
+        workers.emplace_back([&, t]() {
+            std::mt19937 rng(t + 100);
+            std::array<std::size_t, WORDS> order;
+            std::iota(order.begin(), order.end(), 0);
+            for(int n = 0; n < OPS; ++n) {
+                std::shuffle(order.begin(), order.end(), rng);
+                std::array<mcas_entry, WIDTH> entries;
+                do {
+                    for(std::size_t i = 0; i < WIDTH; ++i) {
+                        const std::uint64_t v = words[order[i]].load();
+                        entries[i] = {&words[order[i]], v, v + 1};
+                    }
+                } while(!mcas(entries));
+            }
+        });
+    }
+    for(auto& w : workers) {
+        w.join();
+    }
+
+    std::uint64_t total = 0;
+    for(auto& w : words) {
+        total += w.load();
+    }
+    EXPECT_EQ(total, std::uint64_t(THREADS) * OPS * WIDTH);
+}
+
+TEST(McasTest, ChainsOfBlockedOperationsWithManyThreads) {
+    // adjacent pairs along a line: operations block each other in chains, and helpers must
+    // not take a hazard cell per link with this many threads sharing the domains
+    constexpr std::size_t WORDS = 48;
+    constexpr int THREADS = 96;
+    constexpr int OPS = 300;
+    std::array<mcas_word, WORDS> words;
+
+    std::vector<std::thread> workers;
+    for(int t = 0; t < THREADS; ++t) {
+        workers.emplace_back([&, t]() {
+            std::mt19937 rng(t + 200);
+            std::uniform_int_distribution<std::size_t> pick(0, WORDS - 2);
+            for(int n = 0; n < OPS; ++n) {
+                const std::size_t i = pick(rng);
+                std::array<mcas_entry, 2> entries;
+                do {
+                    for(std::size_t k = 0; k < 2; ++k) {
+                        const std::uint64_t v = words[i + k].load();
+                        entries[k] = {&words[i + k], v, v + 1};
+                    }
+                } while(!mcas(entries));
+            }
+        });
+    }
+    for(auto& w : workers) {
+        w.join();
+    }
+
+    std::uint64_t total = 0;
+    for(auto& w : words) {
+        total += w.load();
+    }
+    EXPECT_EQ(total, std::uint64_t(THREADS) * OPS * 2);
+}
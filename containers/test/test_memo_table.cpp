@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+#include "memo_table.hpp"
+
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+using namespace conc;
+
+class MemoTableTest : public ::testing::Test {
+protected:
+    void SetUp() override {}
+    void TearDown() override {}
+};
+
+TEST_F(MemoTableTest, ComputesOnce) {
+    memo_table<int, std::string> table;
+    int calls = 0;
+    auto compute = [&calls]() { ++calls; return std::string("value"); };
+
+    EXPECT_EQ(table.get_or_compute(1, compute), "value");
+    EXPECT_EQ(table.get_or_compute(1, compute), "value");
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(table.find(1), "value");
+    EXPECT_FALSE(table.find(2).has_value());
+    EXPECT_EQ(table.size(), 1);
+}
+
+TEST_F(MemoTableTest, EraseForcesRecompute) {
+    memo_table<int, int> table(4);
+    int calls = 0;
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(table.get_or_compute(i, [&calls, i]() { ++calls; return i * i; }), i * i);
+    }
+    EXPECT_EQ(table.size(), 100);
+
+    EXPECT_TRUE(table.erase(7));
+    EXPECT_FALSE(table.erase(7));
+    EXPECT_FALSE(table.contains(7));
+    EXPECT_EQ(table.get_or_compute(7, [&calls]() { ++calls; return -1; }), -1);
+    EXPECT_EQ(calls, 101);
+    EXPECT_EQ(table.find(8), 64);
+}
+
+TEST_F(MemoTableTest, ExceptionIsPropagatedAndForgotten) {
+    memo_table<int, int> table;
+    EXPECT_THROW(table.get_or_compute(1, []() -> int { throw std::runtime_error("backend down"); }),
+                 std::runtime_error);
+    EXPECT_FALSE(table.contains(1));
+    EXPECT_EQ(table.size(), 0);
+    EXPECT_EQ(table.get_or_compute(1, []() { return 5; }), 5);
+}
+
+TEST_F(MemoTableTest, SingleFlightUnderContention) {
+    memo_table<int, int> table;
+    const int num_threads = 32;
+    std::atomic<int> calls{0};
+    std::atomic<bool> start{false};
+    std::vector<int> results(num_threads);
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            while (!start.load()) {}
+            results[t] = table.get_or_compute(42, [&calls]() {
+                calls.fetch_add(1);
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                return 4242;
+            });
+        });
+    }
+    start.store(true);
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(calls.load(), 1);
+    for (int r : results) {
+        EXPECT_EQ(r, 4242);
+    }
+}
+
+TEST_F(MemoTableTest, WaitersReceiveException) {
+    memo_table<int, int> table;
+    const int num_threads = 8;
+    std::atomic<int> calls{0};
+    std::atomic<int> failures{0};
+    std::atomic<bool> start{false};
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&]() {
+            while (!start.load()) {}
+            try {
+                table.get_or_compute(1, [&calls]() -> int {
+                    calls.fetch_add(1);
+                    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                    throw std::runtime_error("failed");
+                });
+            } catch (const std::runtime_error&) {
+                failures.fetch_add(1);
+            }
+        });
+    }
+    start.store(true);
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    // late arrivals may start a second attempt after the first one was forgotten
+    EXPECT_GE(calls.load(), 1);
+    EXPECT_EQ(failures.load(), num_threads);
+    EXPECT_FALSE(table.contains(1));
+}
+
+TEST_F(MemoTableTest, ConcurrentMixedKeys) {
+    memo_table<int, int> table(64);
+    const int num_threads = 8;
+    const int keys = 1000;
+    std::vector<std::atomic<int>> calls(keys);
+    std::atomic<int> errors{0};
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < keys; ++i) {
+                int k = (i + t * 37) % keys;
+                int v = table.get_or_compute(k, [&calls, k]() {
+                    calls[k].fetch_add(1);
+                    return k + 1;
+                });
+                if (v != k + 1) {
+                    errors.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(errors.load(), 0);
+    EXPECT_EQ(table.size(), keys);
+    for (int k = 0; k < keys; ++k) {
+        ASSERT_EQ(calls[k].load(), 1);
+    }
+}
+
+TEST_F(MemoTableTest, EraseWhileReading) {
+    memo_table<int, int> table(16);
+    std::atomic<bool> stop{false};
+    std::atomic<int> errors{0};
+
+    std::thread eraser([&]() {
+        while (!stop.load()) {
+            for (int k = 0; k < 64; ++k) {
+                table.erase(k);
+            }
+        }
+    });
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&]() {
+            for (int i = 0; i < 50000; ++i) {
+                int k = i % 64;
+                if (table.get_or_compute(k, [k]() { return k * 3; }) != k * 3) {
+                    errors.fetch_add(1);
+                }
+                auto v = table.find(k);
+                if (v && *v != k * 3) {
+                    errors.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (auto& t : readers) {
+        t.join();
+    }
+    stop.store(true);
+    eraser.join();
+
+    EXPECT_EQ(errors.load(), 0);
+}
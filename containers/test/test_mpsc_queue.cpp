@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include "mpsc_queue.hpp"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace conc;
+
+namespace {
+
+struct item : mpsc_node {
+    explicit item(int p, int v) : producer(p), value(v) {}
+    int producer;
+    int value;
+};
+
+}
+
+TEST(MpscQueueTest, EmptyQueue) {
+    intrusive_mpsc_queue<item> q;
+    EXPECT_TRUE(q.empty());
+    EXPECT_TRUE(q.drained());
+    EXPECT_EQ(q.pop(), nullptr);
+}
+
+TEST(MpscQueueTest, FifoSingleThread) {
+    intrusive_mpsc_queue<item> q;
+    std::vector<std::unique_ptr<item>> items;
+    for(int i = 0; i < 10; ++i) {
+        items.push_back(std::make_unique<item>(0, i));
+        q.push(items.back().get());
+    }
+    EXPECT_FALSE(q.empty());
+    EXPECT_FALSE(q.drained());
+
+    for(int i = 0; i < 10; ++i) {
+        item* it = q.pop();
+        ASSERT_NE(it, nullptr);
+        EXPECT_EQ(it->value, i);
+    }
+    EXPECT_EQ(q.pop(), nullptr);
+    EXPECT_TRUE(q.empty());
+    EXPECT_TRUE(q.head_is_stub());
+    EXPECT_TRUE(q.drained());
+}
+
+TEST(MpscQueueTest, ReusesElementsAfterPop) {
+    intrusive_mpsc_queue<item> q;
+    item a(0, 1);
+    item b(0, 2);
+    for(int round = 0; round < 100; ++round) {
+        q.push(&a);
+        EXPECT_EQ(q.pop(), &a);
+        q.push(&b);
+        q.push(&a);
+        EXPECT_EQ(q.pop(), &b);
+        EXPECT_EQ(q.pop(), &a);
+        EXPECT_EQ(q.pop(), nullptr);
+    }
+}
+
+TEST(MpscQueueTest, ManyProducersKeepPerProducerOrder) {
+    constexpr int PRODUCERS = 4;
+    constexpr int PER_PRODUCER = 50000;
+    intrusive_mpsc_queue<item> q;
+
+    std::vector<std::thread> producers;
+    for(int p = 0; p < PRODUCERS; ++p) {
+        producers.emplace_back([&q, p]() {
+            for(int i = 0; i < PER_PRODUCER; ++i) {
+                q.push(new item(p, i));
+            }
+        });
+    }
+
+    std::vector<int> next(PRODUCERS, 0);
+    bool ordered = true;
+    for(int received = 0; received < PRODUCERS * PER_PRODUCER;) {
+        item* it = q.pop();
+        if(it == nullptr) {
+            std::this_thread::yield();
+            continue;
+        }
+        ordered = ordered && it->value == next[it->producer]++;
+        delete it;
+        ++received;
+    }
+    for(auto& t : producers) {
+        t.join();
+    }
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(q.pop(), nullptr);
+    EXPECT_TRUE(q.empty());
+}
@@ -634,3 +634,29 @@ TEST_F(QueueTest, HighContentionScenario) {
     EXPECT_GT(successful_ops.load(), 0);
 }
 
+
+TEST_F(QueueTest, DequeueWaitPreservesOrder) {
+    queue<int> q;
+    const int total = 2000;
+    std::vector<int> received;
+
+    std::thread consumer([&]() {
+        for (int i = 0; i < total; ++i) {
+            received.push_back(q.dequeue_wait());
+        }
+    });
+
+    for (int i = 0; i < total; ++i) {
+        q.enqueue(std::move(i));
+        if (i % 100 == 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+    consumer.join();
+
+    ASSERT_EQ(received.size(), static_cast<std::size_t>(total));
+    for (int i = 0; i < total; ++i) {
+        EXPECT_EQ(received[i], i);
+    }
+    EXPECT_FALSE(q.dequeue().has_value());
+}
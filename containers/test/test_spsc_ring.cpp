@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include "spsc_ring.hpp"
+
+#include <atomic>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+using namespace conc;
+
+TEST(SpscRingTest, CapacityRoundsUpToPowerOfTwo) {
+    EXPECT_EQ(spsc_ring<int>(5).capacity(), 8u);
+    EXPECT_EQ(spsc_ring<int>(16).capacity(), 16u);
+    EXPECT_EQ(spsc_ring<int>(0).capacity(), 2u);
+}
+
+TEST(SpscRingTest, FifoUntilFull) {
+    spsc_ring<int> ring(4);
+    EXPECT_FALSE(ring.try_pop());
+    for(int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(ring.try_push(int(i)));
+    }
+    EXPECT_FALSE(ring.try_push(99));
+    EXPECT_EQ(ring.size(), 4u);
+
+    for(int i = 0; i < 4; ++i) {
+        EXPECT_EQ(ring.try_pop(), i);
+    }
+    EXPECT_FALSE(ring.try_pop());
+    EXPECT_EQ(ring.size(), 0u);
+}
+
+TEST(SpscRingTest, BatchesWrapAround) {
+    spsc_ring<int> ring(8);
+    std::vector<int> in(6);
+    std::vector<int> out;
+    int next = 0;
+    for(int round = 0; round < 10; ++round) {
+        std::iota(in.begin(), in.end(), next);
+        EXPECT_EQ(ring.push_batch(in.begin(), in.end()), 6u);
+        next += 6;
+        EXPECT_EQ(ring.pop_batch(4, [&](int&& v) noexcept { out.push_back(v); }), 4u);
+        EXPECT_EQ(ring.pop_batch(100, [&](int&& v) noexcept { out.push_back(v); }), 2u);
+    }
+    std::vector<int> expected(60);
+    std::iota(expected.begin(), expected.end(), 0);
+    EXPECT_EQ(out, expected);
+}
+
+TEST(SpscRingTest, PushBatchStopsWhenFull) {
+    spsc_ring<int> ring(4);
+    std::vector<int> in = {1, 2, 3, 4, 5, 6};
+    EXPECT_EQ(ring.push_batch(in.begin(), in.end()), 4u);
+    EXPECT_EQ(ring.push_batch(in.begin() + 4, in.end()), 0u);
+    EXPECT_EQ(ring.try_pop(), 1);
+    EXPECT_EQ(ring.push_batch(in.begin() + 4, in.end()), 1u);
+}
+
+TEST(SpscRingTest, DestroysRemainingElements) {
+    auto tracker = std::make_shared<int>(0);
+    {
+        spsc_ring<std::shared_ptr<int>> ring(8);
+        for(int i = 0; i < 5; ++i) {
+            EXPECT_TRUE(ring.try_push(std::shared_ptr<int>(tracker)));
+        }
+        ring.try_pop();
+        EXPECT_EQ(tracker.use_count(), 5);
+    }
+    EXPECT_EQ(tracker.use_count(), 1);
+}
+
+TEST(SpscRingTest, ProducerConsumerTransfersInOrder) {
+    constexpr int N = 200000;
+    spsc_ring<int> ring(64);
+    std::thread producer([&]() {
+        std::vector<int> batch;
+        for(int i = 0; i < N; i += 7) {
+            batch.clear();
+            for(int j = i; j < std::min(N, i + 7); ++j) {
+                batch.push_back(j);
+            }
+            auto first = batch.begin();
+            while(first != batch.end()) {
+                first += static_cast<std::ptrdiff_t>(ring.push_batch(first, batch.end()));
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int expected = 0;
+    bool ordered = true;
+    while(expected < N) {
+        int v = ring.pop_wait();
+        ordered = ordered && v == expected;
+        ++expected;
+        ring.pop_batch(16, [&](int&& w) noexcept {
+            ordered = ordered && w == expected;
+            ++expected;
+        });
+    }
+    producer.join();
+    EXPECT_TRUE(ordered);
+    EXPECT_FALSE(ring.try_pop());
+}
+
+TEST(SpscRingTest, PopWaitWakesUp) {
+    spsc_ring<int> ring(4);
+    std::atomic<int> got{-1};
+    std::thread consumer([&]() { got.store(ring.pop_wait()); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(got.load(), -1);
+    EXPECT_TRUE(ring.try_push(42));
+    consumer.join();
+    EXPECT_EQ(got.load(), 42);
+}
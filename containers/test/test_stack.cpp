@@ -686,3 +686,49 @@ TEST_F(StackTest, BasicFunctionalityAfterStressTests) {
         EXPECT_EQ(result.value(), i);
     }
 }
+
+TEST_F(StackTest, PopWaitBlocksUntilPush) {
+    stack<int> s;
+    std::atomic<bool> popped{false};
+    int value = 0;
+
+    std::thread consumer([&]() {
+        value = s.pop_wait();
+        popped.store(true);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(popped.load());
+    s.push(7);
+    consumer.join();
+    EXPECT_EQ(value, 7);
+}
+
+TEST_F(StackTest, PopWaitManyConsumers) {
+    stack<int> s;
+    const int num_consumers = 4;
+    const int per_consumer = 500;
+    std::atomic<long> sum{0};
+    std::vector<std::thread> consumers;
+
+    for (int c = 0; c < num_consumers; ++c) {
+        consumers.emplace_back([&]() {
+            for (int i = 0; i < per_consumer; ++i) {
+                sum.fetch_add(s.pop_wait());
+            }
+        });
+    }
+
+    const int total = num_consumers * per_consumer;
+    for (int i = 1; i <= total; ++i) {
+        s.push(std::move(i));
+        if (i % 64 == 0) {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& t : consumers) {
+        t.join();
+    }
+    EXPECT_EQ(sum.load(), static_cast<long>(total) * (total + 1) / 2);
+    EXPECT_FALSE(s.pop().has_value());
+}
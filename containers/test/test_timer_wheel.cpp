@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+#include "timer_wheel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace conc;
+
+class TimerWheelTest : public ::testing::Test {
+protected:
+    timer_wheel<int> wheel;
+    std::vector<int> fired;
+
+    std::size_t advance(timer_wheel<int>::tick now) {
+        return wheel.advance(now, [this](std::span<int> batch) {
+            fired.insert(fired.end(), batch.begin(), batch.end());
+        });
+    }
+};
+
+TEST_F(TimerWheelTest, FiresAtDeadline) {
+    auto h = wheel.schedule(10, 1);
+    EXPECT_EQ(advance(9), 0u);
+    EXPECT_TRUE(h.pending());
+    EXPECT_EQ(advance(10), 1u);
+    EXPECT_TRUE(h.fired());
+    EXPECT_EQ(fired, (std::vector<int>{1}));
+    EXPECT_EQ(wheel.now(), 10u);
+}
+
+TEST_F(TimerWheelTest, PastDeadlineFiresOnNextAdvance) {
+    advance(100);
+    wheel.schedule(50, 7);
+    EXPECT_EQ(advance(100), 1u);
+    EXPECT_EQ(fired, (std::vector<int>{7}));
+}
+
+TEST_F(TimerWheelTest, BatchIsOrderedAcrossLevels) {
+    // one deadline per level and one past the wheel's range
+    const std::vector<timer_wheel<int>::tick> deadlines = {
+        3, 63, 64, 65, 4095, 4096, 5000, 262143, 262144, 300000, 16777215, 16777216, 40000000};
+    for (std::size_t i = deadlines.size(); i-- > 0;) {
+        wheel.schedule(deadlines[i], static_cast<int>(i));
+    }
+
+    for (std::size_t i = 0; i < deadlines.size(); ++i) {
+        fired.clear();
+        if (deadlines[i] > 0) {
+            EXPECT_EQ(advance(deadlines[i] - 1), 0u) << "deadline " << deadlines[i];
+        }
+        EXPECT_EQ(advance(deadlines[i]), 1u) << "deadline " << deadlines[i];
+        EXPECT_EQ(fired, (std::vector<int>{static_cast<int>(i)}));
+    }
+    EXPECT_EQ(wheel.filed(), 0u);
+}
+
+TEST_F(TimerWheelTest, LargeJumpDeliversOneBatch) {
+    for (int i = 0; i < 1000; ++i) {
+        wheel.schedule(static_cast<timer_wheel<int>::tick>(i * 37 % 9000 + 1), i);
+    }
+    std::size_t batches = 0;
+    const auto delivered = wheel.advance(10000, [&](std::span<int> batch) {
+        ++batches;
+        fired.insert(fired.end(), batch.begin(), batch.end());
+    });
+    EXPECT_EQ(delivered, 1000u);
+    EXPECT_EQ(batches, 1u);
+    std::sort(fired.begin(), fired.end());
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(fired[i], i);
+    }
+}
+
+TEST_F(TimerWheelTest, CancelLeavesTombstone) {
+    auto keep = wheel.schedule(20, 1);
+    auto drop = wheel.schedule(20, 2);
+    advance(5);
+    EXPECT_EQ(wheel.filed(), 2u);
+
+    EXPECT_TRUE(drop.cancel());
+    EXPECT_FALSE(drop.cancel());
+    EXPECT_FALSE(drop.pending());
+
+    advance(20);
+    EXPECT_EQ(fired, (std::vector<int>{1}));
+    EXPECT_FALSE(keep.cancel());
+    EXPECT_FALSE(drop.fired());
+    EXPECT_EQ(wheel.filed(), 0u);
+}
+
+TEST_F(TimerWheelTest, DroppedHandleStillFires) {
+    wheel.schedule(3, 9);
+    {
+        auto h = wheel.schedule(4, 10);
+        auto moved = std::move(h);
+        EXPECT_FALSE(h.pending());
+        EXPECT_TRUE(moved.pending());
+    }
+    advance(4);
+    EXPECT_EQ(fired, (std::vector<int>{9, 10}));
+}
+
+TEST_F(TimerWheelTest, PendingPayloadsAreDestroyed) {
+    auto counter = std::make_shared<int>(0);
+    {
+        timer_wheel<std::shared_ptr<int>> w;
+        auto h = w.schedule(1000, counter);
+        w.schedule(5, counter);
+        w.advance(2, [](std::span<std::shared_ptr<int>>) {});
+        EXPECT_EQ(counter.use_count(), 3);
+    }
+    EXPECT_EQ(counter.use_count(), 1);
+}
+
+TEST_F(TimerWheelTest, ConcurrentProducersSingleConsumer) {
+    const int num_producers = 4;
+    const int per_producer = 5000;
+    std::atomic<int> done{0};
+    std::atomic<long> cancelled{0};
+    std::vector<std::thread> producers;
+
+    for (int p = 0; p < num_producers; ++p) {
+        producers.emplace_back([&, p]() {
+            for (int i = 0; i < per_producer; ++i) {
+                const int id = p * per_producer + i;
+                auto h = wheel.schedule(static_cast<timer_wheel<int>::tick>(id % 5000 + 1), id);
+                if (id % 7 == 0 && h.cancel()) {
+                    cancelled.fetch_add(1);
+                }
+            }
+            done.fetch_add(1);
+        });
+    }
+
+    timer_wheel<int>::tick now = 0;
+    while (done.load() != num_producers) {
+        advance(++now % 6000);
+        std::this_thread::yield();
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+    advance(std::max<timer_wheel<int>::tick>(now, 5001));
+
+    std::sort(fired.begin(), fired.end());
+    EXPECT_TRUE(std::adjacent_find(fired.begin(), fired.end()) == fired.end());
+    EXPECT_EQ(fired.size() + cancelled.load(), static_cast<std::size_t>(num_producers * per_producer));
+    EXPECT_EQ(wheel.filed(), 0u);
+}
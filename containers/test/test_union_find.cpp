@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include "union_find.hpp"
+
+#include <numeric>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace conc;
+
+namespace {
+
+// sequential reference
+struct plain_dsu {
+    explicit plain_dsu(std::size_t n) : parent(n) {
+        std::iota(parent.begin(), parent.end(), 0u);
+    }
+
+    std::uint32_t find(std::uint32_t x) {
+        while(parent[x] != x) {
+            x = parent[x] = parent[parent[x]];
+        }
+        return x;
+    }
+
+    void unite(std::uint32_t a, std::uint32_t b) {
+        parent[find(a)] = find(b);
+    }
+
+    std::vector<std::uint32_t> parent;
+};
+
+std::vector<std::pair<std::uint32_t, std::uint32_t>> random_edges(std::size_t n, std::size_t count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<std::uint32_t> pick(0, static_cast<std::uint32_t>(n - 1));
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> edges(count);
+    for(auto& e : edges) {
+        e = {pick(rng), pick(rng)};
+    }
+    return edges;
+}
+
+}
+
+TEST(UnionFindTest, StartsAsSingletons) {
+    union_find<> uf(10);
+    EXPECT_EQ(uf.size(), 10u);
+    EXPECT_EQ(uf.sets(), 10u);
+    for(std::uint32_t i = 0; i < 10; ++i) {
+        EXPECT_EQ(uf.find(i), i);
+        EXPECT_FALSE(uf.same_set(i, (i + 1) % 10));
+    }
+}
+
+TEST(UnionFindTest, UniteMergesOnce) {
+    union_find<> uf(6);
+    EXPECT_TRUE(uf.unite(0, 1));
+    EXPECT_TRUE(uf.unite(2, 3));
+    EXPECT_FALSE(uf.unite(1, 0));
+    EXPECT_TRUE(uf.unite(1, 3));
+    EXPECT_FALSE(uf.unite(0, 2));
+    EXPECT_TRUE(uf.same_set(0, 3));
+    EXPECT_FALSE(uf.same_set(0, 4));
+    EXPECT_EQ(uf.find(0), uf.find(2));
+    EXPECT_EQ(uf.sets(), 3u);
+}
+
+TEST(UnionFindTest, BatchMatchesSequentialReference) {
+    constexpr std::size_t N = 5000;
+    const auto edges = random_edges(N, 3000, 1);
+    union_find<std::uint64_t> uf(N);
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> wide(edges.begin(), edges.end());
+    const std::size_t merged = uf.unite(wide);
+
+    plain_dsu reference(N);
+    for(auto [a, b] : edges) {
+        reference.unite(a, b);
+    }
+    std::size_t reference_sets = 0;
+    for(std::uint32_t i = 0; i < N; ++i) {
+        reference_sets += reference.find(i) == i ? 1 : 0;
+    }
+    EXPECT_EQ(merged, N - reference_sets);
+    EXPECT_EQ(uf.sets(), reference_sets);
+    for(std::uint32_t i = 0; i < N; i += 7) {
+        for(std::uint32_t j = 1; j < N; j += 131) {
+            ASSERT_EQ(uf.same_set(i, j), reference.find(i) == reference.find(j));
+        }
+    }
+}
+
+TEST(UnionFindTest, ChainStaysShallow) {
+    constexpr std::uint32_t N = 100000;
+    union_find<> uf(N);
+    for(std::uint32_t i = 1; i < N; ++i) {
+        uf.unite(i - 1, i);
+    }
+    EXPECT_EQ(uf.sets(), 1u);
+    const std::uint32_t root = uf.find(0);
+    for(std::uint32_t i = 0; i < N; ++i) {
+        ASSERT_EQ(uf.find(i), root);
+    }
+}
+
+TEST(UnionFindTest, ConcurrentUnitesMatchReference) {
+    constexpr std::size_t N = 20000;
+    constexpr int THREADS = 4;
+    const auto edges = random_edges(N, 16000, 7);
+    union_find<> uf(N);
+
+    std::vector<std::thread> threads;
+    std::vector<std::size_t> merged(THREADS);
+    for(int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t]() {
+            const std::size_t begin = edges.size() * t / THREADS;
+            const std::size_t end = edges.size() * (t + 1) / THREADS;
+            merged[t] = uf.unite(std::span(edges).subspan(begin, end - begin));
+            // readers race with the other writers
+            for(std::size_t i = begin; i < end; i += 16) {
+                EXPECT_TRUE(uf.same_set(edges[i].first, edges[i].second));
+            }
+        });
+    }
+    for(auto& t : threads) {
+        t.join();
+    }
+
+    plain_dsu reference(N);
+    for(auto [a, b] : edges) {
+        reference.unite(a, b);
+    }
+    std::size_t reference_sets = 0;
+    for(std::uint32_t i = 0; i < N; ++i) {
+        reference_sets += reference.find(i) == i ? 1 : 0;
+        ASSERT_EQ(uf.same_set(i, static_cast<std::uint32_t>((i * 7919) % N)), reference.find(i) == reference.find((i * 7919) % N));
+    }
+    EXPECT_EQ(merged[0] + merged[1] + merged[2] + merged[3], N - reference_sets);
+    EXPECT_EQ(uf.sets(), reference_sets);
+}
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <new>
+#include <sharded_counter.hpp>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace conc {
+
+// Hierarchical hashed timer wheel (Varghese, Lauck, "Hashed and Hierarchical Timing Wheels"):
+// LEVELS wheels of 64 slots, level L covering 64^(L+1) ticks, timers cascade one level down
+// whenever a lower wheel wraps. Producers schedule from any thread with a single CAS on their
+// shard's MPSC inbox; one consumer thread drains the inboxes into the wheel, advances time and
+// receives expired payloads in batches. Cancel marks the timer as a tombstone in O(1), the
+// consumer drops it when its slot comes up. Deadlines past the wheel's range are parked in the
+// farthest top-level slot and re-filed when it cascades.
+template<typename T>
+requires(std::is_move_constructible_v<T> && std::is_nothrow_destructible_v<T>)
+class timer_wheel {
+   public:
+    using tick = std::uint64_t;
+
+   private:
+    static constexpr std::size_t SLOT_BITS = 6;
+    static constexpr std::size_t SLOTS = std::size_t(1) << SLOT_BITS;
+    static constexpr std::size_t LEVELS = 4;
+    static constexpr tick RANGE = tick(1) << (SLOT_BITS * LEVELS);
+    static constexpr std::size_t SHARDS = 16;
+
+    static constexpr std::uint32_t PENDING = 0;
+    static constexpr std::uint32_t CANCELLED = 1;
+    static constexpr std::uint32_t FIRED = 2;
+
+    struct timer {
+        timer(tick d, T&& p) : deadline(d), payload(std::move(p)) {}
+
+        const tick deadline;
+        T payload;
+        // inbox link while queued, slot link once filed
+        timer* next = nullptr;
+        std::atomic<std::uint32_t> state = PENDING;
+        // the wheel and the handle
+        std::atomic<std::uint32_t> refs = 2;
+    };
+
+    struct alignas(std::hardware_destructive_interference_size) inbox {
+        std::atomic<timer*> head = nullptr;
+    };
+
+    static void release(timer* t) noexcept {
+        if(t->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete t;
+        }
+    }
+
+   public:
+    // owner's view of a scheduled timer, dropping it does not cancel the timer
+    class handle {
+       public:
+        handle() noexcept = default;
+        handle(handle const&) = delete;
+        handle(handle&& other) noexcept : m_timer(std::exchange(other.m_timer, nullptr)) {}
+        handle& operator=(handle const&) = delete;
+        handle& operator=(handle&& other) noexcept {
+            if(this != &other) {
+                reset();
+                m_timer = std::exchange(other.m_timer, nullptr);
+            }
+            return *this;
+        }
+
+        ~handle() {
+            reset();
+        }
+
+       public:
+        // true when the timer had not fired yet and now never will
+        bool cancel() noexcept {
+            if(m_timer == nullptr) {
+                return false;
+            }
+            std::uint32_t expected = PENDING;
+            return m_timer->state.compare_exchange_strong(expected, CANCELLED, std::memory_order_acq_rel);
+        }
+
+        [[nodiscard]]
+        bool pending() const noexcept {
+            return m_timer != nullptr && m_timer->state.load(std::memory_order_acquire) == PENDING;
+        }
+
+        [[nodiscard]]
+        bool fired() const noexcept {
+            return m_timer != nullptr && m_timer->state.load(std::memory_order_acquire) == FIRED;
+        }
+
+        void reset() noexcept {
+            if(m_timer != nullptr) {
+                release(std::exchange(m_timer, nullptr));
+            }
+        }
+
+       private:
+        friend class timer_wheel;
+        explicit handle(timer* t) noexcept : m_timer(t) {}
+
+       private:
+        timer* m_timer = nullptr;
+    };
+
+   public:
+    explicit timer_wheel(tick start = 0) noexcept : m_now(start) {}
+
+    timer_wheel(timer_wheel const&) = delete;
+    timer_wheel(timer_wheel&& other) = delete;
+    timer_wheel& operator=(timer_wheel const&) = delete;
+    timer_wheel& operator=(timer_wheel &&) = delete;
+
+    //not thread-safe
+    ~timer_wheel() {
+        for(auto& shard : m_inboxes) {
+            drop_list(shard.head.load(std::memory_order_acquire));
+        }
+        for(auto& level : m_slots) {
+            for(timer* head : level) {
+                drop_list(head);
+            }
+        }
+    }
+
+   public:
+    // any thread; the timer fires in the first advance whose `now` reaches the deadline
+    handle schedule(tick deadline, T payload) {
+        timer* t = new timer(deadline, std::move(payload));
+        auto& head = m_inboxes[this_thread_slot(SHARDS)].head;
+        t->next = head.load(std::memory_order_relaxed);
+        while(!head.compare_exchange_weak(t->next, t, std::memory_order_release, std::memory_order_relaxed));
+        return handle(t);
+    }
+
+    // consumer thread only: moves time forward to `now` and hands every payload that expired on
+    // the way to deliver as one std::span<T>, ordered by tick; returns the number delivered
+    template<typename F>
+    requires(std::is_invocable_v<F&, std::span<T>>)
+    std::size_t advance(tick now, F&& deliver) {
+        drain_inboxes();
+
+        while(m_now < now) {
+            // an empty wheel has nothing to cascade, jump straight to the target
+            if(m_filed == 0) {
+                m_now = now;
+                break;
+            }
+
+            // wrapped wheels hand their next slot down, timers due at t expire right away
+            const tick t = ++m_now;
+            for(std::size_t level = LEVELS - 1; level > 0; --level) {
+                if((t & ((tick(1) << (level * SLOT_BITS)) - 1)) == 0) {
+                    refile(std::exchange(m_slots[level][(t >> (level * SLOT_BITS)) & (SLOTS - 1)], nullptr), t);
+                }
+            }
+            refile(std::exchange(m_slots[0][t & (SLOTS - 1)], nullptr), t);
+        }
+
+        const std::size_t delivered = m_batch.size();
+        if(delivered != 0) {
+            struct clear_batch {
+                std::vector<T>& batch;
+                ~clear_batch() { batch.clear(); }
+            } guard{m_batch};
+            deliver(std::span<T>(m_batch));
+        }
+        return delivered;
+    }
+
+    // consumer thread only
+    [[nodiscard]]
+    tick now() const noexcept {
+        return m_now;
+    }
+
+    // consumer thread only: timers in the wheel including tombstones, not counting inboxes
+    [[nodiscard]]
+    std::size_t filed() const noexcept {
+        return m_filed;
+    }
+
+   private:
+    void drain_inboxes() {
+        for(auto& shard : m_inboxes) {
+            timer* list = shard.head.exchange(nullptr, std::memory_order_acquire);
+            while(list != nullptr) {
+                timer* next = list->next;
+                file(list, m_now);
+                list = next;
+            }
+        }
+    }
+
+    // files or expires every timer of a slot list relative to `base`
+    void refile(timer* list, tick base) {
+        while(list != nullptr) {
+            timer* next = list->next;
+            --m_filed;
+            file(list, base);
+            list = next;
+        }
+    }
+
+    // base: last tick that has been fully processed
+    void file(timer* t, tick base) {
+        if(t->deadline <= base || t->state.load(std::memory_order_relaxed) == CANCELLED) {
+            expire(t);
+            return;
+        }
+
+        tick delta = t->deadline - base;
+        tick d = t->deadline;
+        if(delta >= RANGE) {
+            delta = RANGE - 1;
+            d = base + delta;
+        }
+        // delta in [64^L, 64^(L+1)) lands on level L, whose slot for d comes up strictly after base
+        const std::size_t level = (std::bit_width(delta) - 1) / SLOT_BITS;
+        timer*& slot = m_slots[level][(d >> (level * SLOT_BITS)) & (SLOTS - 1)];
+        t->next = slot;
+        slot = t;
+        ++m_filed;
+    }
+
+    void expire(timer* t) {
+        std::uint32_t expected = PENDING;
+        if(t->state.compare_exchange_strong(expected, FIRED, std::memory_order_acq_rel)) {
+            m_batch.push_back(std::move(t->payload));
+        }
+        release(t);
+    }
+
+    static void drop_list(timer* list) noexcept {
+        while(list != nullptr) {
+            timer* next = list->next;
+            release(list);
+            list = next;
+        }
+    }
+
+   private:
+    std::array<inbox, SHARDS> m_inboxes;
+
+    // consumer-owned state
+    tick m_now;
+    std::size_t m_filed = 0;
+    std::array<std::array<timer*, SLOTS>, LEVELS> m_slots{};
+    std::vector<T> m_batch;
+};
+
+}
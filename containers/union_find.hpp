@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <memory>
+#include <sharded_counter.hpp>
+#include <span>
+#include <utility>
+
+namespace conc {
+
+// Concurrent union-find (Jayanti, Tarjan, "A Randomized Concurrent Algorithm for Disjoint Set
+// Union", PODC 2016): a flat array of atomic parent words, roots are linked by a single CAS in
+// a random total order fixed per instance, and finds halve the path by CASing each node to its
+// grandparent (path splitting). Every operation is lock-free; a failed CAS only means another
+// thread made progress on the same path.
+template<std::unsigned_integral Index = std::uint32_t>
+class union_find {
+   public:
+    using index_type = Index;
+
+    explicit union_find(std::size_t n, std::uint64_t seed = 0x9E3779B97F4A7C15ull)
+        : m_size(n), m_seed(seed), m_parent(std::make_unique<std::atomic<Index>[]>(n)) {
+        for(std::size_t i = 0; i < n; ++i) {
+            m_parent[i].store(static_cast<Index>(i), std::memory_order_relaxed);
+        }
+    }
+
+    union_find(union_find const&) = delete;
+    union_find(union_find&& other) = delete;
+    union_find& operator=(union_find const&) = delete;
+    union_find& operator=(union_find &&) = delete;
+
+   public:
+    // root of x's set at some point during the call
+    Index find(Index x) noexcept {
+        while(true) {
+            const Index parent = m_parent[x].load(std::memory_order_acquire);
+            if(parent == x) {
+                return x;
+            }
+            const Index grandparent = m_parent[parent].load(std::memory_order_acquire);
+            if(grandparent != parent) {
+                // splitting: a lost race means someone else shortened the path already
+                Index expected = parent;
+                m_parent[x].compare_exchange_weak(expected, grandparent, std::memory_order_release, std::memory_order_relaxed);
+            }
+            x = parent;
+        }
+    }
+
+    // merges the sets of a and b, false when they were one set already
+    bool unite(Index a, Index b) noexcept {
+        while(true) {
+            a = find(a);
+            b = find(b);
+            if(a == b) {
+                return false;
+            }
+            // the lower root in the random order goes under the higher one, which keeps the
+            // expected depth logarithmic whatever order the unions come in
+            if(before(b, a)) {
+                std::swap(a, b);
+            }
+            Index expected = a;
+            if(m_parent[a].compare_exchange_strong(expected, b, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                m_unions.increment();
+                return true;
+            }
+        }
+    }
+
+    // unites every pair of the batch, returns how many merged two sets
+    std::size_t unite(std::span<const std::pair<Index, Index>> edges) noexcept {
+        std::size_t merged = 0;
+        for(const auto& [a, b] : edges) {
+            merged += unite(a, b) ? 1 : 0;
+        }
+        return merged;
+    }
+
+    // linearizable: true when a and b were in one set at some point during the call
+    bool same_set(Index a, Index b) noexcept {
+        while(true) {
+            a = find(a);
+            b = find(b);
+            if(a == b) {
+                return true;
+            }
+            // a still being a root means a and b were apart when b was found
+            if(m_parent[a].load(std::memory_order_acquire) == a) {
+                return false;
+            }
+        }
+    }
+
+    [[nodiscard]]
+    std::size_t size() const noexcept {
+        return m_size;
+    }
+
+    // exact once unions quiesce
+    [[nodiscard]]
+    std::size_t sets() const noexcept {
+        return m_size - static_cast<std::size_t>(m_unions.load());
+    }
+
+   private:
+    // random total order on the elements, ties in the hash broken by index
+    bool before(Index a, Index b) const noexcept {
+        const std::uint64_t ha = mix(a);
+        const std::uint64_t hb = mix(b);
+        return ha < hb || (ha == hb && a < b);
+    }
+
+    std::uint64_t mix(Index x) const noexcept {
+        std::uint64_t z = static_cast<std::uint64_t>(x) + m_seed;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+   private:
+    const std::size_t m_size;
+    const std::uint64_t m_seed;
+    const std::unique_ptr<std::atomic<Index>[]> m_parent;
+    sharded_counter m_unions;
+};
+
+}
@@ -0,0 +1,221 @@
+#pragma once
+
+#include "thread_pool.hpp"
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <mpsc_queue.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace conc {
+
+template<typename A>
+class actor_ref;
+
+// actors spawned by a runtime are scheduled on its pool and yield the worker after `batch`
+// messages; the runtime has to outlive the processing of every message sent to them
+class actor_runtime {
+   public:
+    explicit actor_runtime(thread_pool& pool, std::size_t batch = 64) noexcept : m_pool(pool), m_batch(std::max<std::size_t>(batch, 1)) {}
+
+    actor_runtime(actor_runtime const&) = delete;
+    actor_runtime(actor_runtime&& other) = delete;
+    actor_runtime& operator=(actor_runtime const&) = delete;
+    actor_runtime& operator=(actor_runtime &&) = delete;
+
+   public:
+    template<typename A, typename... Args>
+    requires(std::is_constructible_v<A, Args...>)
+    actor_ref<A> spawn(Args&&... args);
+
+    [[nodiscard]]
+    thread_pool& pool() const noexcept {
+        return m_pool;
+    }
+
+    [[nodiscard]]
+    std::size_t batch() const noexcept {
+        return m_batch;
+    }
+
+   private:
+    thread_pool& m_pool;
+    const std::size_t m_batch;
+};
+
+// Actor with an intrusive Vyukov MPSC mailbox, derived classes implement receive. An idle actor
+// is nothing but its mailbox and a state word, it is handed to the pool only by the send that
+// finds it idle, and a worker runs up to the runtime's batch of messages per turn before it
+// requeues the actor behind the other runnable ones. receive is never called concurrently with
+// itself; an exception escaping it terminates, like one escaping a detached task.
+// Actors are reference counted through actor_ref and deleted once the last reference is gone
+// and the mailbox is processed.
+template<typename Msg>
+requires(std::is_move_constructible_v<Msg> && std::is_nothrow_destructible_v<Msg>)
+class actor : private detail::task_base {
+   private:
+    static constexpr std::uint32_t IDLE = 0;
+    static constexpr std::uint32_t SCHEDULED = 1;
+
+    struct message final : mpsc_node {
+        explicit message(Msg&& m) : value(std::move(m)) {}
+        Msg value;
+    };
+
+   public:
+    using message_type = Msg;
+
+    actor() noexcept = default;
+    actor(actor const&) = delete;
+    actor(actor&& other) = delete;
+    actor& operator=(actor const&) = delete;
+    actor& operator=(actor &&) = delete;
+
+    //not thread-safe
+    ~actor() override {
+        while(message* m = m_mailbox.pop()) {
+            delete m;
+        }
+    }
+
+   public:
+    // any thread
+    void send(Msg msg) {
+        m_mailbox.push(new message(std::move(msg)));
+        // pairs with the idle transition in run: either we see the actor idle or it sees the message
+        if(m_state.load(std::memory_order_seq_cst) == IDLE && m_state.exchange(SCHEDULED, std::memory_order_seq_cst) == IDLE) {
+            // the turn holds a reference, the sender's keeps the actor alive until then
+            m_refs.fetch_add(1, std::memory_order_relaxed);
+            m_runtime->pool().post(this);
+        }
+    }
+
+   protected:
+    virtual void receive(Msg&& msg) = 0;
+
+   private:
+    template<typename A>
+    friend class actor_ref;
+    friend class actor_runtime;
+
+    void run() noexcept override {
+        for(std::size_t i = 0; i < m_runtime->batch(); ++i) {
+            message* m = m_mailbox.pop();
+            if(m == nullptr) {
+                break;
+            }
+            receive(std::move(m->value));
+            delete m;
+        }
+
+        // batch used up or a sender in the middle of a push: stay scheduled, behind the others
+        if(!m_mailbox.head_is_stub()) {
+            m_runtime->pool().repost(this);
+            return;
+        }
+
+        // from the store on another turn may start, so only the atomic tail is looked at
+        m_state.store(IDLE, std::memory_order_seq_cst);
+        if(!m_mailbox.drained() && m_state.exchange(SCHEDULED, std::memory_order_seq_cst) == IDLE) {
+            m_runtime->pool().repost(this);
+            return;
+        }
+        release();
+    }
+
+    void acquire() noexcept {
+        m_refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release() noexcept {
+        if(m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+   private:
+    intrusive_mpsc_queue<message> m_mailbox;
+    std::atomic<std::uint32_t> m_state = IDLE;
+    // actor_refs and a scheduled turn
+    std::atomic<std::uint32_t> m_refs = 0;
+    actor_runtime* m_runtime = nullptr;
+};
+
+// counted reference to an actor spawned by an actor_runtime
+template<typename A>
+class actor_ref {
+   public:
+    using message_type = typename A::message_type;
+
+    actor_ref() noexcept = default;
+    actor_ref(actor_ref const& other) noexcept : m_actor(other.m_actor) {
+        if(m_actor != nullptr) {
+            as_base()->acquire();
+        }
+    }
+    actor_ref(actor_ref&& other) noexcept : m_actor(std::exchange(other.m_actor, nullptr)) {}
+    actor_ref& operator=(actor_ref const& other) noexcept {
+        actor_ref(other).swap(*this);
+        return *this;
+    }
+    actor_ref& operator=(actor_ref&& other) noexcept {
+        actor_ref(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    ~actor_ref() {
+        reset();
+    }
+
+   public:
+    void send(message_type msg) const {
+        m_actor->send(std::move(msg));
+    }
+
+    // the actor's own state belongs to receive, reading it from outside is up to the caller
+    A* operator->() const noexcept {
+        return m_actor;
+    }
+
+    [[nodiscard]]
+    explicit operator bool() const noexcept {
+        return m_actor != nullptr;
+    }
+
+    void reset() noexcept {
+        if(m_actor != nullptr) {
+            actor<message_type>* base = as_base();
+            m_actor = nullptr;
+            base->release();
+        }
+    }
+
+    void swap(actor_ref& other) noexcept {
+        std::swap(m_actor, other.m_actor);
+    }
+
+   private:
+    friend class actor_runtime;
+    explicit actor_ref(A* a) noexcept : m_actor(a) {}
+
+    actor<message_type>* as_base() const noexcept {
+        return m_actor;
+    }
+
+   private:
+    A* m_actor = nullptr;
+};
+
+template<typename A, typename... Args>
+requires(std::is_constructible_v<A, Args...>)
+actor_ref<A> actor_runtime::spawn(Args&&... args) {
+    static_assert(std::derived_from<A, actor<typename A::message_type>>, "A must derive from actor<message_type>");
+    A* a = new A(std::forward<Args>(args)...);
+    actor<typename A::message_type>* base = a;
+    base->m_runtime = this;
+    base->m_refs.store(1, std::memory_order_relaxed);
+    return actor_ref<A>(a);
+}
+
+}
@@ -0,0 +1,264 @@
+#pragma once
+
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <allocator.hpp>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace conc {
+
+enum class reduce_order {
+    // partials are combined per worker, in whatever grouping and order the scheduling produced,
+    // so the operation has to be associative and commutative
+    relaxed,
+    // fixed chunks independent of thread count and scheduling, combined left to right, so
+    // non-associative operations such as floating-point sums give bit-identical results
+    deterministic,
+};
+
+namespace detail {
+
+// default grain: enough chunks for stealing to balance load, few enough to amortize a spawn
+inline std::size_t auto_grain(std::size_t n, std::size_t workers) noexcept {
+    return std::max<std::size_t>(1, n / (workers * 16));
+}
+
+// chunk size for deterministic reductions, a function of n only
+inline std::size_t fixed_grain(std::size_t n) noexcept {
+    return std::max<std::size_t>(1024, n / 256);
+}
+
+template<typename T>
+struct alignas(std::hardware_destructive_interference_size) padded {
+    T value;
+};
+
+// Lazy binary splitting (Tzannes, Caragea, Barua, Vishkin, PPoPP 2010): the range is processed
+// grain by grain and its upper half is split off as a stealable task only while the worker's own
+// deque is empty, so splitting happens where thieves are actually looking for work and a busy
+// machine runs big sequential chunks. body(begin, end) processes a chunk.
+template<typename Body>
+void split_lazily(thread_pool& pool, std::size_t begin, std::size_t end, std::size_t grain, const Body& body) {
+    std::vector<task_future<void>> spawned;
+    // spawned halves reference body, wait for them even when our own chunk throws
+    struct join_all {
+        std::vector<task_future<void>>& futures;
+        ~join_all() {
+            for(auto& f : futures) {
+                if(f.valid()) {
+                    f.wait();
+                }
+            }
+        }
+    } guard{spawned};
+
+    while(end - begin > grain) {
+        if(thread_pool::local_queue_empty() && end - begin >= 2 * grain) {
+            const std::size_t middle = begin + (end - begin) / 2;
+            spawned.push_back(pool.submit([&pool, middle, end, grain, &body]() {
+                split_lazily(pool, middle, end, grain, body);
+            }));
+            end = middle;
+        } else {
+            body(begin, begin + grain);
+            begin += grain;
+        }
+    }
+    body(begin, end);
+
+    for(auto& f : spawned) {
+        f.get();
+    }
+}
+
+// runs f on a worker of the pool, directly when already on one
+template<typename F>
+void run_on(thread_pool& pool, F&& f) {
+    if(pool.owns_current_thread()) {
+        f();
+    } else {
+        pool.submit([&f]() { f(); }).get();
+    }
+}
+
+}
+
+// f(i) for every i in [first, last); grain 0 picks one from the range and the pool size
+template<std::integral I, typename F>
+requires(std::is_invocable_v<const F&, I>)
+void parallel_for(thread_pool& pool, I first, I last, const F& f, std::size_t grain = 0) {
+    if(first >= last) {
+        return;
+    }
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    grain = grain != 0 ? grain : detail::auto_grain(n, pool.size());
+
+    detail::run_on(pool, [&]() {
+        detail::split_lazily(pool, 0, n, grain, [&](std::size_t b, std::size_t e) {
+            for(std::size_t i = b; i < e; ++i) {
+                f(static_cast<I>(first + static_cast<I>(i)));
+            }
+        });
+    });
+}
+
+// combine(identity, ..., transform(i)) over [first, last); identity must be the neutral element
+// of combine. Relaxed order accumulates into a cache-line aligned slot per worker, which may run
+// chunks from anywhere in the range, so combine must be associative and commutative there;
+// deterministic order keeps one slot per fixed chunk and combines them left to right.
+template<std::integral I, typename T, typename Transform, typename Combine>
+requires(std::is_invocable_r_v<T, const Transform&, I> && std::is_invocable_r_v<T, const Combine&, T, T>)
+T parallel_reduce(thread_pool& pool, I first, I last, T identity, const Transform& transform, const Combine& combine,
+                  reduce_order order = reduce_order::relaxed, std::size_t grain = 0) {
+    if(first >= last) {
+        return identity;
+    }
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    using slot = detail::padded<T>;
+    auto at = [first](std::size_t i) { return static_cast<I>(first + static_cast<I>(i)); };
+
+    if(order == reduce_order::relaxed) {
+        grain = grain != 0 ? grain : detail::auto_grain(n, pool.size());
+        // the extra slot belongs to a thread outside the pool, which never runs chunks here
+        std::vector<slot, cache_aligned_alloc<slot>> partials(pool.size() + 1, slot{identity});
+
+        detail::run_on(pool, [&]() {
+            detail::split_lazily(pool, 0, n, grain, [&](std::size_t b, std::size_t e) {
+                T& acc = partials[pool.current_worker_index()].value;
+                for(std::size_t i = b; i < e; ++i) {
+                    acc = combine(std::move(acc), transform(at(i)));
+                }
+            });
+        });
+
+        T result = std::move(identity);
+        for(auto& p : partials) {
+            result = combine(std::move(result), std::move(p.value));
+        }
+        return result;
+    }
+
+    grain = grain != 0 ? grain : detail::fixed_grain(n);
+    const std::size_t chunks = (n + grain - 1) / grain;
+    std::vector<slot, cache_aligned_alloc<slot>> partials(chunks, slot{identity});
+
+    // one chunk per index, so chunk boundaries never depend on how the work was split
+    parallel_for(pool, std::size_t(0), chunks, [&](std::size_t c) {
+        T acc = partials[c].value;
+        const std::size_t end = std::min(n, (c + 1) * grain);
+        for(std::size_t i = c * grain; i < end; ++i) {
+            acc = combine(std::move(acc), transform(at(i)));
+        }
+        partials[c].value = std::move(acc);
+    }, 1);
+
+    T result = std::move(identity);
+    for(auto& p : partials) {
+        result = combine(std::move(result), std::move(p.value));
+    }
+    return result;
+}
+
+// inclusive scan of [first, last) into out with an associative op: blocks are reduced in
+// parallel, their totals scanned sequentially, then every block is scanned from its offset
+template<std::random_access_iterator In, std::random_access_iterator Out, typename Op = std::plus<>>
+requires(std::is_invocable_v<const Op&, std::iter_value_t<In>, std::iter_value_t<In>>)
+Out parallel_scan(thread_pool& pool, In first, In last, Out out, const Op& op = {}) {
+    using T = std::iter_value_t<In>;
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    if(n == 0) {
+        return out;
+    }
+
+    const std::size_t blocks = std::min(n, pool.size() * 4);
+    const std::size_t block = (n + blocks - 1) / blocks;
+    std::vector<detail::padded<T>, cache_aligned_alloc<detail::padded<T>>> totals(blocks);
+
+    parallel_for(pool, std::size_t(0), blocks, [&](std::size_t b) {
+        const std::size_t begin = b * block;
+        const std::size_t end = std::min(n, begin + block);
+        if(begin >= end) {
+            return;
+        }
+        T acc = first[begin];
+        for(std::size_t i = begin + 1; i < end; ++i) {
+            acc = op(std::move(acc), first[i]);
+        }
+        totals[b].value = std::move(acc);
+    }, 1);
+
+    // totals[b] becomes the sum of every block before b; block 0 has no offset
+    const std::size_t used = (n + block - 1) / block;
+    for(std::size_t b = 1; b + 1 < used; ++b) {
+        totals[b].value = op(totals[b - 1].value, totals[b].value);
+    }
+
+    parallel_for(pool, std::size_t(0), used, [&](std::size_t b) {
+        const std::size_t begin = b * block;
+        const std::size_t end = std::min(n, begin + block);
+        T acc = b == 0 ? first[begin] : op(totals[b - 1].value, first[begin]);
+        out[begin] = acc;
+        for(std::size_t i = begin + 1; i < end; ++i) {
+            acc = op(std::move(acc), first[i]);
+            out[i] = acc;
+        }
+    }, 1);
+
+    return out + n;
+}
+
+// stable sort: chunks are sorted in parallel, then merged pairwise in parallel rounds through a
+// buffer of the same size
+template<std::random_access_iterator It, typename Compare = std::less<>>
+requires(std::is_default_constructible_v<std::iter_value_t<It>> && std::is_move_assignable_v<std::iter_value_t<It>>)
+void parallel_sort(thread_pool& pool, It first, It last, const Compare& comp = {}) {
+    using T = std::iter_value_t<It>;
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    const std::size_t chunks = std::min(pool.size() * 4, n / 2048);
+    if(chunks < 2) {
+        std::stable_sort(first, last, comp);
+        return;
+    }
+
+    const std::size_t chunk = (n + chunks - 1) / chunks;
+    parallel_for(pool, std::size_t(0), chunks, [&](std::size_t c) {
+        const std::size_t begin = std::min(n, c * chunk);
+        const std::size_t end = std::min(n, begin + chunk);
+        std::stable_sort(first + begin, first + end, comp);
+    }, 1);
+
+    std::vector<T> buffer(n);
+    bool in_buffer = false;
+    for(std::size_t width = chunk; width < n; width *= 2) {
+        const std::size_t pairs = (n + 2 * width - 1) / (2 * width);
+        auto merge_round = [&](auto src, auto dst) {
+            parallel_for(pool, std::size_t(0), pairs, [&, src, dst](std::size_t p) {
+                const std::size_t begin = p * 2 * width;
+                const std::size_t middle = std::min(n, begin + width);
+                const std::size_t end = std::min(n, begin + 2 * width);
+                std::merge(std::make_move_iterator(src + begin), std::make_move_iterator(src + middle),
+                           std::make_move_iterator(src + middle), std::make_move_iterator(src + end),
+                           dst + begin, comp);
+            }, 1);
+        };
+        if(in_buffer) {
+            merge_round(buffer.begin(), first);
+        } else {
+            merge_round(first, buffer.begin());
+        }
+        in_buffer = !in_buffer;
+    }
+
+    if(in_buffer) {
+        parallel_for(pool, std::size_t(0), n, [&](std::size_t i) { first[i] = std::move(buffer[i]); });
+    }
+}
+
+}
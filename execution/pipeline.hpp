@@ -0,0 +1,647 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <parking_lot.hpp>
+#include <queue.hpp>
+#include <sharded_counter.hpp>
+#include <spin.hpp>
+#include <spsc_ring.hpp>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace conc {
+
+enum class stage_mode {
+    // one thread, items in source order
+    serial_in_order,
+    // one thread, items in arrival order
+    serial_out_of_order,
+    // several threads, items in arrival order
+    parallel,
+};
+
+// snapshot of a stage, consistent per field while the pipeline runs and exact once it finished
+struct stage_metrics {
+    std::string name;
+    stage_mode mode = stage_mode::parallel;
+    std::size_t threads = 0;
+    // items that went through the stage, dropped and skipped ones included
+    std::uint64_t items = 0;
+    // time spent in the stage function, summed over the stage's threads
+    std::chrono::nanoseconds busy{0};
+    // items queued in front of the stage, now and at most so far; zero for the source
+    std::size_t queue_depth = 0;
+    std::size_t peak_queue_depth = 0;
+
+    // items per second the stage sustains with all its threads busy: the stage with the lowest
+    // capacity is the bottleneck, a deep queue in front of it confirms it
+    [[nodiscard]]
+    double capacity() const noexcept {
+        if(busy.count() == 0) {
+            return 0.0;
+        }
+        return static_cast<double>(items) * static_cast<double>(threads) * 1e9 / static_cast<double>(busy.count());
+    }
+};
+
+namespace detail {
+
+template<typename T>
+struct unwrap_optional {
+    using type = T;
+    static constexpr bool filters = false;
+};
+
+template<typename T>
+struct unwrap_optional<std::optional<T>> {
+    using type = T;
+    static constexpr bool filters = true;
+};
+
+template<typename T>
+struct envelope {
+    std::uint64_t seq = 0;
+    // empty on items a filter dropped or that a failure skipped, they still travel to the sink
+    // so in-order stages see no gaps and the sink returns their tokens
+    std::optional<T> value;
+    bool end = false;
+};
+
+// tokens bound the items between the source and the sink, which gives backpressure and keeps
+// every queue within max_tokens; only the source acquires
+class token_gate {
+   public:
+    explicit token_gate(std::int64_t tokens) noexcept : m_free(tokens) {}
+
+    token_gate(token_gate const&) = delete;
+    token_gate(token_gate&& other) = delete;
+    token_gate& operator=(token_gate const&) = delete;
+    token_gate& operator=(token_gate &&) = delete;
+
+   public:
+    [[nodiscard]]
+    bool try_acquire() noexcept {
+        // a single acquirer, so the count can only grow between the load and the decrement
+        if(m_free.load(std::memory_order_relaxed) <= 0) {
+            return false;
+        }
+        m_free.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void acquire_wait() noexcept {
+        while(!try_acquire()) {
+            parking_lot::park(&m_free, [this]() noexcept {
+                m_has_waiters.store(true, std::memory_order_seq_cst);
+                return m_free.load(std::memory_order_seq_cst) <= 0;
+            });
+        }
+    }
+
+    void release(std::int64_t n) noexcept {
+        // seq_cst: either the parking source sees the tokens or we see its waiter flag
+        m_free.fetch_add(n, std::memory_order_seq_cst);
+        if(m_has_waiters.load(std::memory_order_seq_cst)) [[unlikely]] {
+            parking_lot::unpark_one(&m_free, [this](unpark_result) noexcept {
+                m_has_waiters.store(false, std::memory_order_relaxed);
+            });
+        }
+    }
+
+    [[nodiscard]]
+    std::int64_t available() const noexcept {
+        return m_free.load(std::memory_order_relaxed);
+    }
+
+   private:
+    std::atomic<std::int64_t> m_free;
+    std::atomic<bool> m_has_waiters = false;
+};
+
+struct pipeline_context {
+    pipeline_context(std::size_t max_tokens, std::size_t batch_size)
+        : tokens(static_cast<std::int64_t>(max_tokens)), max_tokens(max_tokens), batch(batch_size) {}
+
+    // the first exception wins, the stages skip every item from then on and the source stops
+    void fail(std::exception_ptr e) noexcept {
+        std::lock_guard guard(error_lock);
+        if(!error) {
+            error = std::move(e);
+            failed.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    token_gate tokens;
+    const std::size_t max_tokens;
+    const std::size_t batch;
+    std::atomic<bool> failed = false;
+    std::mutex error_lock;
+    std::exception_ptr error;
+};
+
+class link_base {
+   public:
+    virtual ~link_base() = default;
+
+    [[nodiscard]]
+    std::size_t depth() const noexcept {
+        return static_cast<std::size_t>(std::max<std::int64_t>(0, m_depth.load(std::memory_order_relaxed)));
+    }
+
+    [[nodiscard]]
+    std::size_t peak_depth() const noexcept {
+        return static_cast<std::size_t>(m_peak.load(std::memory_order_relaxed));
+    }
+
+   protected:
+    void added(std::int64_t n) noexcept {
+        const std::int64_t depth = m_depth.fetch_add(n, std::memory_order_relaxed) + n;
+        std::int64_t peak = m_peak.load(std::memory_order_relaxed);
+        while(depth > peak && !m_peak.compare_exchange_weak(peak, depth, std::memory_order_relaxed));
+    }
+
+    void removed(std::int64_t n) noexcept {
+        m_depth.fetch_sub(n, std::memory_order_relaxed);
+    }
+
+   private:
+    std::atomic<std::int64_t> m_depth = 0;
+    std::atomic<std::int64_t> m_peak = 0;
+};
+
+// connection between two stages: an SPSC ring when one thread feeds one thread, the MPMC queue
+// otherwise. Neither needs to block producers, the tokens keep every link below max_tokens.
+template<typename T>
+class link final : public link_base {
+   public:
+    link(std::size_t producers, std::size_t consumers, std::size_t max_tokens) : m_producers(producers), m_consumers(consumers) {
+        if(producers == 1 && consumers == 1) {
+            // room for every token and the end marker
+            m_ring = std::make_unique<spsc_ring<envelope<T>>>(max_tokens + 1);
+        } else {
+            m_queue = std::make_unique<queue<envelope<T>>>();
+        }
+    }
+
+   public:
+    // moves the batch in and clears it
+    void push(std::vector<envelope<T>>& batch) {
+        added(static_cast<std::int64_t>(batch.size()));
+        send(batch);
+    }
+
+    // blocks for one envelope, then appends what is ready up to max in total; an end marker is
+    // always the last envelope taken, so each consumer thread takes exactly one
+    void pop(std::vector<envelope<T>>& batch, std::size_t max) {
+        auto take = [&batch](envelope<T>&& e) noexcept {
+            batch.push_back(std::move(e));
+        };
+
+        if(m_ring) {
+            if(m_ring->pop_batch(max, take) == 0) {
+                take(m_ring->pop_wait());
+                m_ring->pop_batch(max - 1, take);
+            }
+        } else {
+            take(m_queue->dequeue_wait());
+            while(batch.size() < max && !batch.back().end) {
+                auto e = m_queue->dequeue();
+                if(!e) {
+                    break;
+                }
+                take(std::move(*e));
+            }
+        }
+        removed(static_cast<std::int64_t>(batch.size()) - (batch.back().end ? 1 : 0));
+    }
+
+    // one producer thread finished, the last one ends the stream for every consumer thread
+    void close() {
+        if(m_producers.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+        std::vector<envelope<T>> markers(m_consumers);
+        for(auto& m : markers) {
+            m.end = true;
+        }
+        send(markers);
+    }
+
+   private:
+    void send(std::vector<envelope<T>>& batch) {
+        if(m_ring) {
+            auto first = batch.begin();
+            spin_wait wait;
+            while(first != batch.end()) {
+                first += static_cast<std::ptrdiff_t>(m_ring->push_batch(first, batch.end()));
+                if(first != batch.end()) [[unlikely]] {
+                    wait();
+                }
+            }
+        } else {
+            for(auto& e : batch) {
+                m_queue->enqueue(std::move(e));
+            }
+        }
+        batch.clear();
+    }
+
+   private:
+    std::atomic<std::size_t> m_producers;
+    const std::size_t m_consumers;
+    std::unique_ptr<spsc_ring<envelope<T>>> m_ring;
+    std::unique_ptr<queue<envelope<T>>> m_queue;
+};
+
+class stage_base {
+   public:
+    stage_base(pipeline_context& context, std::string name, stage_mode mode, std::size_t threads)
+        : m_context(context), m_name(std::move(name)), m_mode(mode), m_threads(threads) {}
+
+    virtual ~stage_base() = default;
+
+    // run by each of the stage's threads
+    virtual void run() = 0;
+
+    [[nodiscard]]
+    std::size_t threads() const noexcept {
+        return m_threads;
+    }
+
+    [[nodiscard]]
+    stage_metrics metrics() const {
+        stage_metrics m;
+        m.name = m_name;
+        m.mode = m_mode;
+        m.threads = m_threads;
+        m.items = static_cast<std::uint64_t>(m_items.load());
+        m.busy = std::chrono::nanoseconds(m_busy.load());
+        if(m_input != nullptr) {
+            m.queue_depth = m_input->depth();
+            m.peak_queue_depth = m_input->peak_depth();
+        }
+        return m;
+    }
+
+   protected:
+    using clock = std::chrono::steady_clock;
+
+    void account(std::size_t items, clock::time_point start) noexcept {
+        m_items.add(static_cast<std::int64_t>(items));
+        m_busy.add(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count());
+    }
+
+   protected:
+    pipeline_context& m_context;
+    const link_base* m_input = nullptr;
+
+   private:
+    const std::string m_name;
+    const stage_mode m_mode;
+    const std::size_t m_threads;
+    sharded_counter m_items;
+    sharded_counter m_busy;
+};
+
+// output side of a stage, wired up when the next stage is added
+template<typename T>
+struct producer {
+    link<T>* output = nullptr;
+};
+
+template<>
+struct producer<void> {};
+
+template<typename Out, typename F>
+class source_stage final : public stage_base, public producer<Out> {
+   public:
+    source_stage(pipeline_context& context, std::string name, F&& fn)
+        : stage_base(context, std::move(name), stage_mode::serial_in_order, 1), m_fn(std::move(fn)) {}
+
+    void run() override {
+        std::vector<envelope<Out>> batch;
+        batch.reserve(m_context.batch);
+        bool done = false;
+        while(!done) {
+            auto start = clock::now();
+            while(batch.size() < m_context.batch) {
+                if(!m_context.tokens.try_acquire()) {
+                    // the batch holds tokens the gate may be waiting for, send it first
+                    if(!batch.empty()) {
+                        break;
+                    }
+                    m_context.tokens.acquire_wait();
+                    start = clock::now();
+                }
+                std::optional<Out> item;
+                if(!m_context.failed.load(std::memory_order_relaxed)) {
+                    try {
+                        item = m_fn();
+                    } catch(...) {
+                        m_context.fail(std::current_exception());
+                    }
+                }
+                if(!item) {
+                    m_context.tokens.release(1);
+                    done = true;
+                    break;
+                }
+                batch.push_back({m_seq++, std::move(item), false});
+            }
+            account(batch.size(), start);
+            if(!batch.empty()) {
+                this->output->push(batch);
+            }
+        }
+        this->output->close();
+    }
+
+   private:
+    F m_fn;
+    std::uint64_t m_seq = 0;
+};
+
+// a stage with Out = void is the sink, it returns the tokens of the items it finished
+template<typename In, typename Out, typename F>
+class stage final : public stage_base, public producer<Out> {
+   private:
+    // the sink keeps an empty output batch
+    using output_t = std::conditional_t<std::is_void_v<Out>, std::monostate, Out>;
+
+   public:
+    stage(pipeline_context& context, std::string name, stage_mode mode, std::size_t threads, link<In>& input, F&& fn)
+        : stage_base(context, std::move(name), mode, threads), m_in(input), m_fn(std::move(fn)) {
+        m_input = &input;
+        if(mode == stage_mode::serial_in_order) {
+            m_window.resize(std::bit_ceil(context.max_tokens));
+        }
+    }
+
+    void run() override {
+        std::vector<envelope<In>> input;
+        input.reserve(m_context.batch);
+        std::vector<envelope<output_t>> output;
+        if constexpr(!std::is_void_v<Out>) {
+            output.reserve(m_context.batch);
+        }
+
+        bool end = false;
+        while(!end) {
+            m_in.pop(input, m_context.batch);
+            const auto start = clock::now();
+            std::size_t finished = 0;
+            for(auto& e : input) {
+                if(e.end) {
+                    end = true;
+                } else if(m_window.empty()) {
+                    process(std::move(e), output);
+                    ++finished;
+                } else {
+                    finished += reorder(std::move(e), output);
+                }
+            }
+            input.clear();
+            account(finished, start);
+
+            if constexpr(std::is_void_v<Out>) {
+                if(finished != 0) {
+                    m_context.tokens.release(static_cast<std::int64_t>(finished));
+                }
+            } else if(!output.empty()) {
+                this->output->push(output);
+            }
+        }
+        if constexpr(!std::is_void_v<Out>) {
+            this->output->close();
+        }
+    }
+
+   private:
+    // buffers e until every earlier item went through, returns how many were processed
+    std::size_t reorder(envelope<In>&& e, std::vector<envelope<output_t>>& output) {
+        const std::size_t mask = m_window.size() - 1;
+        if(e.seq != m_next) {
+            // at most max_tokens items are in flight, so their slots are distinct
+            m_window[e.seq & mask].emplace(std::move(e));
+            return 0;
+        }
+        process(std::move(e), output);
+        std::size_t count = 1;
+        for(++m_next; m_window[m_next & mask]; ++m_next, ++count) {
+            process(std::move(*m_window[m_next & mask]), output);
+            m_window[m_next & mask].reset();
+        }
+        return count;
+    }
+
+    void process(envelope<In>&& e, std::vector<envelope<output_t>>& output) {
+        if constexpr(std::is_void_v<Out>) {
+            if(e.value && !m_context.failed.load(std::memory_order_relaxed)) {
+                try {
+                    m_fn(std::move(*e.value));
+                } catch(...) {
+                    m_context.fail(std::current_exception());
+                }
+            }
+        } else {
+            envelope<output_t>& out = output.emplace_back();
+            out.seq = e.seq;
+            if(e.value && !m_context.failed.load(std::memory_order_relaxed)) {
+                try {
+                    out.value = m_fn(std::move(*e.value));
+                } catch(...) {
+                    m_context.fail(std::current_exception());
+                }
+            }
+        }
+    }
+
+   private:
+    link<In>& m_in;
+    F m_fn;
+    // serial_in_order only: items that overtook the next one, indexed by sequence number
+    std::vector<std::optional<envelope<In>>> m_window;
+    std::uint64_t m_next = 0;
+};
+
+struct pipeline_state {
+    pipeline_state(std::size_t max_tokens, std::size_t batch) : context(max_tokens, batch) {}
+
+    pipeline_context context;
+    std::vector<std::unique_ptr<stage_base>> stages;
+    std::vector<std::unique_ptr<link_base>> links;
+    // the source is exhausted and the links are closed after one run
+    bool ran = false;
+};
+
+inline std::size_t stage_threads(stage_mode mode, std::size_t threads) noexcept {
+    if(mode != stage_mode::parallel) {
+        return 1;
+    }
+    return threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+}
+
+template<typename T>
+class pipeline_builder;
+
+// Pipeline of stages, each running on threads of its own (Intel TBB parallel_pipeline, with
+// queues instead of task scheduling): a serial source produces items, every further stage is
+// serial in order, serial out of order or parallel, and the last one is the sink. Stages are
+// connected by an SPSC ring when one thread feeds one thread and by the MPMC queue otherwise,
+// items move between them in batches. At most max_tokens items are between the source and the
+// end of the sink, which bounds memory and makes a slow stage stall the source. A stage function
+// returning std::optional drops the items it returns nullopt for.
+class pipeline {
+   public:
+    // source() returns std::optional<T>, nullopt ends the stream
+    template<typename F>
+    requires(std::is_invocable_v<std::decay_t<F>&> && detail::unwrap_optional<std::invoke_result_t<std::decay_t<F>&>>::filters)
+    static auto source(std::string name, F&& f, std::size_t max_tokens = 256, std::size_t batch = 16);
+
+    pipeline(pipeline const&) = delete;
+    pipeline(pipeline&& other) noexcept = default;
+    pipeline& operator=(pipeline const&) = delete;
+    pipeline& operator=(pipeline&& other) noexcept = default;
+
+   public:
+    // runs the stream to its end and rethrows the first exception a stage threw, once; a
+    // pipeline runs a single time, later calls and calls on a moved-from pipeline do nothing
+    void run() {
+        assert(m_state != nullptr && !m_state->ran);
+        if(m_state == nullptr || std::exchange(m_state->ran, true)) {
+            return;
+        }
+
+        std::vector<std::thread> threads;
+        try {
+            for(auto& s : m_state->stages) {
+                for(std::size_t i = 0; i < s->threads(); ++i) {
+                    threads.emplace_back([stage = s.get()]() { stage->run(); });
+                }
+            }
+        } catch(...) {
+            // stages start source first, so the started ones run dry once the source sees the
+            // failure; the tokens wake a source waiting for a sink that never started
+            auto& context = m_state->context;
+            context.fail(std::current_exception());
+            context.tokens.release(static_cast<std::int64_t>(context.max_tokens));
+            for(auto& t : threads) {
+                t.join();
+            }
+            throw;
+        }
+        for(auto& t : threads) {
+            t.join();
+        }
+        if(m_state->context.error) {
+            std::rethrow_exception(m_state->context.error);
+        }
+    }
+
+    // safe to call from any thread while run() is in progress
+    [[nodiscard]]
+    std::vector<stage_metrics> metrics() const {
+        std::vector<stage_metrics> result;
+        for(const auto& s : m_state->stages) {
+            result.push_back(s->metrics());
+        }
+        return result;
+    }
+
+    // items between the source and the end of the sink
+    [[nodiscard]]
+    std::size_t in_flight() const noexcept {
+        const auto& c = m_state->context;
+        return c.max_tokens - static_cast<std::size_t>(std::max<std::int64_t>(0, c.tokens.available()));
+    }
+
+   private:
+    template<typename T>
+    friend class pipeline_builder;
+
+    explicit pipeline(std::unique_ptr<detail::pipeline_state> state) noexcept : m_state(std::move(state)) {}
+
+   private:
+    std::unique_ptr<detail::pipeline_state> m_state;
+};
+
+// typed view of a pipeline under construction, T is what the last stage so far produces
+template<typename T>
+class pipeline_builder {
+   public:
+    // f(T&&) returns the next item, or std::optional of it to drop items; threads only applies
+    // to parallel stages and defaults to the hardware concurrency
+    template<typename F>
+    requires(std::is_invocable_v<std::decay_t<F>&, T&&>)
+    auto then(std::string name, stage_mode mode, F&& f, std::size_t threads = 0) && {
+        using U = typename detail::unwrap_optional<std::invoke_result_t<std::decay_t<F>&, T&&>>::type;
+        static_assert(std::is_nothrow_move_constructible_v<U>, "items must be nothrow move constructible");
+        auto* s = add<U>(std::move(name), mode, std::forward<F>(f), threads);
+        return pipeline_builder<U>(std::move(m_state), s);
+    }
+
+    template<typename F>
+    requires(std::is_invocable_v<std::decay_t<F>&, T&&>)
+    pipeline sink(std::string name, stage_mode mode, F&& f, std::size_t threads = 0) && {
+        add<void>(std::move(name), mode, std::forward<F>(f), threads);
+        return pipeline(std::move(m_state));
+    }
+
+   private:
+    template<typename U>
+    friend class pipeline_builder;
+    friend class pipeline;
+
+    pipeline_builder(std::unique_ptr<detail::pipeline_state> state, detail::producer<T>* last) noexcept
+        : m_state(std::move(state)), m_last(last) {}
+
+    template<typename U, typename F>
+    auto* add(std::string name, stage_mode mode, F&& f, std::size_t threads) {
+        using stage_t = detail::stage<T, U, std::decay_t<F>>;
+        threads = detail::stage_threads(mode, threads);
+
+        auto l = std::make_unique<detail::link<T>>(m_state->stages.back()->threads(), threads, m_state->context.max_tokens);
+        auto s = std::make_unique<stage_t>(m_state->context, std::move(name), mode, threads, *l, std::decay_t<F>(std::forward<F>(f)));
+        m_last->output = l.get();
+
+        auto* result = s.get();
+        m_state->links.push_back(std::move(l));
+        m_state->stages.push_back(std::move(s));
+        return result;
+    }
+
+   private:
+    std::unique_ptr<detail::pipeline_state> m_state;
+    detail::producer<T>* m_last;
+};
+
+template<typename F>
+requires(std::is_invocable_v<std::decay_t<F>&> && detail::unwrap_optional<std::invoke_result_t<std::decay_t<F>&>>::filters)
+auto pipeline::source(std::string name, F&& f, std::size_t max_tokens, std::size_t batch) {
+    using T = typename detail::unwrap_optional<std::invoke_result_t<std::decay_t<F>&>>::type;
+    static_assert(std::is_nothrow_move_constructible_v<T>, "items must be nothrow move constructible");
+    using stage_t = detail::source_stage<T, std::decay_t<F>>;
+
+    auto state = std::make_unique<detail::pipeline_state>(std::max<std::size_t>(max_tokens, 1), std::max<std::size_t>(batch, 1));
+    auto s = std::make_unique<stage_t>(state->context, std::move(name), std::decay_t<F>(std::forward<F>(f)));
+    auto* last = s.get();
+    state->stages.push_back(std::move(s));
+    return pipeline_builder<T>(std::move(state), last);
+}
+
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Scaling of the parallel algorithms over 1..2N worker threads: every cell is the best wall time
+// of a few runs in milliseconds, the last column the speedup of the widest pool over one thread.
+
+namespace {
+
+constexpr int RUNS = 3;
+constexpr std::size_t N = 4'000'000;
+
+std::vector<std::size_t> thread_counts() {
+    const std::size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::size_t> counts;
+    for (std::size_t n = 1; n < hardware; n *= 2) {
+        counts.push_back(n);
+    }
+    counts.push_back(hardware);
+    counts.push_back(hardware * 2);
+    return counts;
+}
+
+template<typename F>
+double best_ms(F&& f) {
+    double best = 1e300;
+    for (int r = 0; r < RUNS; ++r) {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        const auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    return best;
+}
+
+template<typename Run>
+void row(const char* name, const std::vector<std::size_t>& counts, Run&& run) {
+    std::printf("%-22s", name);
+    std::vector<double> times;
+    for (std::size_t threads : counts) {
+        conc::thread_pool pool(threads);
+        times.push_back(best_ms([&]() { run(pool); }));
+        std::printf("%10.2f", times.back());
+    }
+    std::printf("%9.2fx\n", times.front() / times.back());
+}
+
+}
+
+TEST(ParallelBench, ScalingMatrix) {
+    const auto counts = thread_counts();
+    std::printf("%-22s", "ms");
+    for (std::size_t n : counts) {
+        std::printf("%7zu thr", n);
+    }
+    std::printf("%10s\n", "speedup");
+
+    std::vector<double> data(N);
+    std::mt19937_64 rng(1);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    for (auto& d : data) {
+        d = dist(rng);
+    }
+    std::vector<double> out(N);
+
+    row("for (sqrt)", counts, [&](conc::thread_pool& pool) {
+        conc::parallel_for(pool, std::size_t(0), N, [&](std::size_t i) { out[i] = std::sqrt(data[i]); });
+    });
+    row("reduce relaxed", counts, [&](conc::thread_pool& pool) {
+        volatile double sink = conc::parallel_reduce(pool, std::size_t(0), N, 0.0,
+            [&](std::size_t i) { return data[i]; }, std::plus<>{});
+        (void)sink;
+    });
+    row("reduce deterministic", counts, [&](conc::thread_pool& pool) {
+        volatile double sink = conc::parallel_reduce(pool, std::size_t(0), N, 0.0,
+            [&](std::size_t i) { return data[i]; }, std::plus<>{}, conc::reduce_order::deterministic);
+        (void)sink;
+    });
+    row("scan", counts, [&](conc::thread_pool& pool) {
+        conc::parallel_scan(pool, data.begin(), data.end(), out.begin());
+    });
+    row("sort", counts, [&](conc::thread_pool& pool) {
+        out = data;
+        conc::parallel_sort(pool, out.begin(), out.end());
+    });
+
+    std::printf("%-22s%10.2f\n", "std::sort (1 thr)", best_ms([&]() {
+        out = data;
+        std::sort(out.begin(), out.end());
+    }));
+}
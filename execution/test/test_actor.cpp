@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+#include "actor.hpp"
+
+#include <atomic>
+#include <latch.hpp>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace conc;
+
+namespace {
+
+struct tagged {
+    int sender;
+    int sequence;
+};
+
+// checks per-sender FIFO and that receive never overlaps itself
+class checker final : public actor<tagged> {
+   public:
+    checker(int senders, std::atomic<int>& destroyed) : m_next(senders, 0), m_destroyed(destroyed) {}
+    ~checker() override {
+        m_destroyed.fetch_add(1);
+    }
+
+    std::atomic<long> received{0};
+    std::atomic<bool> ordered{true};
+    std::atomic<bool> overlapped{false};
+
+   protected:
+    void receive(tagged&& m) override {
+        if(m_inside.exchange(true)) {
+            overlapped.store(true);
+        }
+        if(m.sequence != m_next[m.sender]++) {
+            ordered.store(false);
+        }
+        received.fetch_add(1);
+        m_inside.store(false);
+    }
+
+   private:
+    std::vector<int> m_next;
+    std::atomic<bool> m_inside{false};
+    std::atomic<int>& m_destroyed;
+};
+
+class counter final : public actor<int> {
+   public:
+    explicit counter(latch& done) : m_done(done) {}
+
+   protected:
+    void receive(int&&) override {
+        m_done.count_down();
+    }
+
+   private:
+    latch& m_done;
+};
+
+struct ball {
+    int hits;
+};
+
+class player final : public actor<ball> {
+   public:
+    player(latch& done, int rally) : m_done(done), m_rally(rally) {}
+
+    actor_ref<player> partner;
+
+   protected:
+    void receive(ball&& b) override {
+        if(b.hits < m_rally) {
+            partner.send(ball{b.hits + 1});
+        }
+        // the last two turns break the reference cycle
+        if(b.hits + 1 >= m_rally) {
+            partner.reset();
+            m_done.count_down();
+        }
+    }
+
+   private:
+    latch& m_done;
+    const int m_rally;
+};
+
+}
+
+class ActorTest : public ::testing::Test {
+protected:
+    thread_pool pool{4};
+    actor_runtime runtime{pool, 8};
+};
+
+TEST_F(ActorTest, ConcurrentSendersKeepFifoAndNeverOverlap) {
+    constexpr int SENDERS = 4;
+    constexpr int PER_SENDER = 20000;
+    std::atomic<int> destroyed{0};
+    auto a = runtime.spawn<checker>(SENDERS, destroyed);
+
+    std::vector<std::thread> senders;
+    for(int s = 0; s < SENDERS; ++s) {
+        senders.emplace_back([a, s]() {
+            for(int i = 0; i < PER_SENDER; ++i) {
+                a.send(tagged{s, i});
+            }
+        });
+    }
+    for(auto& t : senders) {
+        t.join();
+    }
+    while(a->received.load() != SENDERS * PER_SENDER) {
+        std::this_thread::yield();
+    }
+    EXPECT_TRUE(a->ordered.load());
+    EXPECT_FALSE(a->overlapped.load());
+    EXPECT_EQ(destroyed.load(), 0);
+}
+
+TEST_F(ActorTest, LastReferenceDeletesAfterMailboxIsProcessed) {
+    std::atomic<int> destroyed{0};
+    {
+        auto a = runtime.spawn<checker>(1, destroyed);
+        for(int i = 0; i < 1000; ++i) {
+            a.send(tagged{0, i});
+        }
+        auto copy = a;
+        a.reset();
+        EXPECT_FALSE(a);
+        EXPECT_TRUE(copy);
+    }
+    while(destroyed.load() == 0) {
+        std::this_thread::yield();
+    }
+    EXPECT_EQ(destroyed.load(), 1);
+}
+
+TEST_F(ActorTest, ManyMostlyIdleActors) {
+    constexpr int ACTORS = 100000;
+    latch done(ACTORS + 3);
+    std::vector<actor_ref<counter>> actors;
+    actors.reserve(ACTORS);
+    for(int i = 0; i < ACTORS; ++i) {
+        actors.push_back(runtime.spawn<counter>(done));
+    }
+    for(auto& a : actors) {
+        a.send(1);
+    }
+    actors[7].send(2);
+    actors[ACTORS / 2].send(2);
+    actors.back().send(2);
+    done.wait();
+}
+
+TEST_F(ActorTest, SendsFromInsideReceive) {
+    latch done(2);
+    auto ping = runtime.spawn<player>(done, 10001);
+    auto pong = runtime.spawn<player>(done, 10001);
+    ping->partner = pong;
+    pong->partner = ping;
+    ping.send(ball{0});
+    done.wait();
+}
+
+TEST(ActorRuntimeTest, BatchOfOneStillDeliversEverything) {
+    thread_pool pool(2);
+    actor_runtime runtime(pool, 1);
+    latch done(5000);
+    auto a = runtime.spawn<counter>(done);
+    auto b = runtime.spawn<counter>(done);
+    for(int i = 0; i < 2500; ++i) {
+        a.send(i);
+        b.send(i);
+    }
+    done.wait();
+}
+
+TEST(ActorRuntimeTest, PoolDestructionRunsPendingMessages) {
+    std::atomic<int> destroyed{0};
+    {
+        thread_pool pool(2);
+        actor_runtime runtime(pool, 4);
+        auto a = runtime.spawn<checker>(1, destroyed);
+        for(int i = 0; i < 5000; ++i) {
+            a.send(tagged{0, i});
+        }
+        while(a->received.load() == 0) {
+            std::this_thread::yield();
+        }
+        a.reset();
+    }
+    EXPECT_EQ(destroyed.load(), 1);
+}
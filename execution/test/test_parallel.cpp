@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace conc;
+
+class ParallelTest : public ::testing::Test {
+protected:
+    thread_pool pool{4};
+};
+
+TEST_F(ParallelTest, ForVisitsEveryIndexOnce) {
+    for (std::size_t grain : {0u, 1u, 7u, 100000u}) {
+        std::vector<std::atomic<int>> visits(10007);
+        parallel_for(pool, 0, 10007, [&](int i) { visits[i].fetch_add(1, std::memory_order_relaxed); }, grain);
+        EXPECT_TRUE(std::all_of(visits.begin(), visits.end(), [](const std::atomic<int>& v) { return v.load() == 1; }))
+            << "grain " << grain;
+    }
+}
+
+TEST_F(ParallelTest, ForHandlesEmptyAndOffsetRanges) {
+    std::atomic<long> sum{0};
+    parallel_for(pool, 5, 5, [&](int i) { sum.fetch_add(i); });
+    parallel_for(pool, 10, 3, [&](int i) { sum.fetch_add(i); });
+    EXPECT_EQ(sum.load(), 0);
+
+    parallel_for(pool, std::int64_t(-50), std::int64_t(50), [&](std::int64_t i) { sum.fetch_add(i); });
+    EXPECT_EQ(sum.load(), -50);
+}
+
+TEST_F(ParallelTest, ForPropagatesExceptions) {
+    EXPECT_THROW(parallel_for(pool, 0, 100000, [](int i) {
+        if (i == 77777) {
+            throw std::runtime_error("index");
+        }
+    }), std::runtime_error);
+
+    // the pool stays usable
+    std::atomic<int> count{0};
+    parallel_for(pool, 0, 1000, [&](int) { count.fetch_add(1); });
+    EXPECT_EQ(count.load(), 1000);
+}
+
+TEST_F(ParallelTest, NestedFor) {
+    std::vector<std::atomic<int>> cells(64 * 64);
+    parallel_for(pool, 0, 64, [&](int row) {
+        parallel_for(pool, 0, 64, [&](int col) { cells[row * 64 + col].fetch_add(1); }, 4);
+    }, 1);
+    EXPECT_TRUE(std::all_of(cells.begin(), cells.end(), [](const std::atomic<int>& v) { return v.load() == 1; }));
+}
+
+TEST_F(ParallelTest, ReduceMatchesSequential) {
+    const int n = 200000;
+    const auto square = [](int i) { return static_cast<long>(i) * i % 1000; };
+    long expected = 0;
+    for (int i = 0; i < n; ++i) {
+        expected += square(i);
+    }
+
+    EXPECT_EQ(parallel_reduce(pool, 0, n, 0L, square, std::plus<>{}), expected);
+    EXPECT_EQ(parallel_reduce(pool, 0, n, 0L, square, std::plus<>{}, reduce_order::deterministic), expected);
+    EXPECT_EQ(parallel_reduce(pool, 0, 0, 5L, square, std::plus<>{}), 5);
+}
+
+TEST_F(ParallelTest, DeterministicReduceIsIndependentOfThreads) {
+    const int n = 300000;
+    std::vector<double> values(n);
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> dist(-1e6, 1e6);
+    for (auto& v : values) {
+        v = dist(rng) * std::pow(10.0, static_cast<int>(rng() % 20) - 10);
+    }
+    const auto at = [&](int i) { return values[i]; };
+
+    thread_pool single(1);
+    const double reference = parallel_reduce(single, 0, n, 0.0, at, std::plus<>{}, reduce_order::deterministic);
+    for (int round = 0; round < 5; ++round) {
+        const double result = parallel_reduce(pool, 0, n, 0.0, at, std::plus<>{}, reduce_order::deterministic);
+        EXPECT_EQ(std::memcmp(&result, &reference, sizeof(double)), 0);
+    }
+}
+
+TEST_F(ParallelTest, ScanMatchesInclusiveScan) {
+    for (std::size_t n : {1u, 2u, 5u, 17u, 1000u, 123457u}) {
+        std::vector<long> input(n);
+        std::iota(input.begin(), input.end(), -3);
+        std::vector<long> expected(n);
+        std::inclusive_scan(input.begin(), input.end(), expected.begin());
+
+        std::vector<long> output(n);
+        auto end = parallel_scan(pool, input.begin(), input.end(), output.begin());
+        EXPECT_TRUE(end == output.end());
+        EXPECT_EQ(output, expected) << n << " elements";
+    }
+
+    std::vector<int> in_place = {3, 1, 4, 1, 5, 9, 2, 6};
+    parallel_scan(pool, in_place.begin(), in_place.end(), in_place.begin(), [](int a, int b) { return std::max(a, b); });
+    EXPECT_EQ(in_place, (std::vector<int>{3, 3, 4, 4, 5, 9, 9, 9}));
+}
+
+TEST_F(ParallelTest, SortIsStableAndSorted) {
+    for (std::size_t n : {0u, 1u, 1000u, 100000u, 250001u}) {
+        std::vector<std::pair<int, std::size_t>> data(n);
+        std::mt19937 rng(static_cast<unsigned>(n));
+        for (std::size_t i = 0; i < n; ++i) {
+            data[i] = {static_cast<int>(rng() % 1000), i};
+        }
+        auto expected = data;
+        const auto by_key = [](const auto& a, const auto& b) { return a.first < b.first; };
+        std::stable_sort(expected.begin(), expected.end(), by_key);
+
+        parallel_sort(pool, data.begin(), data.end(), by_key);
+        EXPECT_EQ(data, expected) << n << " elements";
+    }
+}
+
+TEST_F(ParallelTest, CalledFromInsideAWorker) {
+    auto f = pool.submit([this]() {
+        std::vector<int> v(50000);
+        std::iota(v.rbegin(), v.rend(), 0);
+        parallel_sort(pool, v.begin(), v.end());
+        return std::is_sorted(v.begin(), v.end()) &&
+               parallel_reduce(pool, 0, 1000, 0, [](int i) { return i; }, std::plus<>{}) == 499500;
+    });
+    EXPECT_TRUE(f.get());
+}
@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+#include "pipeline.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace conc;
+
+namespace {
+
+// source of 0..n-1
+auto counter(int n) {
+    return [i = 0, n]() mutable -> std::optional<int> {
+        if(i == n) {
+            return std::nullopt;
+        }
+        return i++;
+    };
+}
+
+}
+
+TEST(PipelineTest, SerialChainKeepsOrder) {
+    std::vector<std::string> out;
+    auto p = pipeline::source("count", counter(1000), 8, 4)
+        .then("double", stage_mode::serial_in_order, [](int i) { return 2 * i; })
+        .then("format", stage_mode::serial_out_of_order, [](int i) { return std::to_string(i); })
+        .sink("collect", stage_mode::serial_in_order, [&](std::string s) { out.push_back(std::move(s)); });
+    p.run();
+
+    ASSERT_EQ(out.size(), 1000u);
+    for(int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(out[i], std::to_string(2 * i));
+    }
+}
+
+TEST(PipelineTest, ParallelStageThenInOrderSinkRestoresOrder) {
+    std::vector<int> out;
+    auto p = pipeline::source("count", counter(5000), 32, 8)
+        .then("jitter", stage_mode::parallel, [](int i) {
+            if(i % 97 == 0) {
+                std::this_thread::yield();
+            }
+            return i * 3;
+        }, 4)
+        .sink("collect", stage_mode::serial_in_order, [&](int i) { out.push_back(i); });
+    p.run();
+
+    ASSERT_EQ(out.size(), 5000u);
+    for(int i = 0; i < 5000; ++i) {
+        ASSERT_EQ(out[i], i * 3);
+    }
+}
+
+TEST(PipelineTest, ParallelSinkSeesEveryItemOnce) {
+    std::vector<std::atomic<int>> seen(3000);
+    auto p = pipeline::source("count", counter(3000))
+        .then("square", stage_mode::parallel, [](int i) { return i; }, 3)
+        .then("shuffle", stage_mode::serial_out_of_order, [](int i) { return i; })
+        .sink("mark", stage_mode::parallel, [&](int i) { seen[i].fetch_add(1); }, 3);
+    p.run();
+
+    for(auto& s : seen) {
+        ASSERT_EQ(s.load(), 1);
+    }
+}
+
+TEST(PipelineTest, OptionalResultFiltersItems) {
+    std::vector<int> out;
+    auto p = pipeline::source("count", counter(100), 16, 4)
+        .then("odd", stage_mode::parallel, [](int i) -> std::optional<int> {
+            if(i % 2 == 0) {
+                return std::nullopt;
+            }
+            return i;
+        }, 2)
+        .sink("collect", stage_mode::serial_in_order, [&](int i) { out.push_back(i); });
+    p.run();
+
+    ASSERT_EQ(out.size(), 50u);
+    for(int i = 0; i < 50; ++i) {
+        EXPECT_EQ(out[i], 2 * i + 1);
+    }
+    const auto m = p.metrics();
+    EXPECT_EQ(m[1].items, 100u);
+    EXPECT_EQ(m[2].items, 100u);
+}
+
+TEST(PipelineTest, TokensBoundItemsInFlight) {
+    constexpr std::size_t TOKENS = 6;
+    std::atomic<int> produced{0};
+    std::atomic<int> consumed{0};
+    std::atomic<int> max_gap{0};
+    auto p = pipeline::source("count", [&, i = 0]() mutable -> std::optional<int> {
+            if(i == 2000) {
+                return std::nullopt;
+            }
+            const int gap = produced.fetch_add(1) + 1 - consumed.load();
+            int seen = max_gap.load();
+            while(gap > seen && !max_gap.compare_exchange_weak(seen, gap));
+            return i++;
+        }, TOKENS, 4)
+        .then("pass", stage_mode::parallel, [](int i) { return i; }, 2)
+        .sink("slow", stage_mode::serial_out_of_order, [&](int) {
+            std::this_thread::yield();
+            consumed.fetch_add(1);
+        });
+    p.run();
+
+    EXPECT_EQ(consumed.load(), 2000);
+    EXPECT_LE(max_gap.load(), static_cast<int>(TOKENS));
+    EXPECT_EQ(p.in_flight(), 0u);
+    for(const auto& m : p.metrics()) {
+        EXPECT_LE(m.peak_queue_depth, TOKENS);
+        EXPECT_EQ(m.queue_depth, 0u);
+    }
+}
+
+TEST(PipelineTest, ExceptionStopsPipelineAndIsRethrown) {
+    std::atomic<int> sunk{0};
+    auto p = pipeline::source("count", counter(1000000), 16, 4)
+        .then("fail", stage_mode::parallel, [](int i) {
+            if(i == 500) {
+                throw std::runtime_error("bad record");
+            }
+            return i;
+        }, 2)
+        .sink("collect", stage_mode::serial_in_order, [&](int) { sunk.fetch_add(1); });
+    EXPECT_THROW(p.run(), std::runtime_error);
+    EXPECT_LT(sunk.load(), 1000000);
+}
+
+TEST(PipelineTest, RunsOnlyOnce) {
+    int calls = 0;
+    auto p = pipeline::source("three", counter(3))
+        .sink("collect", stage_mode::serial_in_order, [&](int) { ++calls; });
+    p.run();
+    EXPECT_EQ(calls, 3);
+#ifdef NDEBUG
+    // the source is exhausted and the links are closed, a second run does nothing
+    p.run();
+    EXPECT_EQ(calls, 3);
+#else
+    EXPECT_DEATH(p.run(), "");
+#endif
+}
+
+TEST(PipelineTest, EmptySource) {
+    int calls = 0;
+    auto p = pipeline::source("none", counter(0))
+        .sink("collect", stage_mode::serial_in_order, [&](int) { ++calls; });
+    p.run();
+    EXPECT_EQ(calls, 0);
+}
+
+TEST(PipelineTest, MetricsNameStagesAndCountItems) {
+    auto p = pipeline::source("count", counter(400), 16, 8)
+        .then("slow", stage_mode::serial_out_of_order, [](int i) {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            return i;
+        })
+        .sink("fast", stage_mode::serial_out_of_order, [](int) {});
+
+    std::thread monitor([&]() {
+        for(int i = 0; i < 5; ++i) {
+            (void)p.metrics();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    p.run();
+    monitor.join();
+
+    const auto m = p.metrics();
+    ASSERT_EQ(m.size(), 3u);
+    EXPECT_EQ(m[0].name, "count");
+    EXPECT_EQ(m[1].name, "slow");
+    EXPECT_EQ(m[2].name, "fast");
+    for(const auto& s : m) {
+        EXPECT_EQ(s.items, 400u);
+        EXPECT_EQ(s.threads, 1u);
+    }
+    // the sleeping stage is the bottleneck
+    EXPECT_LT(m[1].capacity(), m[2].capacity());
+    EXPECT_GE(m[1].busy, std::chrono::microseconds(50 * 400));
+}
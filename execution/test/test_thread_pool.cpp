@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include "thread_pool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace conc;
+
+class ThreadPoolTest : public ::testing::Test {
+protected:
+    thread_pool pool{4};
+};
+
+TEST_F(ThreadPoolTest, SubmitReturnsResult) {
+    auto f = pool.submit([]() { return 6 * 7; });
+    EXPECT_TRUE(f.valid());
+    EXPECT_EQ(f.get(), 42);
+    EXPECT_FALSE(f.valid());
+
+    auto s = pool.submit([]() { return std::string("task"); });
+    EXPECT_EQ(s.get(), "task");
+}
+
+TEST_F(ThreadPoolTest, VoidTaskAndMoveOnlyResult) {
+    std::atomic<bool> ran{false};
+    auto f = pool.submit([&]() { ran.store(true); });
+    f.get();
+    EXPECT_TRUE(ran.load());
+
+    auto p = pool.submit([]() { return std::make_unique<int>(5); });
+    EXPECT_EQ(*p.get(), 5);
+}
+
+TEST_F(ThreadPoolTest, ExceptionIsRethrownByGet) {
+    auto f = pool.submit([]() -> int { throw std::runtime_error("boom"); });
+    EXPECT_THROW(f.get(), std::runtime_error);
+}
+
+TEST_F(ThreadPoolTest, DroppedFutureDoesNotLeakOrBlock) {
+    std::atomic<int> ran{0};
+    for (int i = 0; i < 100; ++i) {
+        (void)pool.submit([&ran, i]() { ran.fetch_add(1); return i; });
+    }
+    auto last = pool.submit([]() { return 0; });
+    last.get();
+    while (ran.load() != 100) {
+        std::this_thread::yield();
+    }
+}
+
+int fib(thread_pool& pool, int n) {
+    if (n < 12) {
+        return n < 2 ? n : fib(pool, n - 1) + fib(pool, n - 2);
+    }
+    auto left = pool.submit([&pool, n]() { return fib(pool, n - 1); });
+    const int right = fib(pool, n - 2);
+    return left.get() + right;
+}
+
+TEST_F(ThreadPoolTest, NestedSpawnsWaitByHelping) {
+    auto f = pool.submit([this]() { return fib(pool, 24); });
+    EXPECT_EQ(f.get(), 46368);
+}
+
+TEST_F(ThreadPoolTest, ManyExternalSubmitters) {
+    const int num_submitters = 4;
+    const int per_submitter = 2000;
+    std::atomic<long> sum{0};
+    std::vector<std::thread> submitters;
+
+    for (int s = 0; s < num_submitters; ++s) {
+        submitters.emplace_back([&]() {
+            std::vector<task_future<int>> futures;
+            for (int i = 1; i <= per_submitter; ++i) {
+                futures.push_back(pool.submit([i]() { return i; }));
+            }
+            for (auto& f : futures) {
+                sum.fetch_add(f.get());
+            }
+        });
+    }
+    for (auto& t : submitters) {
+        t.join();
+    }
+    EXPECT_EQ(sum.load(), num_submitters * static_cast<long>(per_submitter) * (per_submitter + 1) / 2);
+}
+
+TEST_F(ThreadPoolTest, SleepingWorkersWakeUp) {
+    for (int round = 0; round < 5; ++round) {
+        // long enough for every worker to stop searching and park
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        auto f = pool.submit([round]() { return round; });
+        EXPECT_EQ(f.get(), round);
+    }
+}
+
+TEST(ThreadPoolShutdownTest, DestructorRunsQueuedAndSpawnedTasks) {
+    std::atomic<int> ran{0};
+    {
+        thread_pool pool(2);
+        for (int i = 0; i < 1000; ++i) {
+            pool.execute([&ran, &pool]() {
+                ran.fetch_add(1);
+                pool.execute([&ran]() { ran.fetch_add(1); });
+            });
+        }
+    }
+    EXPECT_EQ(ran.load(), 2000);
+}
+
+TEST(ThreadPoolShutdownTest, ManySubmittersAcrossPools) {
+    // two pools fed and reposting through their injection queues from many threads at once
+    const std::size_t num_submitters = 96;
+    std::atomic<long> sum{0};
+    {
+        thread_pool first(num_submitters / 2);
+        thread_pool second(num_submitters / 2);
+        std::vector<std::thread> submitters;
+        for (std::size_t s = 0; s < num_submitters; ++s) {
+            submitters.emplace_back([&, s]() {
+                thread_pool& pool = s % 2 == 0 ? first : second;
+                for (int i = 0; i < 200; ++i) {
+                    pool.execute([&sum, &pool]() {
+                        sum.fetch_add(1);
+                        pool.repost(new detail::detached_task([&sum]() { sum.fetch_add(1); }));
+                    });
+                }
+            });
+        }
+        for (auto& t : submitters) {
+            t.join();
+        }
+    }
+    EXPECT_EQ(sum.load(), 2 * 200 * static_cast<long>(num_submitters));
+}
+
+TEST(ThreadPoolShutdownTest, SingleWorker) {
+    thread_pool pool(1);
+    EXPECT_EQ(pool.size(), 1u);
+    auto f = pool.submit([&pool]() { return fib(pool, 16); });
+    EXPECT_EQ(f.get(), 987);
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include "work_stealing_deque.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace conc;
+
+class WorkStealingDequeTest : public ::testing::Test {
+protected:
+    work_stealing_deque<int> deque{4};
+};
+
+TEST_F(WorkStealingDequeTest, EmptyPopAndSteal) {
+    EXPECT_FALSE(deque.pop().has_value());
+    EXPECT_FALSE(deque.steal().has_value());
+    EXPECT_TRUE(deque.empty());
+}
+
+TEST_F(WorkStealingDequeTest, OwnerIsLifoThievesAreFifo) {
+    for (int i = 0; i < 4; ++i) {
+        deque.push(i);
+    }
+    EXPECT_EQ(deque.size(), 4u);
+    EXPECT_EQ(deque.pop(), 3);
+    EXPECT_EQ(deque.steal(), 0);
+    EXPECT_EQ(deque.pop(), 2);
+    EXPECT_EQ(deque.steal(), 1);
+    EXPECT_FALSE(deque.pop().has_value());
+}
+
+TEST_F(WorkStealingDequeTest, GrowsPastInitialCapacity) {
+    for (int i = 0; i < 1000; ++i) {
+        deque.push(i);
+    }
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(deque.steal(), i);
+    }
+    for (int i = 999; i >= 10; --i) {
+        EXPECT_EQ(deque.pop(), i);
+    }
+    EXPECT_TRUE(deque.empty());
+}
+
+TEST_F(WorkStealingDequeTest, EveryElementTakenExactlyOnce) {
+    const int total = 100000;
+    const int num_thieves = 3;
+    std::vector<std::atomic<int>> taken(total);
+    std::atomic<bool> done{false};
+    std::vector<std::thread> thieves;
+
+    for (int t = 0; t < num_thieves; ++t) {
+        thieves.emplace_back([&]() {
+            while (!done.load(std::memory_order_acquire) || !deque.empty()) {
+                if (auto v = deque.steal()) {
+                    taken[*v].fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // the owner interleaves pushes with pops so that it races thieves for the last element
+    for (int i = 0; i < total; ++i) {
+        deque.push(i);
+        if (i % 3 == 0) {
+            if (auto v = deque.pop()) {
+                taken[*v].fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+    while (auto v = deque.pop()) {
+        taken[*v].fetch_add(1, std::memory_order_relaxed);
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& t : thieves) {
+        t.join();
+    }
+
+    EXPECT_TRUE(std::all_of(taken.begin(), taken.end(), [](const std::atomic<int>& c) { return c.load() == 1; }));
+}
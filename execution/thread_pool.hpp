@@ -0,0 +1,442 @@
+#pragma once
+
+#include "work_stealing_deque.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <new>
+#include <optional>
+#include <mpsc_queue.hpp>
+#include <parking_lot.hpp>
+#include <spin.hpp>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace conc {
+
+template<typename R>
+class task_future;
+
+namespace detail {
+
+// the link puts a task on a pool's injection queue, where it can be at most once at a time
+struct task_base : mpsc_node {
+    virtual ~task_base() = default;
+    // runs the task and gives up the pool's reference to it
+    virtual void run() noexcept = 0;
+};
+
+template<typename F>
+struct detached_task final : task_base {
+    explicit detached_task(F&& f) : fn(std::move(f)) {}
+
+    void run() noexcept override {
+        // an exception escaping a fire-and-forget task has nowhere to go
+        fn();
+        delete this;
+    }
+
+    F fn;
+};
+
+// result slot shared by a running task and its future
+template<typename R>
+struct task_state {
+    static constexpr std::uint32_t PENDING = 0;
+    static constexpr std::uint32_t READY = 1;
+    static constexpr std::uint32_t FAILED = 2;
+
+    using stored = std::conditional_t<std::is_void_v<R>, std::monostate, R>;
+
+    virtual ~task_state() = default;
+
+    void release() noexcept {
+        if(refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    std::atomic<std::uint32_t> state = PENDING;
+    // the task and the future
+    std::atomic<std::uint32_t> refs = 2;
+    std::optional<stored> value;
+    std::exception_ptr error;
+};
+
+template<typename F, typename R>
+struct future_task final : task_base, task_state<R> {
+    explicit future_task(F&& f) : fn(std::move(f)) {}
+
+    void run() noexcept override {
+        std::uint32_t outcome = task_state<R>::READY;
+        try {
+            if constexpr(std::is_void_v<R>) {
+                fn();
+                this->value.emplace();
+            } else {
+                this->value.emplace(fn());
+            }
+        } catch(...) {
+            this->error = std::current_exception();
+            outcome = task_state<R>::FAILED;
+        }
+        this->state.store(outcome, std::memory_order_release);
+        this->state.notify_all();
+        this->release();
+    }
+
+    F fn;
+};
+
+}
+
+// Work-stealing thread pool: every worker owns a Chase-Lev deque that its own spawns go to and
+// that it pops LIFO, idle workers steal FIFO from randomly chosen victims; submissions from other
+// threads go through the pool's intrusive MPSC injection queue, whose consumer side the workers
+// take turns on, so it needs no hazard cells. Workers that run out of work spin in a searching
+// state for a while and then sleep on the parking lot behind an event count, so a spawn only
+// pays for a wakeup when nobody is searching and somebody sleeps, and no wakeup is lost.
+// A worker waiting on a task_future keeps running other tasks meanwhile.
+class thread_pool {
+   private:
+    // steal sweeps an idle worker performs before it goes to sleep
+    static constexpr std::uint32_t SEARCH_ROUNDS = 64;
+
+    struct alignas(std::hardware_destructive_interference_size) worker {
+        work_stealing_deque<detail::task_base*> deque;
+        std::size_t index = 0;
+        std::uint64_t rng = 0;
+        std::thread thread;
+    };
+
+   public:
+    explicit thread_pool(std::size_t threads = std::max(1u, std::thread::hardware_concurrency())) {
+        threads = std::max<std::size_t>(threads, 1);
+        for(std::size_t i = 0; i < threads; ++i) {
+            m_workers.push_back(std::make_unique<worker>());
+            m_workers.back()->index = i;
+            m_workers.back()->rng = 0x9E3779B97F4A7C15ull * (i + 1);
+        }
+        for(std::size_t i = 0; i < threads; ++i) {
+            m_workers[i]->thread = std::thread([this, i]() { run_worker(*m_workers[i]); });
+        }
+    }
+
+    thread_pool(thread_pool const&) = delete;
+    thread_pool(thread_pool&& other) = delete;
+    thread_pool& operator=(thread_pool const&) = delete;
+    thread_pool& operator=(thread_pool &&) = delete;
+
+    // runs every task submitted so far, including the ones they spawn, then joins the workers;
+    // nothing may be submitted from outside once destruction started
+    ~thread_pool() {
+        m_stop.store(true, std::memory_order_seq_cst);
+        m_epoch.fetch_add(1, std::memory_order_seq_cst);
+        parking_lot::unpark_all(&m_epoch);
+        for(auto& w : m_workers) {
+            w->thread.join();
+        }
+    }
+
+   public:
+    // fire and forget, f must not throw
+    template<typename F>
+    requires(std::is_invocable_v<std::decay_t<F>&>)
+    void execute(F&& f) {
+        schedule(new detail::detached_task<std::decay_t<F>>(std::decay_t<F>(std::forward<F>(f))));
+    }
+
+    template<typename F>
+    requires(std::is_invocable_v<std::decay_t<F>&>)
+    task_future<std::invoke_result_t<std::decay_t<F>&>> submit(F&& f) {
+        using R = std::invoke_result_t<std::decay_t<F>&>;
+        auto* t = new detail::future_task<std::decay_t<F>, R>(std::decay_t<F>(std::forward<F>(f)));
+        schedule(t);
+        return task_future<R>(t);
+    }
+
+    // schedules a task the caller keeps alive, its run() is called once per post and gives up
+    // the reference the post handed to the pool
+    void post(detail::task_base* t) {
+        schedule(t);
+    }
+
+    // like post but behind everything already queued, for tasks that yield after a time slice
+    // and would otherwise be popped again right away from the worker's own deque
+    void repost(detail::task_base* t) {
+        inject(t);
+        notify();
+    }
+
+    [[nodiscard]]
+    std::size_t size() const noexcept {
+        return m_workers.size();
+    }
+
+    // runs one queued task if the calling thread is a worker of some pool, used by waiting futures
+    static bool help_one() noexcept {
+        if(tl_worker == nullptr) {
+            return false;
+        }
+        detail::task_base* t = tl_pool->find_task(*tl_worker);
+        if(t == nullptr) {
+            return false;
+        }
+        t->run();
+        return true;
+    }
+
+    [[nodiscard]]
+    static bool on_worker_thread() noexcept {
+        return tl_worker != nullptr;
+    }
+
+    [[nodiscard]]
+    bool owns_current_thread() const noexcept {
+        return tl_pool == this;
+    }
+
+    // index in [0, size()) on a worker of this pool, size() on any other thread
+    [[nodiscard]]
+    std::size_t current_worker_index() const noexcept {
+        return tl_pool == this ? tl_worker->index : m_workers.size();
+    }
+
+    // true when the calling worker has nothing queued that thieves could take, the signal lazy
+    // binary splitting uses to decide when to split; false off the pool
+    [[nodiscard]]
+    static bool local_queue_empty() noexcept {
+        return tl_worker != nullptr && tl_worker->deque.empty();
+    }
+
+   private:
+    void schedule(detail::task_base* t) {
+        if(tl_pool == this) [[likely]] {
+            tl_worker->deque.push(t);
+        } else {
+            inject(t);
+        }
+        notify();
+    }
+
+    void inject(detail::task_base* t) noexcept {
+        // counted before it is linked: a worker that sees the count either finds the task or
+        // comes before the push, whose notify then wakes somebody
+        m_injected.fetch_add(1, std::memory_order_seq_cst);
+        m_injection.push(t);
+    }
+
+    // the injection queue has one consumer side, the worker that grabs the flag takes a task and
+    // wakes another one for the rest; the count keeps idle workers off the flag while it is empty
+    detail::task_base* take_injected() noexcept {
+        if(m_injected.load(std::memory_order_seq_cst) == 0 || m_injection_taken.load(std::memory_order_relaxed)
+           || m_injection_taken.exchange(true, std::memory_order_acquire)) {
+            return nullptr;
+        }
+        detail::task_base* t = m_injection.pop();
+        m_injection_taken.store(false, std::memory_order_release);
+        if(t != nullptr && m_injected.fetch_sub(1, std::memory_order_relaxed) > 1) {
+            notify();
+        }
+        return t;
+    }
+
+    // event count signal side: pairs with the sleepers/searching updates in run_worker
+    void notify() noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(m_sleepers.load(std::memory_order_relaxed) == 0 || m_searching.load(std::memory_order_relaxed) != 0) [[likely]] {
+            return;
+        }
+        m_epoch.fetch_add(1, std::memory_order_seq_cst);
+        parking_lot::unpark_one(&m_epoch);
+    }
+
+    detail::task_base* find_task(worker& self) noexcept {
+        if(auto t = self.deque.pop()) {
+            return *t;
+        }
+        if(detail::task_base* t = take_injected()) {
+            return t;
+        }
+
+        // xorshift64 picks where the sweep over the victims starts
+        self.rng ^= self.rng << 13;
+        self.rng ^= self.rng >> 7;
+        self.rng ^= self.rng << 17;
+        const std::size_t n = m_workers.size();
+        const std::size_t start = self.rng % n;
+        for(std::size_t i = 0; i < n; ++i) {
+            worker& victim = *m_workers[(start + i) % n];
+            if(&victim == &self) {
+                continue;
+            }
+            if(auto t = victim.deque.steal()) {
+                return *t;
+            }
+        }
+        return nullptr;
+    }
+
+    void run_worker(worker& self) {
+        tl_pool = this;
+        tl_worker = &self;
+
+        while(true) {
+            if(detail::task_base* t = find_task(self)) {
+                t->run();
+                continue;
+            }
+
+            // searching: spinners absorb new work without anybody paying for a wakeup
+            m_searching.fetch_add(1, std::memory_order_seq_cst);
+            detail::task_base* t = nullptr;
+            spin_wait wait;
+            for(std::uint32_t round = 0; round < SEARCH_ROUNDS && t == nullptr; ++round) {
+                wait();
+                t = find_task(self);
+            }
+            if(t != nullptr) {
+                m_searching.fetch_sub(1, std::memory_order_seq_cst);
+                t->run();
+                continue;
+            }
+
+            // announce the sleep before the last look, a spawn after it either shows up in the
+            // look or sees us and bumps the epoch
+            m_sleepers.fetch_add(1, std::memory_order_seq_cst);
+            m_searching.fetch_sub(1, std::memory_order_seq_cst);
+            const std::uint64_t epoch = m_epoch.load(std::memory_order_seq_cst);
+
+            t = find_task(self);
+            if(t == nullptr && !m_stop.load(std::memory_order_seq_cst)) {
+                parking_lot::park(&m_epoch, [this, epoch]() noexcept {
+                    return m_epoch.load(std::memory_order_relaxed) == epoch;
+                });
+            }
+            m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+
+            if(t != nullptr) {
+                t->run();
+            } else if(m_stop.load(std::memory_order_seq_cst)) {
+                // the last look came after stop was set, so our share of the work is done
+                if(detail::task_base* last = find_task(self)) {
+                    last->run();
+                    continue;
+                }
+                break;
+            }
+        }
+
+        tl_worker = nullptr;
+        tl_pool = nullptr;
+    }
+
+   private:
+    inline static thread_local thread_pool* tl_pool = nullptr;
+    inline static thread_local worker* tl_worker = nullptr;
+
+    std::vector<std::unique_ptr<worker>> m_workers;
+
+    alignas(std::hardware_destructive_interference_size)
+    intrusive_mpsc_queue<detail::task_base> m_injection;
+    std::atomic<std::size_t> m_injected = 0;
+    std::atomic<bool> m_injection_taken = false;
+
+    alignas(std::hardware_destructive_interference_size)
+    std::atomic<std::uint64_t> m_epoch = 0;
+    std::atomic<std::uint32_t> m_sleepers = 0;
+    std::atomic<std::uint32_t> m_searching = 0;
+    std::atomic<bool> m_stop = false;
+};
+
+// Handle to the result of a submitted task. get() may be called once; waiting on a worker
+// thread runs other tasks instead of blocking, so tasks can wait on the tasks they spawned.
+template<typename R>
+class task_future {
+   private:
+    using state_t = detail::task_state<R>;
+
+   public:
+    task_future() noexcept = default;
+    task_future(task_future const&) = delete;
+    task_future(task_future&& other) noexcept : m_state(std::exchange(other.m_state, nullptr)) {}
+    task_future& operator=(task_future const&) = delete;
+    task_future& operator=(task_future&& other) noexcept {
+        if(this != &other) {
+            reset();
+            m_state = std::exchange(other.m_state, nullptr);
+        }
+        return *this;
+    }
+
+    ~task_future() {
+        reset();
+    }
+
+   public:
+    [[nodiscard]]
+    bool valid() const noexcept {
+        return m_state != nullptr;
+    }
+
+    [[nodiscard]]
+    bool ready() const noexcept {
+        return m_state->state.load(std::memory_order_acquire) != state_t::PENDING;
+    }
+
+    void wait() const noexcept {
+        if(thread_pool::on_worker_thread()) {
+            spin_wait idle;
+            while(!ready()) {
+                if(!thread_pool::help_one()) {
+                    idle();
+                }
+            }
+            return;
+        }
+
+        std::uint32_t s = m_state->state.load(std::memory_order_acquire);
+        while(s == state_t::PENDING) {
+            m_state->state.wait(s, std::memory_order_acquire);
+            s = m_state->state.load(std::memory_order_acquire);
+        }
+    }
+
+    // rethrows the task's exception
+    R get() {
+        wait();
+        state_t* s = std::exchange(m_state, nullptr);
+        struct releaser {
+            state_t* state;
+            ~releaser() { state->release(); }
+        } guard{s};
+
+        if(s->state.load(std::memory_order_acquire) == state_t::FAILED) {
+            std::rethrow_exception(s->error);
+        }
+        if constexpr(!std::is_void_v<R>) {
+            return std::move(*s->value);
+        }
+    }
+
+   private:
+    friend class thread_pool;
+    explicit task_future(state_t* state) noexcept : m_state(state) {}
+
+    void reset() noexcept {
+        if(m_state != nullptr) {
+            std::exchange(m_state, nullptr)->release();
+        }
+    }
+
+   private:
+    state_t* m_state = nullptr;
+};
+
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace conc {
+
+// Chase-Lev work-stealing deque with the C11 orderings of Le, Pop, Cohen, Zappa Nardelli,
+// "Correct and Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013): the owner pushes
+// and pops at the bottom without atomic read-modify-writes except when racing thieves for the
+// last element, thieves CAS the top. The circular array doubles when full; replaced arrays may
+// still be read by a thief, they are kept until the deque is destroyed.
+template<typename T>
+requires(std::is_trivially_copyable_v<T> && std::atomic<T>::is_always_lock_free)
+class work_stealing_deque {
+   private:
+    struct array {
+        explicit array(std::size_t c) : capacity(c), slots(std::make_unique<std::atomic<T>[]>(c)) {}
+
+        T get(std::int64_t i) const noexcept {
+            return slots[static_cast<std::size_t>(i) & (capacity - 1)].load(std::memory_order_relaxed);
+        }
+
+        void put(std::int64_t i, T value) noexcept {
+            slots[static_cast<std::size_t>(i) & (capacity - 1)].store(value, std::memory_order_relaxed);
+        }
+
+        const std::size_t capacity;
+        std::unique_ptr<std::atomic<T>[]> slots;
+    };
+
+   public:
+    explicit work_stealing_deque(std::size_t capacity = 256) {
+        std::size_t c = 2;
+        while(c < capacity) {
+            c *= 2;
+        }
+        m_arrays.push_back(std::make_unique<array>(c));
+        m_array.store(m_arrays.back().get(), std::memory_order_relaxed);
+    }
+
+    work_stealing_deque(work_stealing_deque const&) = delete;
+    work_stealing_deque(work_stealing_deque&& other) = delete;
+    work_stealing_deque& operator=(work_stealing_deque const&) = delete;
+    work_stealing_deque& operator=(work_stealing_deque &&) = delete;
+
+   public:
+    // owner only
+    void push(T value) {
+        const std::int64_t b = m_bottom.load(std::memory_order_relaxed);
+        const std::int64_t t = m_top.load(std::memory_order_acquire);
+        array* a = m_array.load(std::memory_order_relaxed);
+        if(b - t > static_cast<std::int64_t>(a->capacity) - 1) [[unlikely]] {
+            a = grow(a, t, b);
+        }
+        a->put(b, value);
+        // release: a thief that sees the new bottom also sees the element
+        m_bottom.store(b + 1, std::memory_order_release);
+    }
+
+    // owner only, LIFO
+    std::optional<T> pop() noexcept {
+        const std::int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+        array* a = m_array.load(std::memory_order_relaxed);
+        m_bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = m_top.load(std::memory_order_relaxed);
+
+        if(t > b) {
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        T value = a->get(b);
+        if(t == b) {
+            // last element, race the thieves for it
+            const bool won = m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            if(!won) {
+                return std::nullopt;
+            }
+        }
+        return value;
+    }
+
+    // any thread, FIFO; nullopt when empty or when another thief won the race
+    std::optional<T> steal() noexcept {
+        std::int64_t t = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::int64_t b = m_bottom.load(std::memory_order_acquire);
+        if(t >= b) {
+            return std::nullopt;
+        }
+
+        T value = m_array.load(std::memory_order_acquire)->get(t);
+        if(!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    // approximate unless called by the owner with no thief active
+    [[nodiscard]]
+    std::size_t size() const noexcept {
+        const std::int64_t b = m_bottom.load(std::memory_order_relaxed);
+        const std::int64_t t = m_top.load(std::memory_order_relaxed);
+        return b > t ? static_cast<std::size_t>(b - t) : 0;
+    }
+
+    [[nodiscard]]
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+   private:
+    array* grow(array* a, std::int64_t t, std::int64_t b) {
+        auto bigger = std::make_unique<array>(a->capacity * 2);
+        for(std::int64_t i = t; i < b; ++i) {
+            bigger->put(i, a->get(i));
+        }
+        m_arrays.push_back(std::move(bigger));
+        array* next = m_arrays.back().get();
+        m_array.store(next, std::memory_order_release);
+        return next;
+    }
+
+   private:
+    alignas(std::hardware_destructive_interference_size)
+    std::atomic<std::int64_t> m_top = 0;
+    alignas(std::hardware_destructive_interference_size)
+    std::atomic<std::int64_t> m_bottom = 0;
+    std::atomic<array*> m_array;
+    // owner only: every array ever used, the last one is current
+    std::vector<std::unique_ptr<array>> m_arrays;
+};
+
+}
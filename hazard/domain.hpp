@@ -25,21 +25,24 @@ class hazard_domain {
     domain_cell<T>* capture_cell() noexcept {
         T* null;
 
-        auto it = m_acquire_list.begin();
-        for(;it != m_acquire_list.end(); ++it) {
+        // start at the cell this thread captured last, it is usually free again
+        // and threads stop colliding on the first cells
+        for(std::size_t n = 0; n < max_objects; ++n) {
+            const std::size_t i = (tl_hint + n) % max_objects;
             null = nullptr;
 
-            if(it->pointer.compare_exchange_strong(
+            if(m_acquire_list[i].pointer.compare_exchange_strong(
                 null,
                 SENTINEL,
                 std::memory_order_acq_rel,
                 std::memory_order_relaxed
             )) {
-                return &(*it);
+                tl_hint = i;
+                return &m_acquire_list[i];
             }
         }
 
-        assert(it != m_acquire_list.end());
+        assert(false);
         std::unreachable();
     }
 
@@ -52,6 +55,9 @@ class hazard_domain {
     }
 
     void delete_hazards() noexcept {
+        // orders the unlinking of the retired objects before the scan, so a protection either
+        // shows up in it or its validating reload sees the object unlinked
+        std::atomic_thread_fence(std::memory_order_seq_cst);
         for(std::size_t i = 0; i < tl_retire.size(); ++i) {
             if(!scan_for_hazard(tl_retire[i])) {
                 delete tl_retire[i];
@@ -81,6 +87,9 @@ class hazard_domain {
     inline static thread_local
      std::vector<T*> tl_retire;
 
+    inline static thread_local
+     std::size_t tl_hint = 0;
+
     // placeholder value to a aligned storage to mark cell that is captured and yet to be used
     // could use reinterpreted cast to domain address, but made for compiler/standard grooming
     alignas(T) inline static 
@@ -100,7 +100,11 @@ class hazard_pointer {
             return;
         }
 
+        // release: a scan that reads the new value is ordered after our use of the previously
+        // protected object. The fence alone keeps the caller's validating reload from being
+        // ordered before the publication; it pairs with the one delete_hazards issues first
         m_cell->pointer.store(ptr, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
     }
 
     void reset_protection(std::nullptr_t t = nullptr) noexcept {
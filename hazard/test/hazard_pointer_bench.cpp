@@ -0,0 +1,77 @@
+#include <benchmark/benchmark.h>
+#include "hazard_pointer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+// hazard pointer protect and retire under a sweep of thread counts and operation mixes: every
+// iteration either protects the object in a shared slot and reads it, or replaces it and
+// retires the old one; the argument is the share of replacements in percent. ops/s is the
+// total over all threads, ops/s/thr the average of one thread. Every thread holds one cell of the
+// domain, so thread counts go up to twice the hardware threads but stop at its CELLS.
+
+namespace {
+
+struct object {
+    explicit object(std::uint64_t v) noexcept : value(v) {}
+    std::uint64_t value;
+};
+
+constexpr std::size_t CELLS = 128;
+
+using domain = conc::hazard_domain<object, CELLS, object>;
+using hazard_pointer_t = conc::hazard_pointer<object, domain>;
+
+void sweep(benchmark::internal::Benchmark* b) {
+    const int hardware = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    for (int mix : {0, 10, 50}) {
+        b->Arg(mix);
+    }
+    const int limit = std::min(hardware * 2, static_cast<int>(CELLS));
+    for (int n = 1; n < hardware && n < limit; n *= 2) {
+        b->Threads(n);
+    }
+    b->Threads(std::min(hardware, limit));
+    if (hardware * 2 <= limit) {
+        b->Threads(hardware * 2);
+    }
+    b->UseRealTime();
+}
+
+std::atomic<object*> g_slot{nullptr};
+
+void bm_protect_retire(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        g_slot.store(new object(0));
+    }
+    auto hp = hazard_pointer_t::make_hazard_pointer();
+    const auto threshold = static_cast<std::uint64_t>(state.range(0)) * 0x10000 / 100;
+    std::uint64_t rng = 0x9E3779B97F4A7C15ull * (state.thread_index() + 1);
+    std::uint64_t sum = 0;
+    for (auto _ : state) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        if ((rng & 0xFFFF) < threshold) {
+            object* old = g_slot.exchange(new object(rng), std::memory_order_acq_rel);
+            hazard_pointer_t::retire(old);
+        } else {
+            sum += hp.protect(g_slot)->value;
+            hp.reset_protection();
+        }
+    }
+    benchmark::DoNotOptimize(sum);
+
+    const auto ops = static_cast<double>(state.iterations());
+    state.counters["ops/s"] = benchmark::Counter(ops, benchmark::Counter::kIsRate);
+    state.counters["ops/s/thr"] = benchmark::Counter(ops, benchmark::Counter::kAvgThreadsRate);
+    if (state.thread_index() == 0) {
+        delete g_slot.exchange(nullptr);
+    }
+}
+
+}
+
+BENCHMARK(bm_protect_retire)->Apply(sweep);
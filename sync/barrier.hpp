@@ -0,0 +1,202 @@
+#pragma once
+
+#include "futex.hpp"
+#include "spin.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace conc {
+
+enum class wait_policy {
+    // waiters spin on their own cache line, yielding once spinning runs long
+    spin,
+    // waiters spin for a while and then sleep on a futex
+    block,
+};
+
+namespace detail {
+
+// word a barrier waiter spins on, on a line of its own; sleepers lets a releaser skip the
+// futex wake when nobody went to sleep
+struct alignas(std::hardware_destructive_interference_size) barrier_word {
+    std::atomic<std::uint32_t> value = 0;
+    std::atomic<std::uint32_t> sleepers = 0;
+};
+
+template<wait_policy policy, typename Done>
+void barrier_wait(barrier_word& word, Done done) noexcept {
+    spin_wait wait;
+    for(std::uint32_t spins = 0; policy == wait_policy::spin || spins < spin_wait::SPINS; ++spins) {
+        if(done(word.value.load(std::memory_order_acquire))) {
+            return;
+        }
+        wait();
+    }
+
+    // seq_cst pairs with barrier_publish: either the releaser sees us or we see its value
+    word.sleepers.fetch_add(1, std::memory_order_seq_cst);
+    std::uint32_t value = word.value.load(std::memory_order_seq_cst);
+    while(!done(value)) {
+        futex_wait(word.value, value);
+        value = word.value.load(std::memory_order_acquire);
+    }
+    word.sleepers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+template<wait_policy policy>
+void barrier_publish(barrier_word& word, std::uint32_t value) noexcept {
+    if constexpr(policy == wait_policy::spin) {
+        word.value.store(value, std::memory_order_release);
+    } else {
+        word.value.store(value, std::memory_order_seq_cst);
+        if(word.sleepers.load(std::memory_order_seq_cst) != 0) {
+            futex_wake_all(word.value);
+        }
+    }
+}
+
+}
+
+// Software combining tree barrier with sense reversal (Mellor-Crummey, Scott, "Algorithms for
+// Scalable Synchronization on Shared-Memory Multiprocessors", 1991): participants arrive at a
+// leaf shared with fan_in - 1 others, the last arrival at a node climbs to its parent and, once
+// the root completes, flips the sense of every node on its way back down. Waiters spin on their
+// leaf only, so an episode costs O(log P) cache-line transfers instead of P on one counter.
+template<wait_policy policy = wait_policy::spin>
+class combining_tree_barrier {
+   private:
+    struct alignas(std::hardware_destructive_interference_size) node {
+        std::atomic<std::uint32_t> count = 0;
+        std::uint32_t fan_in = 0;
+        node* parent = nullptr;
+        detail::barrier_word sense;
+    };
+
+    struct alignas(std::hardware_destructive_interference_size) participant {
+        std::uint32_t sense = 0;
+    };
+
+   public:
+    explicit combining_tree_barrier(std::size_t participants, std::size_t fan_in = 4) :
+        m_participants(std::make_unique<participant[]>(std::max<std::size_t>(participants, 1))),
+        m_fan_in(std::max<std::size_t>(fan_in, 2)) {
+        // width of every level, leaves first
+        std::vector<std::size_t> widths;
+        std::size_t width = std::max<std::size_t>(participants, 1);
+        do {
+            width = (width + m_fan_in - 1) / m_fan_in;
+            widths.push_back(width);
+        } while(width > 1);
+
+        std::size_t total = 0;
+        for(std::size_t w : widths) {
+            total += w;
+        }
+        m_nodes = std::make_unique<node[]>(total);
+
+        std::size_t offset = 0;
+        std::size_t below = std::max<std::size_t>(participants, 1);
+        for(std::size_t level = 0; level < widths.size(); ++level) {
+            for(std::size_t i = 0; i < widths[level]; ++i) {
+                node& n = m_nodes[offset + i];
+                n.fan_in = static_cast<std::uint32_t>(std::min(m_fan_in, below - i * m_fan_in));
+                n.count.store(n.fan_in, std::memory_order_relaxed);
+                if(level + 1 < widths.size()) {
+                    n.parent = &m_nodes[offset + widths[level] + i / m_fan_in];
+                }
+            }
+            below = widths[level];
+            offset += widths[level];
+        }
+    }
+
+    combining_tree_barrier(combining_tree_barrier const&) = delete;
+    combining_tree_barrier(combining_tree_barrier&& other) = delete;
+    combining_tree_barrier& operator=(combining_tree_barrier const&) = delete;
+    combining_tree_barrier& operator=(combining_tree_barrier &&) = delete;
+
+   public:
+    // id in [0, participants), each participant uses its own; returns true for exactly one
+    // participant per episode, the one that completed it
+    bool arrive_and_wait(std::size_t id) noexcept {
+        participant& self = m_participants[id];
+        self.sense ^= 1;
+        return arrive(m_nodes[id / m_fan_in], self.sense);
+    }
+
+   private:
+    static bool arrive(node& n, std::uint32_t sense) noexcept {
+        if(n.count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            const bool serial = n.parent == nullptr || arrive(*n.parent, sense);
+            // reset before the release, the next episode starts only after it
+            n.count.store(n.fan_in, std::memory_order_relaxed);
+            detail::barrier_publish<policy>(n.sense, sense);
+            return serial;
+        }
+
+        detail::barrier_wait<policy>(n.sense, [sense](std::uint32_t value) noexcept { return value == sense; });
+        return false;
+    }
+
+   private:
+    std::unique_ptr<participant[]> m_participants;
+    std::unique_ptr<node[]> m_nodes;
+    const std::size_t m_fan_in;
+};
+
+// Dissemination barrier (Hensgen, Finkel, Manber 1988): in round r participant i signals
+// participant (i + 2^r) mod P and waits for the signal of (i - 2^r) mod P, ceil(log2 P) rounds
+// with no single point of contention. Sense reversal is generalized to an episode number, so
+// flags never need resetting and no parity copies are needed.
+template<wait_policy policy = wait_policy::spin>
+class dissemination_barrier {
+   private:
+    struct alignas(std::hardware_destructive_interference_size) participant {
+        std::uint32_t episode = 0;
+    };
+
+   public:
+    explicit dissemination_barrier(std::size_t participants) :
+        m_count(std::max<std::size_t>(participants, 1)),
+        m_rounds(std::bit_width(m_count - 1)),
+        m_participants(std::make_unique<participant[]>(m_count)),
+        m_flags(std::make_unique<detail::barrier_word[]>(std::max<std::size_t>(m_count * m_rounds, 1))) {}
+
+    dissemination_barrier(dissemination_barrier const&) = delete;
+    dissemination_barrier(dissemination_barrier&& other) = delete;
+    dissemination_barrier& operator=(dissemination_barrier const&) = delete;
+    dissemination_barrier& operator=(dissemination_barrier &&) = delete;
+
+   public:
+    // id in [0, participants), each participant uses its own; returns true for participant 0
+    bool arrive_and_wait(std::size_t id) noexcept {
+        const std::uint32_t episode = ++m_participants[id].episode;
+        for(std::size_t round = 0; round < m_rounds; ++round) {
+            const std::size_t partner = (id + (std::size_t(1) << round)) % m_count;
+            detail::barrier_publish<policy>(flag(partner, round), episode);
+            detail::barrier_wait<policy>(flag(id, round), [episode](std::uint32_t value) noexcept {
+                // wrap-safe "value >= episode", a fast partner may already be one episode ahead
+                return static_cast<std::int32_t>(value - episode) >= 0;
+            });
+        }
+        return id == 0;
+    }
+
+   private:
+    detail::barrier_word& flag(std::size_t id, std::size_t round) noexcept {
+        return m_flags[id * m_rounds + round];
+    }
+
+   private:
+    const std::size_t m_count;
+    const std::size_t m_rounds;
+    std::unique_ptr<participant[]> m_participants;
+    std::unique_ptr<detail::barrier_word[]> m_flags;
+};
+
+}
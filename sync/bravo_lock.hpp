@@ -0,0 +1,187 @@
+#pragma once
+
+#include "spin.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <shared_mutex>
+
+namespace conc {
+
+namespace detail {
+
+// visible readers table shared by every bravo_lock: a fast-path reader publishes the address of
+// the lock it holds in a slot hashed from the lock and the thread, writers scan for their lock
+inline constexpr std::size_t VISIBLE_READERS = 4096;
+
+inline std::array<std::atomic<const void*>, VISIBLE_READERS>& visible_readers() noexcept {
+    static std::array<std::atomic<const void*>, VISIBLE_READERS> s_table{};
+    return s_table;
+}
+
+}
+
+// BRAVO (Dice, Kogan, "BRAVO - Biased Locking for Reader-Writer Locks", USENIX ATC 2019): while
+// the lock is read-biased a reader only CASes its own slot of the visible readers table and never
+// touches the underlying lock. A writer takes the underlying lock, revokes the bias and waits for
+// the published readers to leave; bias stays off for N times the revocation cost, so frequent
+// writers fall back to the plain underlying lock.
+template<typename Lock = std::shared_mutex>
+class bravo_lock {
+   private:
+    using clock = std::chrono::steady_clock;
+
+    // inhibit multiplier of the paper, bounds the slowdown of writers to about 1/N
+    static constexpr std::int64_t N = 9;
+
+    // shared locks a thread can hold on the fast path at once, further ones take the slow path
+    static constexpr std::size_t MAX_HELD = 8;
+
+   public:
+    bravo_lock() = default;
+    bravo_lock(bravo_lock const&) = delete;
+    bravo_lock(bravo_lock&& other) = delete;
+    bravo_lock& operator=(bravo_lock const&) = delete;
+    bravo_lock& operator=(bravo_lock &&) = delete;
+
+   public:
+    void lock() {
+        m_base.lock();
+        if(m_read_bias.load(std::memory_order_relaxed)) {
+            revoke(true);
+        }
+    }
+
+    // fails instead of waiting when fast-path readers are present
+    [[nodiscard]]
+    bool try_lock() {
+        if(!m_base.try_lock()) {
+            return false;
+        }
+        if(m_read_bias.load(std::memory_order_relaxed) && !revoke(false)) {
+            m_read_bias.store(true, std::memory_order_relaxed);
+            m_base.unlock();
+            return false;
+        }
+        return true;
+    }
+
+    void unlock() {
+        m_base.unlock();
+    }
+
+    void lock_shared() {
+        if(try_fast_shared()) [[likely]] {
+            return;
+        }
+        m_base.lock_shared();
+        restore_bias();
+    }
+
+    [[nodiscard]]
+    bool try_lock_shared() {
+        if(try_fast_shared()) [[likely]] {
+            return true;
+        }
+        if(!m_base.try_lock_shared()) {
+            return false;
+        }
+        restore_bias();
+        return true;
+    }
+
+    void unlock_shared() {
+        for(std::size_t i = 0; i < tl_held.count; ++i) {
+            if(tl_held.entries[i].lock == this) {
+                tl_held.entries[i].slot->store(nullptr, std::memory_order_release);
+                tl_held.entries[i] = tl_held.entries[--tl_held.count];
+                return;
+            }
+        }
+        m_base.unlock_shared();
+    }
+
+    [[nodiscard]]
+    bool read_biased() const noexcept {
+        return m_read_bias.load(std::memory_order_relaxed);
+    }
+
+   private:
+    bool try_fast_shared() noexcept {
+        if(!m_read_bias.load(std::memory_order_relaxed) || tl_held.count == MAX_HELD) {
+            return false;
+        }
+
+        auto& slot = detail::visible_readers()[slot_index()];
+        const void* expected = nullptr;
+        if(!slot.compare_exchange_strong(expected, this, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            // slot taken by another reader, collisions fall back to the underlying lock
+            return false;
+        }
+
+        // a writer clears the bias before scanning, so either it sees our slot or we see no bias
+        if(m_read_bias.load(std::memory_order_seq_cst)) [[likely]] {
+            tl_held.entries[tl_held.count++] = {this, &slot};
+            return true;
+        }
+        slot.store(nullptr, std::memory_order_relaxed);
+        return false;
+    }
+
+    // called with the underlying lock held shared, so no writer is revoking concurrently
+    void restore_bias() noexcept {
+        if(!m_read_bias.load(std::memory_order_relaxed) &&
+           clock::now().time_since_epoch().count() >= m_inhibit_until.load(std::memory_order_relaxed)) {
+            // release: fast-path readers that see the bias also see the last writer's changes
+            m_read_bias.store(true, std::memory_order_release);
+        }
+    }
+
+    // called with the underlying lock held exclusively, false when `wait` is not set and a
+    // fast-path reader is still inside
+    bool revoke(bool wait) {
+        m_read_bias.store(false, std::memory_order_seq_cst);
+        const auto start = clock::now();
+
+        for(const auto& slot : detail::visible_readers()) {
+            spin_wait spin;
+            while(slot.load(std::memory_order_seq_cst) == this) {
+                if(!wait) {
+                    return false;
+                }
+                spin();
+            }
+        }
+
+        const auto now = clock::now();
+        m_inhibit_until.store((now + (now - start) * N).time_since_epoch().count(), std::memory_order_relaxed);
+        return true;
+    }
+
+    std::size_t slot_index() const noexcept {
+        const auto lock = reinterpret_cast<std::uintptr_t>(this);
+        const auto thread = reinterpret_cast<std::uintptr_t>(&tl_held);
+        std::uint64_t h = (lock ^ (thread * 0x9E3779B97F4A7C15ull)) * 0xBF58476D1CE4E5B9ull;
+        return static_cast<std::size_t>(h >> 32) % detail::VISIBLE_READERS;
+    }
+
+   private:
+    // fast-path shared holds of this thread, so unlock_shared knows which path to undo
+    struct held_locks {
+        struct entry {
+            const bravo_lock* lock;
+            std::atomic<const void*>* slot;
+        };
+        std::array<entry, MAX_HELD> entries;
+        std::size_t count = 0;
+    };
+
+    inline static thread_local held_locks tl_held;
+
+    std::atomic<bool> m_read_bias = true;
+    std::atomic<clock::rep> m_inhibit_until = 0;
+    Lock m_base;
+};
+
+}
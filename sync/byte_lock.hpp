@@ -0,0 +1,146 @@
+#pragma once
+
+#include "parking_lot.hpp"
+#include "spin.hpp"
+#include <atomic>
+#include <cstdint>
+
+namespace conc {
+
+// One-byte mutex on the parking lot (WebKit WTF::Lock): a held bit and a has-parked bit. An
+// uncontended lock/unlock is a single CAS, contended threads spin briefly and then park on the
+// byte's address; the unlocking thread clears has-parked in the unpark callback once the last
+// waiter leaves the queue.
+class byte_lock {
+   private:
+    static constexpr std::uint8_t HELD = 1;
+    static constexpr std::uint8_t PARKED = 2;
+
+    static constexpr std::uint32_t SPINS = 40;
+
+   public:
+    byte_lock() noexcept = default;
+    byte_lock(byte_lock const&) = delete;
+    byte_lock(byte_lock&& other) = delete;
+    byte_lock& operator=(byte_lock const&) = delete;
+    byte_lock& operator=(byte_lock &&) = delete;
+
+   public:
+    void lock() {
+        std::uint8_t state = 0;
+        if(m_state.compare_exchange_weak(state, HELD, std::memory_order_acquire, std::memory_order_relaxed)) [[likely]] {
+            return;
+        }
+        lock_slow();
+    }
+
+    [[nodiscard]]
+    bool try_lock() noexcept {
+        std::uint8_t state = m_state.load(std::memory_order_relaxed);
+        while(!(state & HELD)) {
+            if(m_state.compare_exchange_weak(state, state | HELD, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void unlock() {
+        std::uint8_t state = HELD;
+        if(m_state.compare_exchange_strong(state, 0, std::memory_order_release, std::memory_order_relaxed)) [[likely]] {
+            return;
+        }
+        parking_lot::unpark_one(&m_state, [this](unpark_result result) noexcept {
+            m_state.store(result.have_more ? PARKED : 0, std::memory_order_release);
+        });
+    }
+
+   private:
+    void lock_slow() {
+        std::uint32_t spins = 0;
+        while(true) {
+            std::uint8_t state = m_state.load(std::memory_order_relaxed);
+            if(!(state & HELD)) {
+                if(m_state.compare_exchange_weak(state, state | HELD, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    return;
+                }
+                continue;
+            }
+
+            // spinning is pointless once others are already parked
+            if(!(state & PARKED) && spins < SPINS) {
+                ++spins;
+                cpu_relax();
+                continue;
+            }
+
+            if(!(state & PARKED) &&
+               !m_state.compare_exchange_weak(state, state | PARKED, std::memory_order_relaxed)) {
+                continue;
+            }
+
+            parking_lot::park(&m_state, [this]() noexcept {
+                return m_state.load(std::memory_order_relaxed) == (HELD | PARKED);
+            });
+        }
+    }
+
+   private:
+    std::atomic<std::uint8_t> m_state = 0;
+};
+
+// One-byte condition variable on the parking lot (WebKit WTF::Condition), usable with any
+// BasicLockable. The waiter is queued before it releases the lock, so a notify issued under the
+// lock after the waiter released it is never lost. Waits may return spuriously.
+class byte_condition {
+   public:
+    byte_condition() noexcept = default;
+    byte_condition(byte_condition const&) = delete;
+    byte_condition(byte_condition&& other) = delete;
+    byte_condition& operator=(byte_condition const&) = delete;
+    byte_condition& operator=(byte_condition &&) = delete;
+
+   public:
+    template<typename Lock>
+    void wait(Lock& lock) {
+        parking_lot::park(
+            &m_has_waiters,
+            [this]() noexcept {
+                m_has_waiters.store(true, std::memory_order_relaxed);
+                return true;
+            },
+            [&lock]() { lock.unlock(); });
+        lock.lock();
+    }
+
+    template<typename Lock, typename Predicate>
+    void wait(Lock& lock, Predicate predicate) {
+        while(!predicate()) {
+            wait(lock);
+        }
+    }
+
+    void notify_one() {
+        if(!m_has_waiters.load(std::memory_order_relaxed)) {
+            return;
+        }
+        parking_lot::unpark_one(&m_has_waiters, [this](unpark_result result) noexcept {
+            if(!result.have_more) {
+                m_has_waiters.store(false, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    void notify_all() {
+        if(!m_has_waiters.load(std::memory_order_relaxed)) {
+            return;
+        }
+        m_has_waiters.store(false, std::memory_order_relaxed);
+        parking_lot::unpark_all(&m_has_waiters);
+    }
+
+   private:
+    std::atomic<bool> m_has_waiters = false;
+};
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace conc {
+
+// Thin futex wrappers over a 32-bit atomic word, process-private. Waits may return
+// spuriously, callers always re-check their condition. Other platforms fall back to
+// std::atomic::wait, which parks on the same word.
+#if defined(__linux__)
+static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t));
+
+// blocks while word == expected
+inline void futex_wait(std::atomic<std::uint32_t>& word, std::uint32_t expected) noexcept {
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+inline void futex_wake(std::atomic<std::uint32_t>& word, int count) noexcept {
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+
+inline void futex_wake_all(std::atomic<std::uint32_t>& word) noexcept {
+    futex_wake(word, INT_MAX);
+}
+#else
+inline void futex_wait(std::atomic<std::uint32_t>& word, std::uint32_t expected) noexcept {
+    word.wait(expected, std::memory_order_relaxed);
+}
+
+inline void futex_wake(std::atomic<std::uint32_t>& word, int count) noexcept {
+    if(count == 1) {
+        word.notify_one();
+    } else {
+        word.notify_all();
+    }
+}
+
+inline void futex_wake_all(std::atomic<std::uint32_t>& word) noexcept {
+    word.notify_all();
+}
+#endif
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "futex.hpp"
+#include "spin.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+namespace conc {
+
+// Spin-then-park mutex: a futex word with the three states of Drepper's "Futexes Are Tricky"
+// (unlocked, locked, locked with waiters), so an uncontended unlock never enters the kernel.
+// Before parking, lock() spins for an adaptive number of rounds that tracks how long recent
+// acquisitions had to spin, like glibc's PTHREAD_MUTEX_ADAPTIVE_NP.
+class hybrid_lock {
+   private:
+    static constexpr std::uint32_t UNLOCKED = 0;
+    static constexpr std::uint32_t LOCKED = 1;
+    static constexpr std::uint32_t CONTENDED = 2;
+
+    static constexpr std::int32_t MAX_SPINS = 200;
+
+   public:
+    hybrid_lock() noexcept = default;
+    hybrid_lock(hybrid_lock const&) = delete;
+    hybrid_lock(hybrid_lock&& other) = delete;
+    hybrid_lock& operator=(hybrid_lock const&) = delete;
+    hybrid_lock& operator=(hybrid_lock &&) = delete;
+
+   public:
+    void lock() noexcept {
+        std::uint32_t state = UNLOCKED;
+        if(m_state.compare_exchange_strong(state, LOCKED, std::memory_order_acquire, std::memory_order_relaxed)) [[likely]] {
+            return;
+        }
+
+        const std::int32_t estimate = m_spin_estimate.load(std::memory_order_relaxed);
+        const std::int32_t limit = std::min(MAX_SPINS, estimate * 2 + 10);
+        for(std::int32_t spins = 0; spins < limit; ++spins) {
+            state = m_state.load(std::memory_order_relaxed);
+            if(state == UNLOCKED &&
+               m_state.compare_exchange_weak(state, LOCKED, std::memory_order_acquire, std::memory_order_relaxed)) {
+                // moving average over acquisitions that succeeded by spinning
+                m_spin_estimate.store(estimate + (spins - estimate) / 8, std::memory_order_relaxed);
+                return;
+            }
+            cpu_relax();
+        }
+        m_spin_estimate.store(estimate + (limit - estimate) / 8, std::memory_order_relaxed);
+
+        // park: whoever takes the lock from here on leaves it CONTENDED, so unlock wakes someone
+        while(m_state.exchange(CONTENDED, std::memory_order_acquire) != UNLOCKED) {
+            futex_wait(m_state, CONTENDED);
+        }
+    }
+
+    [[nodiscard]]
+    bool try_lock() noexcept {
+        std::uint32_t state = UNLOCKED;
+        return m_state.compare_exchange_strong(state, LOCKED, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void unlock() noexcept {
+        if(m_state.exchange(UNLOCKED, std::memory_order_release) == CONTENDED) {
+            futex_wake(m_state, 1);
+        }
+    }
+
+   private:
+    std::atomic<std::uint32_t> m_state = UNLOCKED;
+    std::atomic<std::int32_t> m_spin_estimate = 0;
+};
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "one_shot_event.hpp"
+#include "spin.hpp"
+#include <atomic>
+#include <cstdint>
+
+namespace conc {
+
+// Single-use countdown latch in 8 bytes: a counter and a one-shot event on the parking lot.
+// Waiters spin briefly before parking, and count_down only enters the parking lot on the final
+// arrival when someone actually sleeps.
+class latch {
+   public:
+    explicit latch(std::uint32_t expected) : m_count(expected) {
+        if(expected == 0) {
+            m_done.set();
+        }
+    }
+
+    latch(latch const&) = delete;
+    latch(latch&& other) = delete;
+    latch& operator=(latch const&) = delete;
+    latch& operator=(latch &&) = delete;
+
+   public:
+    void count_down(std::uint32_t n = 1) {
+        if(m_count.fetch_sub(n, std::memory_order_acq_rel) == n) {
+            m_done.set();
+        }
+    }
+
+    [[nodiscard]]
+    bool try_wait() const noexcept {
+        return m_count.load(std::memory_order_acquire) == 0;
+    }
+
+    void wait() {
+        spin_wait spin;
+        for(std::uint32_t spins = 0; spins < spin_wait::SPINS; ++spins) {
+            if(try_wait()) {
+                return;
+            }
+            spin();
+        }
+        m_done.wait();
+    }
+
+    void arrive_and_wait(std::uint32_t n = 1) {
+        count_down(n);
+        wait();
+    }
+
+   private:
+    std::atomic<std::uint32_t> m_count;
+    one_shot_event m_done;
+};
+
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "sharded_counter.hpp"
+#include "spin.hpp"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace conc {
+
+// Readers announce themselves on their thread's counter cell, so arrive/depart are wait-free
+// and readers on different cells never share a cache line; emptiness scans all cells.
+class read_indicator {
+   public:
+    read_indicator() noexcept = default;
+    read_indicator(read_indicator const&) = delete;
+    read_indicator(read_indicator&& other) = delete;
+    read_indicator& operator=(read_indicator const&) = delete;
+    read_indicator& operator=(read_indicator &&) = delete;
+
+   public:
+    void arrive() noexcept {
+        m_readers.increment(std::memory_order_seq_cst);
+    }
+
+    void depart() noexcept {
+        m_readers.decrement(std::memory_order_release);
+    }
+
+    // a thread departs from the cell it arrived on, so no cell goes negative
+    [[nodiscard]]
+    bool empty() const noexcept {
+        return m_readers.is_zero(std::memory_order_seq_cst);
+    }
+
+   private:
+    sharded_counter m_readers;
+};
+
+// Left-Right (Ramalhete, Correia): two copies of a sequential structure, readers run on the
+// copy selected by `m_front` and are wait-free, a writer mutates the back copy, flips readers
+// over, waits for the readers of the old copy to drain and then repeats the mutation there.
+// Mutations are applied twice and therefore have to be deterministic.
+template<typename T>
+class left_right {
+   public:
+    template<typename... Args>
+    requires(std::is_constructible_v<T, Args&...>)
+    explicit left_right(Args&&... args) : m_instances{T(args...), T(args...)} {}
+
+    left_right(left_right const&) = delete;
+    left_right(left_right&& other) = delete;
+    left_right& operator=(left_right const&) = delete;
+    left_right& operator=(left_right &&) = delete;
+
+   public:
+    // f receives a const T&, the reference must not escape f
+    template<typename F>
+    requires(std::is_invocable_v<F, const T&>)
+    decltype(auto) read(F&& f) const {
+        const std::size_t version = m_version.load(std::memory_order_seq_cst);
+        m_indicators[version].arrive();
+
+        struct departure {
+            read_indicator& indicator;
+            ~departure() { indicator.depart(); }
+        } guard{m_indicators[version]};
+
+        return std::invoke(std::forward<F>(f), std::as_const(m_instances[m_front.load(std::memory_order_seq_cst)]));
+    }
+
+    // f receives a T& and is invoked once on each copy, returns the result of the second call;
+    // f must not throw, a failure halfway would leave the copies diverged with no way back
+    template<typename F>
+    requires(std::is_nothrow_invocable_v<F&, T&>)
+    decltype(auto) write(F&& f) {
+        std::lock_guard lock(m_writer);
+        const std::size_t front = m_front.load(std::memory_order_relaxed);
+
+        std::invoke(f, m_instances[front ^ 1]);
+        m_front.store(front ^ 1, std::memory_order_seq_cst);
+        toggle_version_and_wait();
+        return std::invoke(f, m_instances[front]);
+    }
+
+   private:
+    // the two-indicator version toggle keeps writers from starving behind a stream of readers
+    void toggle_version_and_wait() {
+        const std::size_t previous = m_version.load(std::memory_order_relaxed);
+        const std::size_t next = previous ^ 1;
+
+        wait_empty(m_indicators[next]);
+        m_version.store(next, std::memory_order_seq_cst);
+        wait_empty(m_indicators[previous]);
+    }
+
+    static void wait_empty(const read_indicator& indicator) {
+        spin_wait wait;
+        while(!indicator.empty()) {
+            wait();
+        }
+    }
+
+   private:
+    T m_instances[2];
+    alignas(std::hardware_destructive_interference_size)
+    std::atomic<std::size_t> m_front = 0;
+    std::atomic<std::size_t> m_version = 0;
+    mutable read_indicator m_indicators[2];
+    std::mutex m_writer;
+};
+
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "parking_lot.hpp"
+#include <atomic>
+#include <cstdint>
+
+namespace conc {
+
+// One-byte event that is set once and then stays set, waiters park on its address and
+// set() only enters the parking lot when someone actually waits.
+class one_shot_event {
+   private:
+    static constexpr std::uint8_t UNSET = 0;
+    static constexpr std::uint8_t SET = 1;
+    static constexpr std::uint8_t WAITING = 2;
+
+   public:
+    one_shot_event() noexcept = default;
+    one_shot_event(one_shot_event const&) = delete;
+    one_shot_event(one_shot_event&& other) = delete;
+    one_shot_event& operator=(one_shot_event const&) = delete;
+    one_shot_event& operator=(one_shot_event &&) = delete;
+
+   public:
+    void set() {
+        if(m_state.exchange(SET, std::memory_order_release) == WAITING) {
+            parking_lot::unpark_all(&m_state);
+        }
+    }
+
+    [[nodiscard]]
+    bool is_set() const noexcept {
+        return m_state.load(std::memory_order_acquire) == SET;
+    }
+
+    void wait() {
+        std::uint8_t state = m_state.load(std::memory_order_acquire);
+        while(state != SET) {
+            if(state == UNSET &&
+               !m_state.compare_exchange_weak(state, WAITING, std::memory_order_acquire, std::memory_order_acquire)) {
+                continue;
+            }
+            parking_lot::park(&m_state, [this]() noexcept {
+                return m_state.load(std::memory_order_relaxed) == WAITING;
+            });
+            state = m_state.load(std::memory_order_acquire);
+        }
+    }
+
+   private:
+    std::atomic<std::uint8_t> m_state = UNSET;
+};
+
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "futex.hpp"
+#include "hybrid_lock.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace conc {
+
+struct unpark_result {
+    // a thread was taken off the queue
+    bool unparked = false;
+    // threads parked on the same address remain
+    bool have_more = false;
+};
+
+// Parking lot (WebKit WTF::ParkingLot, Rust parking_lot): a global hash table of FIFO wait
+// queues keyed by address, so a synchronization object only needs the bits of its own state and
+// no kernel object of its own. Validation and unpark callbacks run under the bucket lock, which
+// makes "check state, then sleep" and "dequeue, then update state" atomic with respect to each
+// other. Each thread sleeps on a futex word of its own.
+class parking_lot {
+   private:
+    static constexpr std::size_t BUCKETS = 1024;
+
+    struct thread_data {
+        const void* address = nullptr;
+        thread_data* next = nullptr;
+        std::atomic<std::uint32_t> parked = 0;
+    };
+
+    struct alignas(std::hardware_destructive_interference_size) bucket {
+        hybrid_lock lock;
+        thread_data* head = nullptr;
+        thread_data* tail = nullptr;
+    };
+
+   public:
+    parking_lot() = delete;
+
+    // parks the calling thread on `address` if validate() returns true, both under the bucket lock;
+    // before_sleep runs after the thread is queued and the bucket unlocked. Returns false when
+    // validation failed, true once the thread was unparked.
+    template<typename Validate, typename BeforeSleep>
+    static bool park(const void* address, Validate&& validate, BeforeSleep&& before_sleep) {
+        thread_data& me = self();
+        bucket& b = bucket_for(address);
+        {
+            std::lock_guard guard(b.lock);
+            if(!validate()) {
+                return false;
+            }
+            me.address = address;
+            me.next = nullptr;
+            me.parked.store(1, std::memory_order_relaxed);
+            (b.tail != nullptr ? b.tail->next : b.head) = &me;
+            b.tail = &me;
+        }
+
+        before_sleep();
+        while(me.parked.load(std::memory_order_acquire) != 0) {
+            futex_wait(me.parked, 1);
+        }
+        return true;
+    }
+
+    template<typename Validate>
+    static bool park(const void* address, Validate&& validate) {
+        return park(address, std::forward<Validate>(validate), []() noexcept {});
+    }
+
+    // unparks the oldest thread parked on `address`; callback receives the outcome and runs under
+    // the bucket lock before the thread is woken
+    template<typename Callback>
+    static unpark_result unpark_one(const void* address, Callback&& callback) {
+        bucket& b = bucket_for(address);
+        unpark_result result;
+        thread_data* woken = nullptr;
+        {
+            std::lock_guard guard(b.lock);
+            thread_data* previous = nullptr;
+            thread_data** link = &b.head;
+            while(*link != nullptr && (*link)->address != address) {
+                previous = *link;
+                link = &previous->next;
+            }
+
+            if(*link != nullptr) {
+                woken = *link;
+                *link = woken->next;
+                if(b.tail == woken) {
+                    b.tail = previous;
+                }
+                result.unparked = true;
+                for(thread_data* t = woken->next; t != nullptr; t = t->next) {
+                    if(t->address == address) {
+                        result.have_more = true;
+                        break;
+                    }
+                }
+            }
+            callback(result);
+        }
+
+        if(woken != nullptr) {
+            wake(*woken);
+        }
+        return result;
+    }
+
+    static unpark_result unpark_one(const void* address) {
+        return unpark_one(address, [](unpark_result) noexcept {});
+    }
+
+    // unparks every thread parked on `address`, returns how many
+    static std::size_t unpark_all(const void* address) {
+        bucket& b = bucket_for(address);
+        thread_data* woken = nullptr;
+        std::size_t count = 0;
+        {
+            std::lock_guard guard(b.lock);
+            thread_data* previous = nullptr;
+            thread_data* t = b.head;
+            while(t != nullptr) {
+                thread_data* next = t->next;
+                if(t->address == address) {
+                    (previous != nullptr ? previous->next : b.head) = next;
+                    if(b.tail == t) {
+                        b.tail = previous;
+                    }
+                    // reuse the link for the local wake list
+                    t->next = woken;
+                    woken = t;
+                    ++count;
+                } else {
+                    previous = t;
+                }
+                t = next;
+            }
+        }
+
+        while(woken != nullptr) {
+            thread_data* next = woken->next;
+            wake(*woken);
+            woken = next;
+        }
+        return count;
+    }
+
+   private:
+    static bucket& bucket_for(const void* address) noexcept {
+        const auto h = reinterpret_cast<std::uintptr_t>(address) * 0x9E3779B97F4A7C15ull;
+        static std::array<bucket, BUCKETS> s_buckets;
+        return s_buckets[static_cast<std::size_t>(h >> 54) % BUCKETS];
+    }
+
+    // the woken thread may return and exit as soon as the store lands; the futex wake then hits
+    // a dead address, which only costs a spurious wakeup of whoever sleeps there, if anyone
+    static void wake(thread_data& t) noexcept {
+        t.parked.store(0, std::memory_order_release);
+        futex_wake(t.parked, 1);
+    }
+
+    static thread_data& self() noexcept {
+        thread_local thread_data tl_self;
+        return tl_self;
+    }
+};
+
+}
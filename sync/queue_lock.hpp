@@ -0,0 +1,222 @@
+#pragma once
+
+#include "spin.hpp"
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+namespace conc {
+
+namespace detail {
+
+// per-thread free list of queue nodes, a thread holding several queue locks uses one node each;
+// nodes that other threads may still read optimistically are not freed at thread exit
+template<typename node, bool free_on_exit = true>
+class node_pool {
+   public:
+    ~node_pool() {
+        if constexpr(free_on_exit) {
+            for(node* n : m_free) {
+                delete n;
+            }
+        }
+    }
+
+    static node* take() {
+        auto& free = tl_pool.m_free;
+        if(free.empty()) {
+            return new node{};
+        }
+        node* n = free.back();
+        free.pop_back();
+        return n;
+    }
+
+    static void give(node* n) {
+        tl_pool.m_free.push_back(n);
+    }
+
+   private:
+    inline static thread_local node_pool tl_pool;
+    std::vector<node*> m_free;
+};
+
+}
+
+// MCS lock (Mellor-Crummey, Scott): waiters form a queue and each spins on its own node,
+// so a release touches exactly one waiter's line and the lock is FIFO-fair. The holder's
+// node is kept in the lock, which keeps the Lockable interface.
+class mcs_lock {
+   private:
+    struct alignas(std::hardware_destructive_interference_size) node {
+        std::atomic<node*> next = nullptr;
+        std::atomic<bool> locked = false;
+    };
+
+    using pool = detail::node_pool<node>;
+
+   public:
+    mcs_lock() noexcept = default;
+    mcs_lock(mcs_lock const&) = delete;
+    mcs_lock(mcs_lock&& other) = delete;
+    mcs_lock& operator=(mcs_lock const&) = delete;
+    mcs_lock& operator=(mcs_lock &&) = delete;
+
+   public:
+    void lock() {
+        node* n = pool::take();
+        n->next.store(nullptr, std::memory_order_relaxed);
+        n->locked.store(true, std::memory_order_relaxed);
+
+        if(node* pred = m_tail.exchange(n, std::memory_order_acq_rel)) {
+            pred->next.store(n, std::memory_order_release);
+            spin_wait wait;
+            while(n->locked.load(std::memory_order_acquire)) {
+                wait();
+            }
+        }
+        m_holder = n;
+    }
+
+    [[nodiscard]]
+    bool try_lock() {
+        node* n = pool::take();
+        n->next.store(nullptr, std::memory_order_relaxed);
+        node* expected = nullptr;
+        if(!m_tail.compare_exchange_strong(expected, n, std::memory_order_acquire, std::memory_order_relaxed)) {
+            pool::give(n);
+            return false;
+        }
+        m_holder = n;
+        return true;
+    }
+
+    void unlock() {
+        node* n = m_holder;
+        node* succ = n->next.load(std::memory_order_acquire);
+        if(succ == nullptr) {
+            node* expected = n;
+            if(m_tail.compare_exchange_strong(expected, nullptr, std::memory_order_release, std::memory_order_relaxed)) {
+                pool::give(n);
+                return;
+            }
+            // a successor swapped the tail but has not linked itself yet
+            spin_wait wait;
+            while((succ = n->next.load(std::memory_order_acquire)) == nullptr) {
+                wait();
+            }
+        }
+        succ->locked.store(false, std::memory_order_release);
+        pool::give(n);
+    }
+
+   private:
+    std::atomic<node*> m_tail = nullptr;
+    // only accessed by the holder
+    node* m_holder = nullptr;
+};
+
+// CLH lock (Craig, Landin, Hagersten): an implicit queue where each waiter spins on its
+// predecessor's node. On release the holder hands its node to the successor and adopts the
+// predecessor's node, so nodes migrate between threads and return to the releasing thread's pool.
+// The tail carries a version next to the node pointer, every swap installs a fresh one, so that
+// try_lock cannot mistake a recycled node that became the tail again for the one it checked.
+class clh_lock {
+   private:
+    struct alignas(std::hardware_destructive_interference_size) node {
+        std::atomic<bool> locked = false;
+    };
+
+    // try_lock reads the tail node without owning it, such a node may sit in any thread's pool
+    using pool = detail::node_pool<node, false>;
+
+    // tail word: the version goes to the bits user space pointers leave clear, the top 16
+    // above 48-bit addresses and the low ones below the node alignment
+    static constexpr std::uint64_t LOW_BITS = std::countr_zero(alignof(node));
+    static constexpr std::uint64_t LOW_MASK = (std::uint64_t(1) << LOW_BITS) - 1;
+    static constexpr std::uint64_t POINTER_MASK = ((std::uint64_t(1) << 48) - 1) & ~LOW_MASK;
+
+    static std::uint64_t pack(node* n, std::uint64_t version) noexcept {
+        assert((reinterpret_cast<std::uintptr_t>(n) & ~POINTER_MASK) == 0);
+        return reinterpret_cast<std::uintptr_t>(n) | (version & LOW_MASK) | ((version >> LOW_BITS) << 48);
+    }
+
+    static node* node_of(std::uint64_t tail) noexcept {
+        return reinterpret_cast<node*>(static_cast<std::uintptr_t>(tail & POINTER_MASK));
+    }
+
+   public:
+    clh_lock() : m_tail(pack(new node{}, 0)) {}
+    clh_lock(clh_lock const&) = delete;
+    clh_lock(clh_lock&& other) = delete;
+    clh_lock& operator=(clh_lock const&) = delete;
+    clh_lock& operator=(clh_lock &&) = delete;
+
+    //not thread-safe
+    ~clh_lock() {
+        delete node_of(m_tail.load(std::memory_order_relaxed));
+    }
+
+   public:
+    void lock() {
+        node* n = pool::take();
+        n->locked.store(true, std::memory_order_relaxed);
+        node* pred = node_of(m_tail.exchange(pack(n, next_version()), std::memory_order_acq_rel));
+        wait_for(pred);
+        m_holder = n;
+        m_pred = pred;
+    }
+
+    [[nodiscard]]
+    bool try_lock() {
+        std::uint64_t tail = m_tail.load(std::memory_order_acquire);
+        node* pred = node_of(tail);
+        if(pred->locked.load(std::memory_order_acquire)) {
+            return false;
+        }
+        node* n = pool::take();
+        n->locked.store(true, std::memory_order_relaxed);
+        // fails when anybody swapped the tail since the load, even back to the same node
+        if(!m_tail.compare_exchange_strong(tail, pack(n, next_version()), std::memory_order_acq_rel, std::memory_order_relaxed)) {
+            pool::give(n);
+            return false;
+        }
+        // we are queued behind pred whatever happened; it was released unless the version
+        // wrapped around while we stalled, then its owner's critical section is waited out
+        wait_for(pred);
+        m_holder = n;
+        m_pred = pred;
+        return true;
+    }
+
+    void unlock() {
+        node* n = m_holder;
+        node* pred = m_pred;
+        n->locked.store(false, std::memory_order_release);
+        pool::give(pred);
+    }
+
+   private:
+    std::uint64_t next_version() noexcept {
+        return m_version.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    static void wait_for(node* pred) noexcept {
+        spin_wait wait;
+        while(pred->locked.load(std::memory_order_acquire)) {
+            wait();
+        }
+    }
+
+   private:
+    std::atomic<std::uint64_t> m_tail;
+    std::atomic<std::uint64_t> m_version = 0;
+    // only accessed by the holder
+    node* m_holder = nullptr;
+    node* m_pred = nullptr;
+};
+
+}
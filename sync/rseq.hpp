@@ -0,0 +1,433 @@
+#pragma once
+
+#include "spin_lock.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <new>
+#include <thread>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+// builds may define CONC_HAS_RSEQ to 0 to keep the fallback; ThreadSanitizer does, as it sees
+// neither the stores of the critical sections nor the ordering a cpu gives them
+#if !defined(CONC_HAS_RSEQ)
+#if defined(__linux__) && defined(__x86_64__) && __has_include(<linux/rseq.h>) && !defined(__SANITIZE_THREAD__)
+#define CONC_HAS_RSEQ 1
+#else
+#define CONC_HAS_RSEQ 0
+#endif
+#endif
+
+#if CONC_HAS_RSEQ
+#include <sys/syscall.h>
+#if __has_include(<sys/rseq.h>)
+#include <sys/rseq.h>
+#define CONC_HAS_GLIBC_RSEQ 1
+#else
+#include <linux/rseq.h>
+#define CONC_HAS_GLIBC_RSEQ 0
+#endif
+#endif
+
+namespace conc {
+
+#if CONC_HAS_RSEQ
+namespace detail {
+
+// the signature in front of every abort handler, the one glibc registers its area with
+inline constexpr std::uint32_t RSEQ_SIGNATURE = 0x53053053;
+
+// registration of our own area, for a libc that did not register one
+struct rseq_registration {
+    rseq_registration() noexcept {
+        area.cpu_id = static_cast<std::uint32_t>(RSEQ_CPU_ID_UNINITIALIZED);
+        registered = ::syscall(SYS_rseq, &area, sizeof(area), 0, RSEQ_SIGNATURE) == 0;
+    }
+
+    ~rseq_registration() {
+        if(registered) {
+            ::syscall(SYS_rseq, &area, sizeof(area), RSEQ_FLAG_UNREGISTER, RSEQ_SIGNATURE);
+        }
+    }
+
+    struct rseq area{};
+    bool registered = false;
+};
+
+// the area the kernel keeps this thread's cpu in, its cpu_id is negative when unregistered
+inline struct rseq* rseq_area() noexcept {
+#if CONC_HAS_GLIBC_RSEQ
+    if(__rseq_size > 0) [[likely]] {
+        return reinterpret_cast<struct rseq*>(static_cast<char*>(__builtin_thread_pointer()) + __rseq_offset);
+    }
+#endif
+    thread_local rseq_registration tl_registration;
+    return &tl_registration.area;
+}
+
+inline std::int32_t rseq_cpu_id(struct rseq* rs) noexcept {
+    return static_cast<std::int32_t>(std::atomic_ref<std::uint32_t>(rs->cpu_id).load(std::memory_order_relaxed));
+}
+
+inline std::uint32_t rseq_cpu_start(struct rseq* rs) noexcept {
+    return std::atomic_ref<std::uint32_t>(rs->cpu_id_start).load(std::memory_order_relaxed);
+}
+
+// An x86-64 critical section in the layout of librseq: the descriptor (start, length of the
+// section up to the committing store, abort handler) goes to __rseq_cs, the section stores its
+// address in the thread's area, checks it still runs on the cpu it computed its data from and
+// ends with one store. Preemption, migration or a signal inside it make the kernel resume at
+// the abort handler, which sits behind the signature in __rseq_failure and jumps to `aborted`.
+#define CONC_RSEQ_BEGIN                                                        \
+    ".pushsection __rseq_cs, \"aw\"\n\t"                                      \
+    ".balign 32\n\t"                                                           \
+    "3:\n\t"                                                                   \
+    ".long 0x0, 0x0\n\t"                                                       \
+    ".quad 1f, (2f - 1f), 4f\n\t"                                              \
+    ".popsection\n\t"                                                          \
+    ".pushsection __rseq_cs_ptr_array, \"aw\"\n\t"                            \
+    ".quad 3b\n\t"                                                             \
+    ".popsection\n\t"                                                          \
+    "leaq 3b(%%rip), %%rax\n\t"                                                \
+    "movq %%rax, %[rseq_cs]\n\t"                                               \
+    "1:\n\t"                                                                   \
+    "cmpl %[cpu], %[current_cpu]\n\t"                                          \
+    "jnz 4f\n\t"
+
+#define CONC_RSEQ_END                                                          \
+    "2:\n\t"                                                                   \
+    ".pushsection __rseq_failure, \"ax\"\n\t"                                 \
+    ".byte 0x0f, 0xb9, 0x3d\n\t"                                               \
+    ".long 0x53053053\n\t"                                                     \
+    "4:\n\t"                                                                   \
+    "jmp %l[aborted]\n\t"                                                      \
+    ".popsection\n\t"
+
+// *cell += n on cpu, false when aborted
+inline bool rseq_add(std::int64_t* cell, std::int64_t n, std::uint32_t cpu, struct rseq* rs) noexcept {
+    asm volatile goto(
+        CONC_RSEQ_BEGIN
+        "addq %[n], %[cell]\n\t"
+        CONC_RSEQ_END
+        :
+        : [cpu] "r"(cpu), [current_cpu] "m"(rs->cpu_id), [rseq_cs] "m"(rs->rseq_cs),
+          [cell] "m"(*cell), [n] "er"(n)
+        : "memory", "cc", "rax"
+        : aborted);
+    return true;
+aborted:
+    return false;
+}
+
+// *slot = desired on cpu if it still holds expected, false when it did not or aborted
+inline bool rseq_compare_store(void** slot, void* expected, void* desired, std::uint32_t cpu, struct rseq* rs) noexcept {
+    asm volatile goto(
+        CONC_RSEQ_BEGIN
+        "cmpq %[slot], %[expected]\n\t"
+        "jnz %l[aborted]\n\t"
+        "movq %[desired], %[slot]\n\t"
+        CONC_RSEQ_END
+        :
+        : [cpu] "r"(cpu), [current_cpu] "m"(rs->cpu_id), [rseq_cs] "m"(rs->rseq_cs),
+          [slot] "m"(*slot), [expected] "r"(expected), [desired] "r"(desired)
+        : "memory", "cc", "rax"
+        : aborted);
+    return true;
+aborted:
+    return false;
+}
+
+enum class rseq_pop_result { popped, empty, aborted };
+
+// pops the head of the list in *slot on cpu into *out, the link sits at offset 0 of a node
+inline rseq_pop_result rseq_pop(void** slot, void** out, std::uint32_t cpu, struct rseq* rs) noexcept {
+    asm volatile goto(
+        CONC_RSEQ_BEGIN
+        "movq %[slot], %%rbx\n\t"
+        "testq %%rbx, %%rbx\n\t"
+        "jz %l[empty]\n\t"
+        "movq %%rbx, %[out]\n\t"
+        "movq (%%rbx), %%rbx\n\t"
+        "movq %%rbx, %[slot]\n\t"
+        CONC_RSEQ_END
+        :
+        : [cpu] "r"(cpu), [current_cpu] "m"(rs->cpu_id), [rseq_cs] "m"(rs->rseq_cs),
+          [slot] "m"(*slot), [out] "m"(*out)
+        : "memory", "cc", "rax", "rbx"
+        : aborted, empty);
+    return rseq_pop_result::popped;
+aborted:
+    return rseq_pop_result::aborted;
+empty:
+    return rseq_pop_result::empty;
+}
+
+#undef CONC_RSEQ_BEGIN
+#undef CONC_RSEQ_END
+
+// a thread of a process that settled on rseq and could not register: nothing correct is left
+[[noreturn]]
+inline void rseq_unregistered() noexcept {
+    std::terminate();
+}
+
+}
+#endif
+
+// true when per-cpu structures run restartable sequences: decided once per process from the
+// first thread that asks, every later thread is expected to register the same way
+[[nodiscard]]
+inline bool rseq_available() noexcept {
+#if CONC_HAS_RSEQ
+    static const bool available = detail::rseq_cpu_id(detail::rseq_area()) >= 0;
+    return available;
+#else
+    return false;
+#endif
+}
+
+// cpu the calling thread ran on a moment ago
+[[nodiscard]]
+inline std::uint32_t current_cpu() noexcept {
+#if CONC_HAS_RSEQ
+    if(rseq_available()) [[likely]] {
+        return detail::rseq_cpu_start(detail::rseq_area());
+    }
+#endif
+#if defined(__linux__)
+    const int cpu = ::sched_getcpu();
+    return cpu < 0 ? 0 : static_cast<std::uint32_t>(cpu);
+#else
+    return 0;
+#endif
+}
+
+#if defined(__linux__)
+namespace detail {
+
+// one more than the highest id in /sys/devices/system/cpu/possible, a list like "0-3,8-11";
+// 0 when it cannot be read
+inline std::size_t possible_cpu_ids() noexcept {
+    std::FILE* f = std::fopen("/sys/devices/system/cpu/possible", "r");
+    if(f == nullptr) {
+        return 0;
+    }
+    std::size_t ids = 0;
+    unsigned first = 0;
+    unsigned last = 0;
+    int matched = 0;
+    while((matched = std::fscanf(f, "%u-%u", &first, &last)) >= 1) {
+        ids = std::max<std::size_t>(ids, (matched == 2 ? last : first) + std::size_t(1));
+        if(std::fgetc(f) != ',') {
+            break;
+        }
+    }
+    std::fclose(f);
+    return ids;
+}
+
+}
+#endif
+
+// cpu ids current_cpu() and the rseq area report stay below this: one more than the highest
+// possible cpu id, which exceeds the number of cpus when the possible mask has holes
+[[nodiscard]]
+inline std::size_t cpu_slots() noexcept {
+#if defined(__linux__)
+    static const std::size_t slots = []() noexcept {
+        const std::size_t ids = detail::possible_cpu_ids();
+        // sysfs not mounted: every id a cpu set can hold
+        return ids != 0 ? ids : std::size_t(CPU_SETSIZE);
+    }();
+#else
+    static const std::size_t slots = std::max(1u, std::thread::hardware_concurrency());
+#endif
+    return slots;
+}
+
+// Counter with one cache-line padded cell per cpu. With rseq an update is a plain add on the
+// cell of the cpu the thread runs on, committed by a restartable sequence, so it costs no
+// atomic read-modify-write at all; without it the cell is picked by sched_getcpu and updated
+// with a relaxed fetch_add. Reads sum all cells, exact once updates quiesce.
+class percpu_counter {
+   public:
+    percpu_counter() : m_cells(std::make_unique<cell[]>(cpu_slots())) {}
+
+    percpu_counter(percpu_counter const&) = delete;
+    percpu_counter(percpu_counter&& other) = delete;
+    percpu_counter& operator=(percpu_counter const&) = delete;
+    percpu_counter& operator=(percpu_counter &&) = delete;
+
+   public:
+    void add(std::int64_t n) noexcept {
+#if CONC_HAS_RSEQ
+        if(rseq_available()) [[likely]] {
+            struct rseq* rs = detail::rseq_area();
+            while(true) {
+                if(detail::rseq_cpu_id(rs) < 0) [[unlikely]] {
+                    detail::rseq_unregistered();
+                }
+                const std::uint32_t cpu = detail::rseq_cpu_start(rs);
+                assert(cpu < cpu_slots());
+                if(detail::rseq_add(&m_cells[cpu].value, n, cpu, rs)) [[likely]] {
+                    return;
+                }
+            }
+        }
+#endif
+        const std::uint32_t cpu = current_cpu();
+        assert(cpu < cpu_slots());
+        std::atomic_ref<std::int64_t>(m_cells[cpu].value).fetch_add(n, std::memory_order_relaxed);
+    }
+
+    void increment() noexcept {
+        add(1);
+    }
+
+    void decrement() noexcept {
+        add(-1);
+    }
+
+    [[nodiscard]]
+    std::int64_t load() const noexcept {
+        std::int64_t sum = 0;
+        for(std::size_t i = 0; i < cpu_slots(); ++i) {
+            sum += std::atomic_ref<std::int64_t>(m_cells[i].value).load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+   private:
+    struct alignas(std::hardware_destructive_interference_size) cell {
+        std::int64_t value = 0;
+    };
+
+    const std::unique_ptr<cell[]> m_cells;
+};
+
+struct percpu_node {
+    percpu_node* next = nullptr;
+};
+
+// Intrusive free list with one stack per cpu, for object pools: push and pop work on the list
+// of the cpu the thread runs on, with rseq through restartable sequences that neither lock nor
+// use atomic read-modify-writes, and since only that cpu touches its list between preemptions
+// popping has no ABA problem. Without rseq every list is guarded by a spin lock. A node freed
+// on one cpu is reused there; pop returns null when this cpu's list is empty, even if others
+// are not. Nodes must outlive the list or be popped before they are destroyed.
+template<typename Node>
+requires(std::derived_from<Node, percpu_node>)
+class percpu_free_list {
+   public:
+    percpu_free_list() : m_slots(std::make_unique<slot[]>(cpu_slots())) {}
+
+    percpu_free_list(percpu_free_list const&) = delete;
+    percpu_free_list(percpu_free_list&& other) = delete;
+    percpu_free_list& operator=(percpu_free_list const&) = delete;
+    percpu_free_list& operator=(percpu_free_list &&) = delete;
+
+   public:
+    void push(Node* node) noexcept {
+        percpu_node* n = node;
+#if CONC_HAS_RSEQ
+        if(rseq_available()) [[likely]] {
+            struct rseq* rs = detail::rseq_area();
+            while(true) {
+                if(detail::rseq_cpu_id(rs) < 0) [[unlikely]] {
+                    detail::rseq_unregistered();
+                }
+                const std::uint32_t cpu = detail::rseq_cpu_start(rs);
+                void** head = head_of(cpu);
+                n->next = static_cast<percpu_node*>(std::atomic_ref<void*>(*head).load(std::memory_order_relaxed));
+                if(detail::rseq_compare_store(head, n->next, n, cpu, rs)) [[likely]] {
+                    return;
+                }
+            }
+        }
+#endif
+        const std::uint32_t cpu = current_cpu();
+        assert(cpu < cpu_slots());
+        slot& s = m_slots[cpu];
+        s.lock.lock();
+        n->next = static_cast<percpu_node*>(s.head);
+        s.head = n;
+        s.lock.unlock();
+    }
+
+    [[nodiscard]]
+    Node* pop() noexcept {
+#if CONC_HAS_RSEQ
+        if(rseq_available()) [[likely]] {
+            struct rseq* rs = detail::rseq_area();
+            while(true) {
+                if(detail::rseq_cpu_id(rs) < 0) [[unlikely]] {
+                    detail::rseq_unregistered();
+                }
+                const std::uint32_t cpu = detail::rseq_cpu_start(rs);
+                void* popped = nullptr;
+                switch(detail::rseq_pop(head_of(cpu), &popped, cpu, rs)) {
+                    case detail::rseq_pop_result::popped:
+                        return static_cast<Node*>(static_cast<percpu_node*>(popped));
+                    case detail::rseq_pop_result::empty:
+                        return nullptr;
+                    case detail::rseq_pop_result::aborted:
+                        break;
+                }
+            }
+        }
+#endif
+        const std::uint32_t cpu = current_cpu();
+        assert(cpu < cpu_slots());
+        slot& s = m_slots[cpu];
+        s.lock.lock();
+        auto* n = static_cast<percpu_node*>(s.head);
+        if(n != nullptr) {
+            s.head = n->next;
+        }
+        s.lock.unlock();
+        return static_cast<Node*>(n);
+    }
+
+    //not thread-safe
+    // hands every node of every cpu to f(Node*) and empties the lists
+    template<typename F>
+    void drain(F&& f) {
+        for(std::size_t i = 0; i < cpu_slots(); ++i) {
+            auto* n = static_cast<percpu_node*>(m_slots[i].head);
+            m_slots[i].head = nullptr;
+            while(n != nullptr) {
+                percpu_node* next = n->next;
+                f(static_cast<Node*>(n));
+                n = next;
+            }
+        }
+    }
+
+   private:
+    // the link of a node sits at its start, which is what the pop sequence dereferences
+    static_assert(offsetof(percpu_node, next) == 0);
+
+    void** head_of(std::uint32_t cpu) noexcept {
+        assert(cpu < cpu_slots());
+        return &m_slots[cpu].head;
+    }
+
+    struct alignas(std::hardware_destructive_interference_size) slot {
+        void* head = nullptr;
+        ttas_lock lock;
+    };
+
+    const std::unique_ptr<slot[]> m_slots;
+};
+
+}
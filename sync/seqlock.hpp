@@ -0,0 +1,175 @@
+#pragma once
+
+#include "spin.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace conc {
+
+enum class writer_policy {
+    // the caller guarantees that writes never overlap
+    single,
+    // writers claim the lock with a CAS on the sequence
+    multiple,
+};
+
+// Sequence lock: the counter is odd while a write is in progress, readers copy the data
+// optimistically and retry when the counter moved. Readers never write shared memory.
+// Fences follow Boehm, "Can Seqlocks Get Along With Programming Language Memory Models?":
+// protected data must be accessed through relaxed atomics, the reader issues an acquire
+// fence before re-reading the counter and the writer a release fence after making it odd.
+template<writer_policy policy = writer_policy::single>
+class sequence_lock {
+   public:
+    sequence_lock() noexcept = default;
+    sequence_lock(sequence_lock const&) = delete;
+    sequence_lock(sequence_lock&& other) = delete;
+    sequence_lock& operator=(sequence_lock const&) = delete;
+    sequence_lock& operator=(sequence_lock &&) = delete;
+
+   public:
+    [[nodiscard]]
+    std::uint64_t read_begin() const noexcept {
+        std::uint64_t seq = m_seq.load(std::memory_order_acquire);
+        spin_wait wait;
+        while(seq & 1) [[unlikely]] {
+            wait();
+            seq = m_seq.load(std::memory_order_acquire);
+        }
+        return seq;
+    }
+
+    // true when the data read since read_begin may be torn and has to be read again
+    [[nodiscard]]
+    bool read_retry(std::uint64_t seq) const noexcept {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return m_seq.load(std::memory_order_relaxed) != seq;
+    }
+
+    void write_lock() noexcept {
+        if constexpr(policy == writer_policy::single) {
+            m_seq.store(m_seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        } else {
+            std::uint64_t seq = m_seq.load(std::memory_order_relaxed);
+            spin_wait wait;
+            while(true) {
+                if(seq & 1) {
+                    wait();
+                    seq = m_seq.load(std::memory_order_relaxed);
+                    continue;
+                }
+                // acquire: the previous writer's data stores happen before ours
+                if(m_seq.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void write_unlock() noexcept {
+        m_seq.store(m_seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    [[nodiscard]]
+    std::uint64_t sequence() const noexcept {
+        return m_seq.load(std::memory_order_acquire);
+    }
+
+   private:
+    std::atomic<std::uint64_t> m_seq = 0;
+};
+
+// Value guarded by a sequence lock, for small trivially copyable structs that are read far more
+// often than written. The value is kept as relaxed atomic words so that the racy copy a reader
+// may discard is still well-defined; keep T to a few cache lines, readers retry on every write.
+template<typename T, writer_policy policy = writer_policy::single>
+requires(std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>)
+class seqlock {
+   private:
+    using word = std::uint64_t;
+    static constexpr std::size_t WORDS = (sizeof(T) + sizeof(word) - 1) / sizeof(word);
+    using buffer = std::array<word, WORDS>;
+
+   public:
+    seqlock() noexcept : seqlock(T{}) {}
+
+    explicit seqlock(const T& value) noexcept {
+        write_words(to_words(value));
+    }
+
+    seqlock(seqlock const&) = delete;
+    seqlock(seqlock&& other) = delete;
+    seqlock& operator=(seqlock const&) = delete;
+    seqlock& operator=(seqlock &&) = delete;
+
+   public:
+    [[nodiscard]]
+    T load() const noexcept {
+        buffer words;
+        std::uint64_t seq;
+        do {
+            seq = m_lock.read_begin();
+            for(std::size_t i = 0; i < WORDS; ++i) {
+                words[i] = m_data[i].load(std::memory_order_relaxed);
+            }
+        } while(m_lock.read_retry(seq));
+
+        return from_words(words);
+    }
+
+    void store(const T& value) noexcept {
+        const buffer words = to_words(value);
+        m_lock.write_lock();
+        write_words(words);
+        m_lock.write_unlock();
+    }
+
+    // read-modify-write under the write lock, f receives a T& to modify
+    template<typename F>
+    requires(std::is_invocable_v<F, T&>)
+    void update(F&& f) {
+        m_lock.write_lock();
+        buffer words;
+        for(std::size_t i = 0; i < WORDS; ++i) {
+            words[i] = m_data[i].load(std::memory_order_relaxed);
+        }
+        T value = from_words(words);
+        try {
+            f(value);
+        } catch(...) {
+            m_lock.write_unlock();
+            throw;
+        }
+        write_words(to_words(value));
+        m_lock.write_unlock();
+    }
+
+   private:
+    static buffer to_words(const T& value) noexcept {
+        buffer words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+        return words;
+    }
+
+    static T from_words(const buffer& words) noexcept {
+        T value;
+        std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+        return value;
+    }
+
+    void write_words(const buffer& words) noexcept {
+        for(std::size_t i = 0; i < WORDS; ++i) {
+            m_data[i].store(words[i], std::memory_order_relaxed);
+        }
+    }
+
+   private:
+    sequence_lock<policy> m_lock;
+    std::array<std::atomic<word>, WORDS> m_data;
+};
+
+}
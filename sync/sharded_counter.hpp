@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <new>
+
+namespace conc {
+
+// stable per-thread index, threads are spread round-robin over `slots`
+inline std::size_t this_thread_slot(std::size_t slots) noexcept {
+    static std::atomic<std::size_t> s_next = 0;
+    thread_local std::size_t tl_index = s_next.fetch_add(1, std::memory_order_relaxed);
+    return tl_index % slots;
+}
+
+// Counter split over cache-line padded cells, each thread updates its own cell so that
+// concurrent updates do not bounce one line between cores. Reads sum all cells: exact once
+// updates quiesce, approximate while they are in flight.
+class sharded_counter {
+   public:
+    static constexpr std::size_t CELLS = 64;
+
+   public:
+    sharded_counter() noexcept = default;
+    sharded_counter(sharded_counter const&) = delete;
+    sharded_counter(sharded_counter&& other) = delete;
+    sharded_counter& operator=(sharded_counter const&) = delete;
+    sharded_counter& operator=(sharded_counter &&) = delete;
+
+   public:
+    void add(std::int64_t n, std::memory_order order = std::memory_order_relaxed) noexcept {
+        m_cells[this_thread_slot(CELLS)].value.fetch_add(n, order);
+    }
+
+    void increment(std::memory_order order = std::memory_order_relaxed) noexcept {
+        add(1, order);
+    }
+
+    void decrement(std::memory_order order = std::memory_order_relaxed) noexcept {
+        add(-1, order);
+    }
+
+    [[nodiscard]]
+    std::int64_t load(std::memory_order order = std::memory_order_relaxed) const noexcept {
+        std::int64_t sum = 0;
+        for(const auto& c : m_cells) {
+            sum += c.value.load(order);
+        }
+        return sum;
+    }
+
+    // true when every cell is zero, which for non-negative per-thread contributions
+    // means no thread is counted
+    [[nodiscard]]
+    bool is_zero(std::memory_order order = std::memory_order_seq_cst) const noexcept {
+        for(const auto& c : m_cells) {
+            if(c.value.load(order) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //not thread-safe
+    void reset() noexcept {
+        for(auto& c : m_cells) {
+            c.value.store(0, std::memory_order_relaxed);
+        }
+    }
+
+   private:
+    struct alignas(std::hardware_destructive_interference_size) cell {
+        std::atomic<std::int64_t> value = 0;
+    };
+
+    std::array<cell, CELLS> m_cells;
+};
+
+}
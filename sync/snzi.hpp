@@ -0,0 +1,164 @@
+#pragma once
+
+#include "sharded_counter.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <new>
+
+namespace conc {
+
+// Scalable non-zero indicator (Ellen, Lev, Luchangco, Moir, PODC 2007): a binary tree of
+// counters where a thread arrives and departs at its leaf and only 0 <-> 1 transitions travel
+// towards the root, so query() reads one rarely written word. Every depart must follow an
+// arrive of the same thread.
+template<std::size_t leaves = 16>
+requires(leaves > 0 && (leaves & (leaves - 1)) == 0)
+class snzi {
+   private:
+    // hierarchical node: count in halves (1 is the intermediate 1/2 state) and a version
+    static constexpr std::uint64_t HALF = 1;
+    static constexpr std::uint64_t ONE = 2;
+
+    // root: count, announce bit and version
+    static constexpr std::uint64_t ANNOUNCE = 1ull << 32;
+
+    static constexpr std::uint64_t count(std::uint64_t x) noexcept { return x & 0xFFFFFFFFull; }
+    static constexpr std::uint64_t version(std::uint64_t x) noexcept { return x >> 33; }
+    static constexpr std::uint64_t make(std::uint64_t c, std::uint64_t v) noexcept { return c | (v << 33); }
+
+    static constexpr std::size_t NODES = 2 * leaves - 1;
+
+   public:
+    snzi() noexcept = default;
+    snzi(snzi const&) = delete;
+    snzi(snzi&& other) = delete;
+    snzi& operator=(snzi const&) = delete;
+    snzi& operator=(snzi &&) = delete;
+
+   public:
+    void arrive() noexcept {
+        arrive(leaf());
+    }
+
+    void depart() noexcept {
+        depart(leaf());
+    }
+
+    [[nodiscard]]
+    bool query() const noexcept {
+        return m_indicator.load(std::memory_order_acquire) & 1;
+    }
+
+   private:
+    static std::size_t leaf() noexcept {
+        return leaves - 1 + this_thread_slot(leaves);
+    }
+
+    static std::size_t parent(std::size_t node) noexcept {
+        return (node - 1) / 2;
+    }
+
+    void arrive(std::size_t node) noexcept {
+        if(node == 0) {
+            arrive_root();
+            return;
+        }
+
+        auto& word = m_nodes[node].word;
+        std::size_t undo = 0;
+        bool done = false;
+        std::uint64_t x = word.load(std::memory_order_acquire);
+
+        while(!done) {
+            if(count(x) >= ONE) {
+                done = word.compare_exchange_weak(x, make(count(x) + ONE, version(x)), std::memory_order_acq_rel);
+                continue;
+            }
+
+            if(count(x) == 0) {
+                const std::uint64_t half = make(HALF, version(x) + 1);
+                if(word.compare_exchange_weak(x, half, std::memory_order_acq_rel)) {
+                    x = half;
+                } else {
+                    continue;
+                }
+            }
+
+            // 1/2: whoever completes the transition to 1 keeps the parent arrival, the others undo theirs
+            arrive(parent(node));
+            if(word.compare_exchange_strong(x, make(ONE, version(x)), std::memory_order_acq_rel)) {
+                done = true;
+            } else {
+                ++undo;
+            }
+        }
+
+        for(; undo > 0; --undo) {
+            depart(parent(node));
+        }
+    }
+
+    void depart(std::size_t node) noexcept {
+        if(node == 0) {
+            depart_root();
+            return;
+        }
+
+        auto& word = m_nodes[node].word;
+        std::uint64_t x = word.load(std::memory_order_acquire);
+        while(!word.compare_exchange_weak(x, make(count(x) - ONE, version(x)), std::memory_order_acq_rel)) {}
+        if(count(x) == ONE) {
+            depart(parent(node));
+        }
+    }
+
+    void arrive_root() noexcept {
+        auto& word = m_nodes[0].word;
+        std::uint64_t x = word.load(std::memory_order_acquire);
+        std::uint64_t next;
+        do {
+            next = count(x) == 0 ? make(1 | ANNOUNCE, version(x) + 1) : x + 1;
+        } while(!word.compare_exchange_weak(x, next, std::memory_order_acq_rel));
+
+        if(next & ANNOUNCE) {
+            set_indicator(true);
+            word.compare_exchange_strong(next, next & ~ANNOUNCE, std::memory_order_acq_rel);
+        }
+    }
+
+    void depart_root() noexcept {
+        auto& word = m_nodes[0].word;
+        std::uint64_t x = word.load(std::memory_order_acquire);
+        while(!word.compare_exchange_weak(x, make(count(x) - 1, version(x)), std::memory_order_acq_rel)) {}
+        if(count(x) > 1) {
+            return;
+        }
+
+        // LL/SC on the indicator emulated with a sequence number: clear it only while no newer
+        // arrival at the root happened
+        std::uint64_t i = m_indicator.load(std::memory_order_acquire);
+        while(version(word.load(std::memory_order_acquire)) == version(x)) {
+            if(m_indicator.compare_exchange_weak(i, (i + 2) & ~1ull, std::memory_order_acq_rel)) {
+                return;
+            }
+        }
+    }
+
+    void set_indicator(bool value) noexcept {
+        std::uint64_t i = m_indicator.load(std::memory_order_acquire);
+        while(!m_indicator.compare_exchange_weak(i, ((i + 2) & ~1ull) | value, std::memory_order_acq_rel)) {}
+    }
+
+   private:
+    struct alignas(std::hardware_destructive_interference_size) node {
+        std::atomic<std::uint64_t> word = 0;
+    };
+
+    // low bit is the indicator, the rest a sequence number bumped by every write
+    alignas(std::hardware_destructive_interference_size)
+    std::atomic<std::uint64_t> m_indicator = 0;
+    std::array<node, NODES> m_nodes;
+};
+
+}
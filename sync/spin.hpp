@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace conc {
+
+// hint for busy-wait loops: frees pipeline resources for the sibling hyper-thread
+// and avoids the memory-order mis-speculation penalty when the awaited line changes
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+// one step of a busy-wait loop: relaxes for the first rounds and then yields, so that
+// spinners do not burn the time slice of a preempted owner when threads outnumber cores
+class spin_wait {
+   public:
+    static constexpr std::uint32_t SPINS = 64;
+
+   public:
+    void operator()() noexcept {
+        if(m_rounds < SPINS) {
+            ++m_rounds;
+            cpu_relax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+   private:
+    std::uint32_t m_rounds = 0;
+};
+
+// exponential backoff for contended retry loops: each round spins twice as long as the
+// previous one up to `max_spins`, which keeps losers off the contended line; a saturated
+// backoff yields as well
+class backoff {
+   public:
+    explicit backoff(std::uint32_t min_spins = 4, std::uint32_t max_spins = 1024) noexcept :
+        m_spins(min_spins), m_max(max_spins) {}
+
+    void operator()() noexcept {
+        for(std::uint32_t i = 0; i < m_spins; ++i) {
+            cpu_relax();
+        }
+        if(m_spins < m_max) {
+            m_spins *= 2;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+   private:
+    std::uint32_t m_spins;
+    const std::uint32_t m_max;
+};
+
+}
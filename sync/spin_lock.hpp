@@ -0,0 +1,77 @@
+#pragma once
+
+#include "spin.hpp"
+#include <atomic>
+
+namespace conc {
+
+// Test-and-set lock: every attempt is an exchange, so waiters keep the line in exclusive
+// state. Only for very short critical sections with little contention.
+class tas_lock {
+   public:
+    tas_lock() noexcept = default;
+    tas_lock(tas_lock const&) = delete;
+    tas_lock(tas_lock&& other) = delete;
+    tas_lock& operator=(tas_lock const&) = delete;
+    tas_lock& operator=(tas_lock &&) = delete;
+
+   public:
+    void lock() noexcept {
+        backoff wait;
+        while(m_locked.exchange(true, std::memory_order_acquire)) {
+            wait();
+        }
+    }
+
+    [[nodiscard]]
+    bool try_lock() noexcept {
+        return !m_locked.exchange(true, std::memory_order_acquire);
+    }
+
+    void unlock() noexcept {
+        m_locked.store(false, std::memory_order_release);
+    }
+
+   private:
+    std::atomic<bool> m_locked = false;
+};
+
+// Test-and-test-and-set lock: waiters spin on a shared copy of the line and only attempt
+// the exchange once it reads unlocked, backing off exponentially after a lost race.
+class ttas_lock {
+   public:
+    ttas_lock() noexcept = default;
+    ttas_lock(ttas_lock const&) = delete;
+    ttas_lock(ttas_lock&& other) = delete;
+    ttas_lock& operator=(ttas_lock const&) = delete;
+    ttas_lock& operator=(ttas_lock &&) = delete;
+
+   public:
+    void lock() noexcept {
+        backoff wait;
+        while(true) {
+            spin_wait spin;
+            while(m_locked.load(std::memory_order_relaxed)) {
+                spin();
+            }
+            if(!m_locked.exchange(true, std::memory_order_acquire)) {
+                return;
+            }
+            wait();
+        }
+    }
+
+    [[nodiscard]]
+    bool try_lock() noexcept {
+        return !m_locked.load(std::memory_order_relaxed) && !m_locked.exchange(true, std::memory_order_acquire);
+    }
+
+    void unlock() noexcept {
+        m_locked.store(false, std::memory_order_release);
+    }
+
+   private:
+    std::atomic<bool> m_locked = false;
+};
+
+}
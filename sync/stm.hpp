@@ -0,0 +1,325 @@
+#pragma once
+
+#include "spin.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace conc {
+
+class tx;
+
+// Word of transactional memory: any trivially copyable value of up to eight bytes, read and
+// written inside atomic_do through the transaction handed to the body.
+template<typename T>
+requires(std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(std::uint64_t))
+class tvar {
+   public:
+    using value_type = T;
+
+    tvar() noexcept : tvar(T{}) {}
+    explicit tvar(T value) noexcept : m_word(encode(value)) {}
+
+    tvar(tvar const&) = delete;
+    tvar(tvar&& other) = delete;
+    tvar& operator=(tvar const&) = delete;
+    tvar& operator=(tvar &&) = delete;
+
+   private:
+    friend class tx;
+
+    static std::uint64_t encode(T value) noexcept {
+        std::uint64_t word = 0;
+        std::memcpy(&word, &value, sizeof(T));
+        return word;
+    }
+
+    static T decode(std::uint64_t word) noexcept {
+        T value;
+        std::memcpy(&value, &word, sizeof(T));
+        return value;
+    }
+
+   private:
+    std::atomic<std::uint64_t> m_word;
+};
+
+namespace detail {
+
+// thrown through the body of a transaction that has to start over, never escapes atomic_do
+struct tx_conflict {};
+
+// versioned write locks of TL2, an address maps to one stripe: version << 1 with the low bit
+// set while a committing transaction holds it
+class stm_globals {
+   public:
+    static constexpr std::size_t STRIPE_BITS = 16;
+
+    static std::atomic<std::uint64_t>& clock() noexcept {
+        return instance().m_clock;
+    }
+
+    static std::atomic<std::uint64_t>& stripe(const void* address) noexcept {
+        const auto a = reinterpret_cast<std::uintptr_t>(address) >> 3;
+        return instance().m_stripes[(a * 0x9E3779B97F4A7C15ull) >> (64 - STRIPE_BITS)];
+    }
+
+   private:
+    static stm_globals& instance() noexcept {
+        static stm_globals globals;
+        return globals;
+    }
+
+   private:
+    alignas(std::hardware_destructive_interference_size)
+    std::atomic<std::uint64_t> m_clock = 0;
+    alignas(std::hardware_destructive_interference_size)
+    std::array<std::atomic<std::uint64_t>, std::size_t(1) << STRIPE_BITS> m_stripes{};
+};
+
+}
+
+// Transaction of a word-based STM after TL2 (Dice, Shalev, Shavit, "Transactional Locking II",
+// DISC 2006). A global version clock is sampled when the transaction starts; every read checks
+// the stripe lock of its word before and after loading it and gives up when the stripe is
+// locked or was written after that sample, so the body only ever sees a consistent snapshot.
+// Writes go to a private buffer. Commit locks the stripes of the write set, bumps the clock,
+// revalidates the read set unless nothing committed in between, writes the buffer back and
+// releases the stripes with the new version. Read-only transactions commit without any of that.
+class tx {
+   public:
+    tx(tx const&) = delete;
+    tx(tx&& other) = delete;
+    tx& operator=(tx const&) = delete;
+    tx& operator=(tx &&) = delete;
+
+   public:
+    template<typename T>
+    T load(const tvar<T>& var) {
+        return tvar<T>::decode(read(var.m_word));
+    }
+
+    template<typename T>
+    void store(tvar<T>& var, T value) {
+        write(var.m_word, tvar<T>::encode(value));
+    }
+
+    // runs after the outermost transaction committed, once, in registration order; the place
+    // for side effects on anything that is not a tvar
+    void on_commit(std::function<void()> f) {
+        m_on_commit.push_back(std::move(f));
+    }
+
+   private:
+    template<typename F>
+    friend std::invoke_result_t<F&, tx&> atomic_do(F&& body);
+
+    struct write_entry {
+        std::atomic<std::uint64_t>* word;
+        std::uint64_t value;
+    };
+
+    struct held_stripe {
+        std::atomic<std::uint64_t>* stripe;
+        std::uint64_t version;
+    };
+
+    tx() noexcept = default;
+
+    static tx*& current() noexcept {
+        thread_local tx* tl_current = nullptr;
+        return tl_current;
+    }
+
+    static tx& local() noexcept {
+        thread_local tx tl_tx;
+        return tl_tx;
+    }
+
+    void begin() noexcept {
+        m_reads.clear();
+        m_writes.clear();
+        m_on_commit.clear();
+        m_filter = 0;
+        m_read_version = detail::stm_globals::clock().load(std::memory_order_acquire);
+    }
+
+    static std::uint64_t filter_bit(const void* address) noexcept {
+        return std::uint64_t(1) << ((reinterpret_cast<std::uintptr_t>(address) >> 3) & 63);
+    }
+
+    std::uint64_t read(const std::atomic<std::uint64_t>& word) {
+        // read own writes, the filter saves the search for words never written
+        if(m_filter & filter_bit(&word)) {
+            for(auto it = m_writes.rbegin(); it != m_writes.rend(); ++it) {
+                if(it->word == &word) {
+                    return it->value;
+                }
+            }
+        }
+
+        auto& stripe = detail::stm_globals::stripe(&word);
+        const std::uint64_t before = stripe.load(std::memory_order_acquire);
+        const std::uint64_t value = word.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const std::uint64_t after = stripe.load(std::memory_order_relaxed);
+        if(before != after || (before & 1) || (before >> 1) > m_read_version) {
+            throw detail::tx_conflict{};
+        }
+        m_reads.push_back(&stripe);
+        return value;
+    }
+
+    void write(std::atomic<std::uint64_t>& word, std::uint64_t value) {
+        const std::uint64_t bit = filter_bit(&word);
+        if(m_filter & bit) {
+            for(auto& w : m_writes) {
+                if(w.word == &word) {
+                    w.value = value;
+                    return;
+                }
+            }
+        }
+        m_filter |= bit;
+        m_writes.push_back({&word, value});
+    }
+
+    // false when the transaction has to start over
+    bool commit() {
+        if(m_writes.empty()) {
+            return true;
+        }
+
+        m_held.clear();
+        for(const auto& w : m_writes) {
+            m_held.push_back({&detail::stm_globals::stripe(w.word), 0});
+        }
+        std::ranges::sort(m_held, std::less<>{}, &held_stripe::stripe);
+        m_held.erase(std::ranges::unique(m_held, {}, &held_stripe::stripe).begin(), m_held.end());
+
+        // no waiting on a held stripe: its owner is committing and we likely conflict with it
+        for(std::size_t i = 0; i < m_held.size(); ++i) {
+            std::uint64_t version = m_held[i].stripe->load(std::memory_order_relaxed);
+            if((version & 1) || !m_held[i].stripe->compare_exchange_strong(version, version | 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                unlock(i);
+                return false;
+            }
+            m_held[i].version = version;
+        }
+
+        const std::uint64_t write_version = detail::stm_globals::clock().fetch_add(1, std::memory_order_acq_rel) + 1;
+        // somebody else committed since begin: what we read may have changed
+        if(write_version != m_read_version + 1 && !validate()) {
+            unlock(m_held.size());
+            return false;
+        }
+
+        std::atomic_thread_fence(std::memory_order_release);
+        for(const auto& w : m_writes) {
+            w.word->store(w.value, std::memory_order_relaxed);
+        }
+        for(const auto& h : m_held) {
+            h.stripe->store(write_version << 1, std::memory_order_release);
+        }
+        return true;
+    }
+
+    bool validate() const noexcept {
+        for(const auto* stripe : m_reads) {
+            std::uint64_t version = stripe->load(std::memory_order_acquire);
+            if(version & 1) {
+                // locked, fine if by us: then what counts is the version we locked
+                auto held = std::ranges::lower_bound(m_held, stripe, std::less<>{}, &held_stripe::stripe);
+                if(held == m_held.end() || held->stripe != stripe) {
+                    return false;
+                }
+                version = held->version;
+            }
+            if((version >> 1) > m_read_version) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // the callbacks may start transactions of their own on this thread's tx
+    void run_on_commit() {
+        auto callbacks = std::move(m_on_commit);
+        m_on_commit.clear();
+        for(auto& f : callbacks) {
+            f();
+        }
+    }
+
+    // releases the first n held stripes unchanged
+    void unlock(std::size_t n) noexcept {
+        for(std::size_t i = 0; i < n; ++i) {
+            m_held[i].stripe->store(m_held[i].version, std::memory_order_release);
+        }
+    }
+
+   private:
+    std::uint64_t m_read_version = 0;
+    std::uint64_t m_filter = 0;
+    std::vector<const std::atomic<std::uint64_t>*> m_reads;
+    std::vector<write_entry> m_writes;
+    std::vector<held_stripe> m_held;
+    std::vector<std::function<void()>> m_on_commit;
+};
+
+// Runs body(tx&) as one transaction and returns its result, starting it over after a conflict
+// with backoff. The body may run several times and see a snapshot that is abandoned, so it must
+// not have side effects other than through the tx (on_commit defers them) and must not swallow
+// exceptions it did not throw. An exception thrown by the body discards the transaction and
+// propagates. A nested atomic_do joins the transaction it runs in.
+template<typename F>
+std::invoke_result_t<F&, tx&> atomic_do(F&& body) {
+    using result_t = std::invoke_result_t<F&, tx&>;
+    tx*& current = tx::current();
+    if(current != nullptr) {
+        return body(*current);
+    }
+
+    tx& t = tx::local();
+    struct outermost_guard {
+        ~outermost_guard() {
+            slot = nullptr;
+        }
+        tx*& slot;
+    } guard{current};
+    current = &t;
+
+    backoff wait;
+    while(true) {
+        t.begin();
+        try {
+            if constexpr(std::is_void_v<result_t>) {
+                body(t);
+                if(t.commit()) {
+                    current = nullptr;
+                    t.run_on_commit();
+                    return;
+                }
+            } else {
+                result_t result = body(t);
+                if(t.commit()) {
+                    current = nullptr;
+                    t.run_on_commit();
+                    return result;
+                }
+            }
+        } catch(detail::tx_conflict const&) {
+        }
+        wait();
+    }
+}
+
+}
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include "spin_lock.hpp"
+#include "queue_lock.hpp"
+#include "hybrid_lock.hpp"
+#include "bravo_lock.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+// Throughput matrix of the Lockable implementations: every thread repeatedly takes the lock,
+// updates a small shared state and releases it; the table reports million acquisitions per second.
+
+namespace {
+
+constexpr auto DURATION = std::chrono::milliseconds(200);
+
+std::vector<unsigned> thread_counts() {
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> counts;
+    for (unsigned n = 1; n < hardware; n *= 2) {
+        counts.push_back(n);
+    }
+    counts.push_back(hardware);
+    counts.push_back(hardware * 2);
+    return counts;
+}
+
+template<typename Lock>
+double throughput(unsigned num_threads) {
+    Lock lock;
+    std::atomic<bool> start{false};
+    std::atomic<bool> stop{false};
+    std::atomic<std::uint64_t> total{0};
+    std::uint64_t shared[8] = {};
+    std::vector<std::thread> threads;
+
+    for (unsigned t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&]() {
+            while (!start.load(std::memory_order_acquire)) {}
+            std::uint64_t ops = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                std::lock_guard guard(lock);
+                for (auto& s : shared) {
+                    ++s;
+                }
+                ++ops;
+            }
+            total.fetch_add(ops);
+        });
+    }
+
+    start.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(DURATION);
+    stop.store(true);
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(shared[0], total.load());
+    return static_cast<double>(total.load()) / std::chrono::duration<double>(DURATION).count() / 1e6;
+}
+
+// every thread performs one exclusive acquisition per `write_every` shared ones
+template<typename Lock>
+double read_throughput(unsigned num_threads, unsigned write_every) {
+    Lock lock;
+    std::atomic<bool> start{false};
+    std::atomic<bool> stop{false};
+    std::atomic<std::uint64_t> total{0};
+    std::atomic<std::uint64_t> checksum{0};
+    std::uint64_t shared[8] = {};
+    std::vector<std::thread> threads;
+
+    for (unsigned t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&]() {
+            while (!start.load(std::memory_order_acquire)) {}
+            std::uint64_t ops = 0;
+            std::uint64_t sink = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (++ops % write_every == 0) {
+                    std::lock_guard guard(lock);
+                    ++shared[0];
+                } else {
+                    std::shared_lock guard(lock);
+                    sink += shared[0];
+                }
+            }
+            total.fetch_add(ops);
+            checksum.fetch_add(sink);
+        });
+    }
+
+    start.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(DURATION);
+    stop.store(true);
+    for (auto& t : threads) {
+        t.join();
+    }
+    return static_cast<double>(total.load()) / std::chrono::duration<double>(DURATION).count() / 1e6;
+}
+
+template<typename Lock>
+void read_row(const char* name, unsigned write_every, const std::vector<unsigned>& counts) {
+    std::printf("%-12s1/%-8u", name, write_every);
+    for (unsigned n : counts) {
+        std::printf("%10.2f", read_throughput<Lock>(n, write_every));
+    }
+    std::printf("\n");
+}
+
+template<typename Lock>
+void row(const char* name, const std::vector<unsigned>& counts) {
+    std::printf("%-12s", name);
+    for (unsigned n : counts) {
+        std::printf("%10.2f", throughput<Lock>(n));
+    }
+    std::printf("\n");
+}
+
+}
+
+TEST(LockBench, ThroughputMatrix) {
+    const auto counts = thread_counts();
+    std::printf("%-12s", "Mops/s");
+    for (unsigned n : counts) {
+        std::printf("%7u thr", n);
+    }
+    std::printf("\n");
+
+    row<std::mutex>("std::mutex", counts);
+    row<conc::tas_lock>("tas", counts);
+    row<conc::ttas_lock>("ttas", counts);
+    row<conc::mcs_lock>("mcs", counts);
+    row<conc::clh_lock>("clh", counts);
+    row<conc::hybrid_lock>("hybrid", counts);
+}
+
+TEST(LockBench, ReadMostlyMatrix) {
+    const auto counts = thread_counts();
+    std::printf("%-12s%-10s", "Mops/s", "writes");
+    for (unsigned n : counts) {
+        std::printf("%7u thr", n);
+    }
+    std::printf("\n");
+
+    for (unsigned write_every : {1000u, 100u, 10u}) {
+        read_row<std::shared_mutex>("shared_mtx", write_every, counts);
+        read_row<conc::bravo_lock<>>("bravo", write_every, counts);
+    }
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include "barrier.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace conc;
+
+template<typename Barrier>
+class BarrierTest : public ::testing::Test {};
+
+using BarrierTypes = ::testing::Types<
+    combining_tree_barrier<wait_policy::spin>,
+    combining_tree_barrier<wait_policy::block>,
+    dissemination_barrier<wait_policy::spin>,
+    dissemination_barrier<wait_policy::block>>;
+TYPED_TEST_SUITE(BarrierTest, BarrierTypes);
+
+TYPED_TEST(BarrierTest, SingleParticipantNeverBlocks) {
+    TypeParam barrier(1);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(barrier.arrive_and_wait(0));
+    }
+}
+
+TYPED_TEST(BarrierTest, PhasesDoNotOverlap) {
+    // deliberately not a power of two nor a multiple of the fan-in
+    for (std::size_t participants : {2u, 5u, 7u, 9u}) {
+        TypeParam barrier(participants);
+        const int phases = 200;
+        std::vector<std::atomic<int>> progress(participants);
+        std::atomic<int> serial{0};
+        std::atomic<bool> overlap{false};
+        std::vector<std::thread> threads;
+
+        for (std::size_t id = 0; id < participants; ++id) {
+            threads.emplace_back([&, id]() {
+                for (int phase = 1; phase <= phases; ++phase) {
+                    progress[id].store(phase, std::memory_order_relaxed);
+                    if (barrier.arrive_and_wait(id)) {
+                        serial.fetch_add(1);
+                    }
+                    for (auto& p : progress) {
+                        const int seen = p.load(std::memory_order_relaxed);
+                        // everyone reached this phase, nobody can be past the next barrier
+                        if (seen != phase && seen != phase + 1) {
+                            overlap.store(true);
+                        }
+                    }
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        EXPECT_FALSE(overlap.load()) << participants << " participants";
+        EXPECT_EQ(serial.load(), phases) << participants << " participants";
+    }
+}
+
+TYPED_TEST(BarrierTest, PublishesWritesAcrossPhases) {
+    const std::size_t participants = 6;
+    TypeParam barrier(participants);
+    std::vector<long> cells(participants, 0);
+    std::atomic<bool> stale{false};
+    std::vector<std::thread> threads;
+
+    for (std::size_t id = 0; id < participants; ++id) {
+        threads.emplace_back([&, id]() {
+            for (long phase = 1; phase <= 100; ++phase) {
+                cells[id] = phase;
+                barrier.arrive_and_wait(id);
+                // plain reads of other participants' cells are ordered by the barrier
+                if (cells[(id + 1) % participants] != phase) {
+                    stale.store(true);
+                }
+                barrier.arrive_and_wait(id);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_FALSE(stale.load());
+}
+
+TEST(CombiningTreeBarrierTest, WideAndNarrowFanIn) {
+    for (std::size_t fan_in : {2u, 3u, 16u}) {
+        const std::size_t participants = 10;
+        combining_tree_barrier<> barrier(participants, fan_in);
+        std::atomic<int> serial{0};
+        std::vector<std::thread> threads;
+        for (std::size_t id = 0; id < participants; ++id) {
+            threads.emplace_back([&, id]() {
+                for (int i = 0; i < 50; ++i) {
+                    if (barrier.arrive_and_wait(id)) {
+                        serial.fetch_add(1);
+                    }
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        EXPECT_EQ(serial.load(), 50) << "fan-in " << fan_in;
+    }
+}
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include "bravo_lock.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+using namespace conc;
+
+class BravoLockTest : public ::testing::Test {
+protected:
+    bravo_lock<> lock;
+
+    // try_lock from a thread that holds nothing, owners must not try to relock
+    template<typename Lock>
+    static bool try_lock_elsewhere(Lock& l) {
+        bool acquired = false;
+        std::thread([&]() {
+            acquired = l.try_lock();
+            if (acquired) {
+                l.unlock();
+            }
+        }).join();
+        return acquired;
+    }
+
+    template<typename Lock>
+    static bool try_lock_shared_elsewhere(Lock& l) {
+        bool acquired = false;
+        std::thread([&]() {
+            acquired = l.try_lock_shared();
+            if (acquired) {
+                l.unlock_shared();
+            }
+        }).join();
+        return acquired;
+    }
+};
+
+TEST_F(BravoLockTest, ReadersShareWritersExclude) {
+    ASSERT_TRUE(lock.try_lock_shared());
+    EXPECT_TRUE(try_lock_shared_elsewhere(lock));
+    EXPECT_FALSE(try_lock_elsewhere(lock));
+    lock.unlock_shared();
+
+    ASSERT_TRUE(lock.try_lock());
+    EXPECT_FALSE(try_lock_shared_elsewhere(lock));
+    EXPECT_FALSE(try_lock_elsewhere(lock));
+    lock.unlock();
+
+    EXPECT_TRUE(try_lock_elsewhere(lock));
+}
+
+TEST_F(BravoLockTest, FailedTryLockKeepsBias) {
+    lock.lock_shared();
+    EXPECT_FALSE(try_lock_elsewhere(lock));
+    EXPECT_TRUE(lock.read_biased());
+    lock.unlock_shared();
+}
+
+TEST_F(BravoLockTest, WriterRevokesBiasAndWaitsForReaders) {
+    ASSERT_TRUE(lock.read_biased());
+    lock.lock_shared();
+    std::atomic<bool> written{false};
+
+    std::thread writer([&]() {
+        std::lock_guard guard(lock);
+        written.store(true);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(written.load());
+    lock.unlock_shared();
+    writer.join();
+
+    EXPECT_TRUE(written.load());
+    EXPECT_FALSE(lock.read_biased());
+}
+
+TEST_F(BravoLockTest, BiasIsRestoredByLaterReaders) {
+    lock.lock();
+    lock.unlock();
+    EXPECT_FALSE(lock.read_biased());
+
+    // the inhibit window is a multiple of the revocation time
+    for (int i = 0; i < 1000 && !lock.read_biased(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::shared_lock guard(lock);
+    }
+    EXPECT_TRUE(lock.read_biased());
+}
+
+TEST_F(BravoLockTest, SeveralLocksHeldShared) {
+    bravo_lock<> other;
+    std::shared_lock first(lock);
+    std::shared_lock second(other);
+    EXPECT_FALSE(try_lock_elsewhere(other));
+    second.unlock();
+    EXPECT_TRUE(try_lock_elsewhere(other));
+    EXPECT_FALSE(try_lock_elsewhere(lock));
+}
+
+TEST_F(BravoLockTest, ReadersNeverObserveTornWrites) {
+    const int num_readers = std::max(2u, std::thread::hardware_concurrency());
+    const int writes = 2000;
+    long a = 0;
+    long b = 0;
+    std::atomic<bool> done{false};
+    std::atomic<bool> torn{false};
+    std::vector<std::thread> threads;
+
+    for (int r = 0; r < num_readers; ++r) {
+        threads.emplace_back([&]() {
+            while (!done.load()) {
+                std::shared_lock guard(lock);
+                if (a != b) {
+                    torn.store(true);
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < writes; ++i) {
+        std::lock_guard guard(lock);
+        ++a;
+        ++b;
+    }
+    done.store(true);
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_FALSE(torn.load());
+    EXPECT_EQ(a, writes);
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include "byte_lock.hpp"
+
+#include <chrono>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+using namespace conc;
+
+class ByteLockTest : public ::testing::Test {
+protected:
+    byte_lock lock;
+};
+
+TEST_F(ByteLockTest, IsOneByte) {
+    EXPECT_EQ(sizeof(byte_lock), 1u);
+    EXPECT_EQ(sizeof(byte_condition), 1u);
+}
+
+TEST_F(ByteLockTest, TryLock) {
+    EXPECT_TRUE(lock.try_lock());
+    EXPECT_FALSE(lock.try_lock());
+    lock.unlock();
+    EXPECT_TRUE(lock.try_lock());
+    lock.unlock();
+}
+
+TEST_F(ByteLockTest, WaiterParksAndIsWoken) {
+    lock.lock();
+    bool acquired = false;
+    std::thread waiter([&]() {
+        std::lock_guard guard(lock);
+        acquired = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    lock.unlock();
+    waiter.join();
+    EXPECT_TRUE(acquired);
+    EXPECT_TRUE(lock.try_lock());
+    lock.unlock();
+}
+
+TEST_F(ByteLockTest, MutualExclusionUnderOversubscription) {
+    const int num_threads = 4 * std::max(2u, std::thread::hardware_concurrency());
+    const int per_thread = 5000;
+    long counter = 0;
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < per_thread; ++i) {
+                std::lock_guard guard(lock);
+                ++counter;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(counter, static_cast<long>(num_threads) * per_thread);
+}
+
+TEST_F(ByteLockTest, ConditionProducerConsumer) {
+    byte_condition not_empty;
+    std::queue<int> items;
+    const int total = 2000;
+    const int num_consumers = 3;
+    std::atomic<long> sum{0};
+    std::atomic<int> consumed{0};
+    std::vector<std::thread> consumers;
+
+    for (int c = 0; c < num_consumers; ++c) {
+        consumers.emplace_back([&]() {
+            while (true) {
+                std::unique_lock guard(lock);
+                not_empty.wait(lock, [&]() { return !items.empty(); });
+                const int item = items.front();
+                items.pop();
+                if (item < 0) {
+                    return;
+                }
+                sum.fetch_add(item);
+                consumed.fetch_add(1);
+            }
+        });
+    }
+
+    for (int i = 1; i <= total; ++i) {
+        std::lock_guard guard(lock);
+        items.push(i);
+        not_empty.notify_one();
+    }
+    {
+        std::lock_guard guard(lock);
+        for (int c = 0; c < num_consumers; ++c) {
+            items.push(-1);
+        }
+        not_empty.notify_all();
+    }
+    for (auto& t : consumers) {
+        t.join();
+    }
+
+    EXPECT_EQ(consumed.load(), total);
+    EXPECT_EQ(sum.load(), static_cast<long>(total) * (total + 1) / 2);
+}
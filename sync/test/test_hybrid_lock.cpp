@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include "hybrid_lock.hpp"
+
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <chrono>
+
+using namespace conc;
+
+class HybridLockTest : public ::testing::Test {
+protected:
+    hybrid_lock lock;
+};
+
+TEST_F(HybridLockTest, TryLock) {
+    EXPECT_TRUE(lock.try_lock());
+    EXPECT_FALSE(lock.try_lock());
+    lock.unlock();
+    EXPECT_TRUE(lock.try_lock());
+    lock.unlock();
+}
+
+TEST_F(HybridLockTest, WaiterParksAndIsWoken) {
+    lock.lock();
+    bool acquired = false;
+    std::thread waiter([&]() {
+        std::lock_guard guard(lock);
+        acquired = true;
+    });
+
+    // long enough for the waiter to exhaust its spins and park
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    lock.unlock();
+    waiter.join();
+    EXPECT_TRUE(acquired);
+    EXPECT_TRUE(lock.try_lock());
+    lock.unlock();
+}
+
+TEST_F(HybridLockTest, MutualExclusionUnderOversubscription) {
+    const int num_threads = 4 * std::max(2u, std::thread::hardware_concurrency());
+    const int per_thread = 5000;
+    long counter = 0;
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < per_thread; ++i) {
+                std::lock_guard guard(lock);
+                ++counter;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(counter, static_cast<long>(num_threads) * per_thread);
+}
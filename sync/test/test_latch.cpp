@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include "latch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace conc;
+
+class LatchTest : public ::testing::Test {};
+
+TEST_F(LatchTest, ZeroIsOpen) {
+    latch l(0);
+    EXPECT_TRUE(l.try_wait());
+    l.wait();
+}
+
+TEST_F(LatchTest, CountDownOpens) {
+    latch l(3);
+    EXPECT_FALSE(l.try_wait());
+    l.count_down();
+    l.count_down();
+    EXPECT_FALSE(l.try_wait());
+    l.count_down();
+    EXPECT_TRUE(l.try_wait());
+    l.wait();
+}
+
+TEST_F(LatchTest, CountDownByMany) {
+    latch l(5);
+    l.count_down(2);
+    EXPECT_FALSE(l.try_wait());
+    l.count_down(3);
+    EXPECT_TRUE(l.try_wait());
+}
+
+TEST_F(LatchTest, WaitersSleepUntilLastArrival) {
+    const int workers = 6;
+    latch done(workers);
+    std::vector<int> results(workers, 0);
+    std::atomic<int> checked{0};
+    std::vector<std::thread> waiters;
+
+    for (int w = 0; w < 3; ++w) {
+        waiters.emplace_back([&]() {
+            done.wait();
+            int sum = 0;
+            for (int r : results) {
+                sum += r;
+            }
+            if (sum == workers) {
+                checked.fetch_add(1);
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    std::vector<std::thread> threads;
+    for (int w = 0; w < workers; ++w) {
+        threads.emplace_back([&, w]() {
+            results[w] = 1;
+            done.count_down();
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (auto& t : waiters) {
+        t.join();
+    }
+    EXPECT_EQ(checked.load(), 3);
+}
+
+TEST_F(LatchTest, ArriveAndWait) {
+    const int participants = 8;
+    latch start(participants);
+    std::atomic<int> arrived{0};
+    std::atomic<bool> early{false};
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < participants; ++i) {
+        threads.emplace_back([&]() {
+            arrived.fetch_add(1);
+            start.arrive_and_wait();
+            if (arrived.load() != participants) {
+                early.store(true);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_FALSE(early.load());
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include "left_right.hpp"
+
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <string>
+#include <unordered_map>
+
+using namespace conc;
+
+class LeftRightTest : public ::testing::Test {
+protected:
+    using map = std::unordered_map<int, int>;
+};
+
+TEST_F(LeftRightTest, ReadIndicator) {
+    read_indicator indicator;
+    EXPECT_TRUE(indicator.empty());
+    indicator.arrive();
+    indicator.arrive();
+    EXPECT_FALSE(indicator.empty());
+    indicator.depart();
+    EXPECT_FALSE(indicator.empty());
+    indicator.depart();
+    EXPECT_TRUE(indicator.empty());
+}
+
+TEST_F(LeftRightTest, ReadAfterWrite) {
+    left_right<map> lr;
+    EXPECT_EQ(lr.read([](const map& m) { return m.size(); }), 0);
+
+    lr.write([](map& m) noexcept { m[1] = 10; });
+    lr.write([](map& m) noexcept { m[2] = 20; });
+    EXPECT_EQ(lr.read([](const map& m) { return m.at(1) + m.at(2); }), 30);
+
+    auto erased = lr.write([](map& m) noexcept { return m.erase(1); });
+    EXPECT_EQ(erased, 1);
+    EXPECT_FALSE(lr.read([](const map& m) { return m.contains(1); }));
+}
+
+TEST_F(LeftRightTest, ConstructorArgumentsAppliedToBothCopies) {
+    left_right<std::string> lr(3, 'x');
+    EXPECT_EQ(lr.read([](const std::string& s) { return s; }), "xxx");
+    lr.write([](std::string& s) noexcept { s += 'y'; });
+    lr.write([](std::string& s) noexcept { s += 'z'; });
+    EXPECT_EQ(lr.read([](const std::string& s) { return s; }), "xxxyz");
+}
+
+TEST_F(LeftRightTest, ConcurrentReadersSeeConsistentMap) {
+    left_right<map> lr;
+    std::atomic<bool> stop{false};
+    std::atomic<int> errors{0};
+    const int writes = 5000;
+
+    // the writer keeps m[0] equal to the number of other keys
+    lr.write([](map& m) noexcept { m[0] = 0; });
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&]() {
+            std::size_t last = 0;
+            while (!stop.load()) {
+                auto [count, size] = lr.read([](const map& m) {
+                    return std::pair<std::size_t, std::size_t>(m.at(0), m.size());
+                });
+                if (count + 1 != size || size < last) {
+                    errors.fetch_add(1);
+                }
+                last = size;
+            }
+        });
+    }
+
+    std::vector<std::thread> writers;
+    for (int w = 0; w < 2; ++w) {
+        writers.emplace_back([&, w]() {
+            for (int i = 1; i <= writes; ++i) {
+                lr.write([key = w * writes + i](map& m) noexcept {
+                    m[key] = key;
+                    m[0] += 1;
+                });
+            }
+        });
+    }
+    for (auto& t : writers) {
+        t.join();
+    }
+    stop.store(true);
+    for (auto& t : readers) {
+        t.join();
+    }
+
+    EXPECT_EQ(errors.load(), 0);
+    EXPECT_EQ(lr.read([](const map& m) { return m.size(); }), 2 * writes + 1);
+}
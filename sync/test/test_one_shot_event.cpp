@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+#include "one_shot_event.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace conc;
+
+class OneShotEventTest : public ::testing::Test {
+protected:
+    one_shot_event event;
+};
+
+TEST_F(OneShotEventTest, WaitAfterSetReturns) {
+    EXPECT_EQ(sizeof(one_shot_event), 1u);
+    EXPECT_FALSE(event.is_set());
+    event.set();
+    EXPECT_TRUE(event.is_set());
+    event.wait();
+    event.set();
+    EXPECT_TRUE(event.is_set());
+}
+
+TEST_F(OneShotEventTest, SetReleasesAllWaiters) {
+    const int num_waiters = 8;
+    int payload = 0;
+    std::atomic<int> seen{0};
+    std::vector<std::thread> waiters;
+
+    for (int i = 0; i < num_waiters; ++i) {
+        waiters.emplace_back([&]() {
+            event.wait();
+            if (payload == 42) {
+                seen.fetch_add(1);
+            }
+        });
+    }
+
+    payload = 42;
+    event.set();
+    for (auto& t : waiters) {
+        t.join();
+    }
+    EXPECT_EQ(seen.load(), num_waiters);
+}
+
+TEST_F(OneShotEventTest, RepeatedRaces) {
+    for (int i = 0; i < 300; ++i) {
+        one_shot_event e;
+        std::thread waiter([&]() { e.wait(); });
+        e.set();
+        waiter.join();
+        EXPECT_TRUE(e.is_set());
+    }
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "parking_lot.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace conc;
+
+class ParkingLotTest : public ::testing::Test {
+protected:
+    std::atomic<int> word{0};
+
+    // parks until `word` is non-zero
+    void park_on_word() {
+        while (word.load() == 0) {
+            parking_lot::park(&word, [this]() noexcept { return word.load() == 0; });
+        }
+    }
+};
+
+TEST_F(ParkingLotTest, FailedValidationDoesNotPark) {
+    bool before_sleep = false;
+    EXPECT_FALSE(parking_lot::park(&word, []() noexcept { return false; }, [&]() noexcept { before_sleep = true; }));
+    EXPECT_FALSE(before_sleep);
+}
+
+TEST_F(ParkingLotTest, UnparkWithoutWaiters) {
+    bool called = false;
+    auto result = parking_lot::unpark_one(&word, [&](unpark_result r) noexcept {
+        called = true;
+        EXPECT_FALSE(r.unparked);
+    });
+    EXPECT_TRUE(called);
+    EXPECT_FALSE(result.unparked);
+    EXPECT_FALSE(result.have_more);
+    EXPECT_EQ(parking_lot::unpark_all(&word), 0u);
+}
+
+TEST_F(ParkingLotTest, UnparkOneWakesInFifoOrder) {
+    std::atomic<int> turn{0};
+    std::vector<int> order;
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < 3; ++i) {
+        threads.emplace_back([&, i]() {
+            parking_lot::park(&turn, [&]() noexcept { return turn.load() == i; }, [&]() noexcept { turn.fetch_add(1); });
+            order.push_back(i);
+        });
+        while (turn.load() != i + 1) {
+            std::this_thread::yield();
+        }
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        auto result = parking_lot::unpark_one(&turn);
+        EXPECT_TRUE(result.unparked);
+        EXPECT_EQ(result.have_more, i < 2);
+        threads[i].join();
+    }
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2}));
+}
+
+TEST_F(ParkingLotTest, UnparkAllWakesOnlyItsAddress) {
+    std::atomic<int> other{0};
+    std::atomic<int> parked{0};
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&]() {
+            parking_lot::park(&word, []() noexcept { return true; }, [&]() noexcept { parked.fetch_add(1); });
+        });
+    }
+    std::thread bystander([&]() {
+        parking_lot::park(&other, []() noexcept { return true; }, [&]() noexcept { parked.fetch_add(1); });
+    });
+    while (parked.load() != 5) {
+        std::this_thread::yield();
+    }
+
+    EXPECT_EQ(parking_lot::unpark_all(&word), 4u);
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(parking_lot::unpark_all(&other), 1u);
+    bystander.join();
+}
+
+TEST_F(ParkingLotTest, NoLostWakeups) {
+    const int rounds = 500;
+    for (int i = 0; i < rounds; ++i) {
+        word.store(0);
+        std::thread waiter([this]() { park_on_word(); });
+        word.store(1);
+        parking_lot::unpark_all(&word);
+        waiter.join();
+    }
+    SUCCEED();
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include "queue_lock.hpp"
+
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <atomic>
+
+using namespace conc;
+
+template<typename Lock>
+class QueueLockTest : public ::testing::Test {
+protected:
+    Lock lock;
+};
+
+using QueueLockTypes = ::testing::Types<mcs_lock, clh_lock>;
+TYPED_TEST_SUITE(QueueLockTest, QueueLockTypes);
+
+TYPED_TEST(QueueLockTest, TryLock) {
+    EXPECT_TRUE(this->lock.try_lock());
+    std::thread other([this]() { EXPECT_FALSE(this->lock.try_lock()); });
+    other.join();
+    this->lock.unlock();
+    EXPECT_TRUE(this->lock.try_lock());
+    this->lock.unlock();
+}
+
+TYPED_TEST(QueueLockTest, NestedDistinctLocks) {
+    TypeParam second;
+    this->lock.lock();
+    second.lock();
+    second.unlock();
+    this->lock.unlock();
+
+    // releasing out of acquisition order is fine as well
+    this->lock.lock();
+    second.lock();
+    this->lock.unlock();
+    second.unlock();
+
+    EXPECT_TRUE(this->lock.try_lock());
+    EXPECT_TRUE(second.try_lock());
+    second.unlock();
+    this->lock.unlock();
+}
+
+TYPED_TEST(QueueLockTest, MutualExclusion) {
+    const int num_threads = 8;
+    const int per_thread = 5000;
+    long counter = 0;
+    std::atomic<int> inside{0};
+    std::atomic<int> violations{0};
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < per_thread; ++i) {
+                std::lock_guard guard(this->lock);
+                if (inside.fetch_add(1) != 0) {
+                    violations.fetch_add(1);
+                }
+                ++counter;
+                inside.fetch_sub(1);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(violations.load(), 0);
+    EXPECT_EQ(counter, static_cast<long>(num_threads) * per_thread);
+}
+
+// try_lock racing lock/unlock loops: a node recycled back into the tail between the check and
+// the swap of a try_lock must not let it in next to the holder
+TYPED_TEST(QueueLockTest, TryLockAgainstLockLoops) {
+    const int lockers = 3;
+    const int tryers = 3;
+    const int per_thread = 20000;
+    long counter = 0;
+    std::atomic<int> inside{0};
+    std::atomic<int> violations{0};
+    std::vector<std::thread> threads;
+
+    auto critical = [&]() {
+        if (inside.fetch_add(1) != 0) {
+            violations.fetch_add(1);
+        }
+        ++counter;
+        inside.fetch_sub(1);
+    };
+    for (int t = 0; t < lockers; ++t) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < per_thread; ++i) {
+                std::lock_guard guard(this->lock);
+                critical();
+            }
+        });
+    }
+    for (int t = 0; t < tryers; ++t) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < per_thread; ++i) {
+                while (!this->lock.try_lock()) {
+                    std::this_thread::yield();
+                }
+                critical();
+                this->lock.unlock();
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(violations.load(), 0);
+    EXPECT_EQ(counter, static_cast<long>(lockers + tryers) * per_thread);
+}
+
+TYPED_TEST(QueueLockTest, ShortLivedThreads) {
+    long counter = 0;
+    for (int round = 0; round < 50; ++round) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&]() {
+                for (int i = 0; i < 100; ++i) {
+                    if (i % 2 == 0) {
+                        std::lock_guard guard(this->lock);
+                        ++counter;
+                    } else {
+                        while (!this->lock.try_lock()) {}
+                        ++counter;
+                        this->lock.unlock();
+                    }
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+    EXPECT_EQ(counter, 50 * 4 * 100);
+}
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include "rseq.hpp"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace conc;
+
+TEST(RseqTest, CurrentCpuIsInRange) {
+    RecordProperty("rseq", rseq_available() ? "yes" : "no");
+    EXPECT_LT(current_cpu(), cpu_slots());
+}
+
+#if defined(__linux__)
+TEST(RseqTest, SlotsCoverEveryCpuWeMayRunOn) {
+    // ids, not a count: a sparse affinity mask still has to index inside the slots
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    ASSERT_EQ(::sched_getaffinity(0, sizeof(set), &set), 0);
+    for(std::size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if(CPU_ISSET(cpu, &set)) {
+            EXPECT_LT(cpu, cpu_slots());
+        }
+    }
+}
+#endif
+
+TEST(RseqTest, CounterSumsConcurrentUpdates) {
+    constexpr int THREADS = 4;
+    constexpr int UPDATES = 100000;
+    percpu_counter counter;
+    counter.add(5);
+    counter.decrement();
+    EXPECT_EQ(counter.load(), 4);
+
+    std::vector<std::thread> threads;
+    for(int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&]() {
+            for(int i = 0; i < UPDATES; ++i) {
+                counter.increment();
+                if(i % 100 == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for(auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(counter.load(), 4 + THREADS * UPDATES);
+}
+
+namespace {
+
+struct block : percpu_node {
+    std::atomic<bool> in_use{false};
+    int payload = 0;
+};
+
+}
+
+TEST(RseqTest, FreeListIsLifoOnOneThread) {
+    percpu_free_list<block> list;
+    EXPECT_EQ(list.pop(), nullptr);
+    block a, b, c;
+    list.push(&a);
+    list.push(&b);
+    list.push(&c);
+    // a migration in between may leave some on another cpu's list
+    std::vector<block*> popped;
+    while(block* n = list.pop()) {
+        popped.push_back(n);
+    }
+    std::size_t drained = 0;
+    list.drain([&](block*) { ++drained; });
+    EXPECT_EQ(popped.size() + drained, 3u);
+    if(drained == 0) {
+        EXPECT_EQ(popped, (std::vector<block*>{&c, &b, &a}));
+    }
+}
+
+// a pool over the free list: a block is never handed to two threads at once and none is lost
+TEST(RseqTest, FreeListPoolUnderConcurrency) {
+    constexpr int THREADS = 4;
+    constexpr int ROUNDS = 50000;
+    percpu_free_list<block> list;
+    std::atomic<int> allocated{0};
+    std::atomic<bool> exclusive{true};
+
+    std::vector<std::thread> threads;
+    for(int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&]() {
+            std::vector<block*> held;
+            for(int i = 0; i < ROUNDS; ++i) {
+                block* b = list.pop();
+                if(b == nullptr) {
+                    b = new block();
+                    allocated.fetch_add(1);
+                }
+                if(b->in_use.exchange(true)) {
+                    exclusive.store(false);
+                }
+                ++b->payload;
+                held.push_back(b);
+                if(held.size() == 4 || i % 7 == 0) {
+                    for(block* h : held) {
+                        h->in_use.store(false);
+                        list.push(h);
+                    }
+                    held.clear();
+                }
+            }
+            for(block* h : held) {
+                h->in_use.store(false);
+                list.push(h);
+            }
+        });
+    }
+    for(auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_TRUE(exclusive.load());
+    int freed = 0;
+    long uses = 0;
+    list.drain([&](block* b) {
+        ++freed;
+        uses += b->payload;
+        delete b;
+    });
+    EXPECT_EQ(freed, allocated.load());
+    EXPECT_EQ(uses, long(THREADS) * ROUNDS);
+}
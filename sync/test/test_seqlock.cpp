@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "seqlock.hpp"
+
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <stdexcept>
+
+using namespace conc;
+
+class SeqlockTest : public ::testing::Test {
+protected:
+    // every field carries the same stamp, a torn read shows up as a mismatch
+    struct quote {
+        std::uint64_t bid = 0;
+        std::uint64_t ask = 0;
+        std::uint32_t size = 0;
+        std::uint32_t venue = 0;
+        std::uint64_t stamp[5] = {};
+
+        static quote make(std::uint64_t v) {
+            quote q;
+            q.bid = v;
+            q.ask = v;
+            q.size = static_cast<std::uint32_t>(v);
+            q.venue = static_cast<std::uint32_t>(v);
+            for (auto& s : q.stamp) {
+                s = v;
+            }
+            return q;
+        }
+
+        bool consistent() const {
+            for (auto s : stamp) {
+                if (s != bid) {
+                    return false;
+                }
+            }
+            return ask == bid && size == static_cast<std::uint32_t>(bid) && venue == size;
+        }
+    };
+};
+
+TEST_F(SeqlockTest, SequenceLockProtocol) {
+    sequence_lock<> lock;
+    auto seq = lock.read_begin();
+    EXPECT_EQ(seq, 0);
+    EXPECT_FALSE(lock.read_retry(seq));
+
+    lock.write_lock();
+    EXPECT_EQ(lock.sequence() & 1, 1);
+    EXPECT_TRUE(lock.read_retry(seq));
+    lock.write_unlock();
+
+    EXPECT_EQ(lock.sequence(), 2);
+    EXPECT_TRUE(lock.read_retry(seq));
+    EXPECT_FALSE(lock.read_retry(lock.read_begin()));
+}
+
+TEST_F(SeqlockTest, LoadStore) {
+    seqlock<quote> value;
+    EXPECT_TRUE(value.load().consistent());
+    EXPECT_EQ(value.load().bid, 0);
+
+    value.store(quote::make(7));
+    EXPECT_EQ(value.load().bid, 7);
+    EXPECT_TRUE(value.load().consistent());
+
+    seqlock<int> small(3);
+    EXPECT_EQ(small.load(), 3);
+    small.update([](int& v) { v *= 5; });
+    EXPECT_EQ(small.load(), 15);
+}
+
+TEST_F(SeqlockTest, UpdateReleasesLockOnException) {
+    seqlock<int, writer_policy::multiple> value(1);
+    EXPECT_THROW(value.update([](int& v) {
+        v = 2;
+        throw std::runtime_error("rejected");
+    }), std::runtime_error);
+    EXPECT_EQ(value.load(), 1);
+    value.store(4);
+    EXPECT_EQ(value.load(), 4);
+}
+
+TEST_F(SeqlockTest, SingleWriterManyReaders) {
+    seqlock<quote> value;
+    std::atomic<bool> stop{false};
+    std::atomic<int> torn{0};
+    std::vector<std::thread> readers;
+
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&]() {
+            std::uint64_t last = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                quote q = value.load();
+                if (!q.consistent() || q.bid < last) {
+                    torn.fetch_add(1);
+                }
+                last = q.bid;
+            }
+        });
+    }
+
+    for (std::uint64_t i = 1; i <= 200000; ++i) {
+        value.store(quote::make(i));
+    }
+    stop.store(true);
+    for (auto& t : readers) {
+        t.join();
+    }
+
+    EXPECT_EQ(torn.load(), 0);
+    EXPECT_EQ(value.load().bid, 200000);
+}
+
+TEST_F(SeqlockTest, MultipleWriters) {
+    seqlock<quote, writer_policy::multiple> value;
+    const int num_writers = 4;
+    const int per_writer = 20000;
+    std::atomic<bool> stop{false};
+    std::atomic<int> torn{0};
+    std::vector<std::thread> threads;
+
+    threads.emplace_back([&]() {
+        while (!stop.load(std::memory_order_relaxed)) {
+            if (!value.load().consistent()) {
+                torn.fetch_add(1);
+            }
+        }
+    });
+
+    std::vector<std::thread> writers;
+    for (int w = 0; w < num_writers; ++w) {
+        writers.emplace_back([&]() {
+            for (int i = 0; i < per_writer; ++i) {
+                value.update([](quote& q) { q = quote::make(q.bid + 1); });
+            }
+        });
+    }
+    for (auto& t : writers) {
+        t.join();
+    }
+    stop.store(true);
+    threads[0].join();
+
+    EXPECT_EQ(torn.load(), 0);
+    EXPECT_EQ(value.load().bid, static_cast<std::uint64_t>(num_writers * per_writer));
+}
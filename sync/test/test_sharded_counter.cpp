@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "sharded_counter.hpp"
+
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <set>
+
+using namespace conc;
+
+class ShardedCounterTest : public ::testing::Test {
+protected:
+    void SetUp() override {}
+    void TearDown() override {}
+};
+
+TEST_F(ShardedCounterTest, SingleThread) {
+    sharded_counter counter;
+    EXPECT_EQ(counter.load(), 0);
+    EXPECT_TRUE(counter.is_zero());
+
+    counter.increment();
+    counter.add(10);
+    counter.decrement();
+    EXPECT_EQ(counter.load(), 10);
+    EXPECT_FALSE(counter.is_zero());
+
+    counter.add(-10);
+    EXPECT_TRUE(counter.is_zero());
+
+    counter.add(5);
+    counter.reset();
+    EXPECT_EQ(counter.load(), 0);
+}
+
+TEST_F(ShardedCounterTest, ThreadSlotsAreStable) {
+    const std::size_t first = this_thread_slot(sharded_counter::CELLS);
+    EXPECT_EQ(this_thread_slot(sharded_counter::CELLS), first);
+    EXPECT_LT(first, sharded_counter::CELLS);
+
+    std::set<std::size_t> slots;
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&]() {
+            std::lock_guard lock(mutex);
+            slots.insert(this_thread_slot(sharded_counter::CELLS));
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(slots.size(), 8);
+}
+
+TEST_F(ShardedCounterTest, ConcurrentUpdatesAreExactAfterQuiescence) {
+    sharded_counter counter;
+    const int num_threads = 8;
+    const int per_thread = 100000;
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&counter, t]() {
+            for (int i = 0; i < per_thread; ++i) {
+                counter.add(t % 2 == 0 ? 2 : -1);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(counter.load(), static_cast<std::int64_t>(num_threads / 2) * per_thread);
+}
+
+TEST_F(ShardedCounterTest, MonotonicReadsUnderUpdates) {
+    sharded_counter counter;
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> writers;
+
+    for (int t = 0; t < 4; ++t) {
+        writers.emplace_back([&]() {
+            while (!stop.load(std::memory_order_relaxed)) {
+                counter.increment();
+            }
+        });
+    }
+
+    std::int64_t last = 0;
+    for (int i = 0; i < 10000; ++i) {
+        std::int64_t now = counter.load();
+        ASSERT_GE(now, last);
+        last = now;
+    }
+    stop.store(true);
+    for (auto& t : writers) {
+        t.join();
+    }
+}
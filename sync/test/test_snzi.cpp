@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include "snzi.hpp"
+
+#include <thread>
+#include <vector>
+#include <atomic>
+
+using namespace conc;
+
+class SnziTest : public ::testing::Test {
+protected:
+    void SetUp() override {}
+    void TearDown() override {}
+};
+
+TEST_F(SnziTest, SingleThread) {
+    snzi<> indicator;
+    EXPECT_FALSE(indicator.query());
+
+    indicator.arrive();
+    EXPECT_TRUE(indicator.query());
+    indicator.arrive();
+    indicator.depart();
+    EXPECT_TRUE(indicator.query());
+    indicator.depart();
+    EXPECT_FALSE(indicator.query());
+
+    for (int i = 0; i < 100; ++i) {
+        indicator.arrive();
+        EXPECT_TRUE(indicator.query());
+        indicator.depart();
+        EXPECT_FALSE(indicator.query());
+    }
+}
+
+TEST_F(SnziTest, SingleLeafTree) {
+    snzi<1> indicator;
+    indicator.arrive();
+    EXPECT_TRUE(indicator.query());
+    indicator.depart();
+    EXPECT_FALSE(indicator.query());
+}
+
+TEST_F(SnziTest, NonZeroWhileAnyThreadArrived) {
+    snzi<4> indicator;
+    const int num_threads = 8;
+    std::atomic<int> errors{0};
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < 20000; ++i) {
+                indicator.arrive();
+                if (!indicator.query()) {
+                    errors.fetch_add(1);
+                }
+                indicator.depart();
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(errors.load(), 0);
+    EXPECT_FALSE(indicator.query());
+}
+
+TEST_F(SnziTest, HolderKeepsIndicatorSet) {
+    snzi<8> indicator;
+    std::atomic<bool> arrived{false};
+    std::atomic<bool> release{false};
+    std::atomic<int> errors{0};
+
+    std::thread holder([&]() {
+        indicator.arrive();
+        arrived.store(true);
+        while (!release.load()) {
+            std::this_thread::yield();
+        }
+        indicator.depart();
+    });
+    while (!arrived.load()) {
+        std::this_thread::yield();
+    }
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < 20000; ++i) {
+                indicator.arrive();
+                indicator.depart();
+                if (!indicator.query()) {
+                    errors.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    release.store(true);
+    holder.join();
+
+    EXPECT_EQ(errors.load(), 0);
+    EXPECT_FALSE(indicator.query());
+}
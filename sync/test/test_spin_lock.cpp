@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+#include "spin_lock.hpp"
+
+#include <thread>
+#include <vector>
+#include <mutex>
+
+using namespace conc;
+
+template<typename Lock>
+class SpinLockTest : public ::testing::Test {
+protected:
+    Lock lock;
+};
+
+using SpinLockTypes = ::testing::Types<tas_lock, ttas_lock>;
+TYPED_TEST_SUITE(SpinLockTest, SpinLockTypes);
+
+TYPED_TEST(SpinLockTest, TryLock) {
+    EXPECT_TRUE(this->lock.try_lock());
+    EXPECT_FALSE(this->lock.try_lock());
+    this->lock.unlock();
+    EXPECT_TRUE(this->lock.try_lock());
+    this->lock.unlock();
+}
+
+TYPED_TEST(SpinLockTest, MutualExclusion) {
+    const int num_threads = 8;
+    const int per_thread = 20000;
+    long counter = 0;
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < per_thread; ++i) {
+                std::lock_guard guard(this->lock);
+                ++counter;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(counter, static_cast<long>(num_threads) * per_thread);
+}
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include "stm.hpp"
+
+#include <array>
+#include <atomic>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace conc;
+
+TEST(StmTest, ReadsOwnWritesAndCommits) {
+    tvar<int> a(1);
+    tvar<double> b(2.5);
+    const int seen = atomic_do([&](tx& t) {
+        t.store(a, t.load(a) + 10);
+        t.store(b, t.load(b) * 2);
+        return t.load(a);
+    });
+    EXPECT_EQ(seen, 11);
+    EXPECT_EQ(atomic_do([&](tx& t) { return t.load(a); }), 11);
+    EXPECT_EQ(atomic_do([&](tx& t) { return t.load(b); }), 5.0);
+}
+
+TEST(StmTest, ExceptionDiscardsWrites) {
+    tvar<int> a(1);
+    EXPECT_THROW(atomic_do([&](tx& t) {
+        t.store(a, 42);
+        throw std::runtime_error("abort");
+    }), std::runtime_error);
+    EXPECT_EQ(atomic_do([&](tx& t) { return t.load(a); }), 1);
+}
+
+TEST(StmTest, NestedJoinsOuterAndOnCommitRunsOnce) {
+    tvar<int> a(0);
+    tvar<int> b(0);
+    int callbacks = 0;
+    atomic_do([&](tx& t) {
+        t.store(a, 1);
+        t.on_commit([&]() { ++callbacks; });
+        atomic_do([&](tx& inner) {
+            EXPECT_EQ(&inner, &t);
+            EXPECT_EQ(inner.load(a), 1);
+            inner.store(b, 2);
+            inner.on_commit([&]() {
+                // the transaction is over, a new one can start from here
+                EXPECT_EQ(atomic_do([&](tx& after) { return after.load(b); }), 2);
+                ++callbacks;
+            });
+        });
+    });
+    EXPECT_EQ(callbacks, 2);
+}
+
+// transfers between accounts keep the total, which read-only transactions audit meanwhile
+TEST(StmTest, ConcurrentTransfersAreAtomic) {
+    constexpr std::size_t ACCOUNTS = 32;
+    constexpr int THREADS = 4;
+    constexpr int TRANSFERS = 20000;
+    constexpr long INITIAL = 100;
+    std::array<tvar<long>, ACCOUNTS> accounts;
+    atomic_do([&](tx& t) {
+        for(auto& a : accounts) {
+            t.store(a, INITIAL);
+        }
+    });
+    std::atomic<bool> done{false};
+    std::atomic<bool> consistent{true};
+
+    std::thread auditor([&]() {
+        while(!done.load()) {
+            const long total = atomic_do([&](tx& t) {
+                long sum = 0;
+                for(auto& a : accounts) {
+                    sum += t.load(a);
+                }
+                return sum;
+            });
+            if(total != INITIAL * long(ACCOUNTS)) {
+                consistent.store(false);
+            }
+        }
+    });
+
+    std::vector<std::thread> workers;
+    for(int w = 0; w < THREADS; ++w) {
+        workers.emplace_back([&, w]() {
+            std::mt19937 rng(w);
+            std::uniform_int_distribution<std::size_t> pick(0, ACCOUNTS - 1);
+            for(int n = 0; n < TRANSFERS; ++n) {
+                const std::size_t from = pick(rng);
+                const std::size_t to = pick(rng);
+                atomic_do([&](tx& t) {
+                    const long f = t.load(accounts[from]);
+                    if(f > 0 && from != to) {
+                        t.store(accounts[from], f - 1);
+                        t.store(accounts[to], t.load(accounts[to]) + 1);
+                    }
+                });
+            }
+        });
+    }
+    for(auto& w : workers) {
+        w.join();
+    }
+    done.store(true);
+    auditor.join();
+
+    EXPECT_TRUE(consistent.load());
+    long total = 0;
+    for(auto& a : accounts) {
+        total += atomic_do([&](tx& t) { return t.load(a); });
+    }
+    EXPECT_EQ(total, INITIAL * long(ACCOUNTS));
+}
+
+TEST(StmTest, ConcurrentIncrementsAreNotLost) {
+    constexpr int THREADS = 4;
+    constexpr int INCREMENTS = 20000;
+    tvar<std::uint64_t> counter;
+    tvar<std::uint64_t> shadow;
+    std::vector<std::thread> workers;
+    for(int w = 0; w < THREADS; ++w) {
+        workers.emplace_back([&]() {
+            for(int n = 0; n < INCREMENTS; ++n) {
+                atomic_do([&](tx& t) {
+                    t.store(counter, t.load(counter) + 1);
+                    t.store(shadow, t.load(shadow) + 2);
+                });
+            }
+        });
+    }
+    for(auto& w : workers) {
+        w.join();
+    }
+    atomic_do([&](tx& t) {
+        EXPECT_EQ(t.load(counter), std::uint64_t(THREADS) * INCREMENTS);
+        EXPECT_EQ(t.load(shadow), 2 * t.load(counter));
+    });
+}